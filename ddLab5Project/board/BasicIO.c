@@ -21,11 +21,16 @@
  * v4.2
  *  Created by Todd Morton
  *  Modified to fix bug in BOIGetStrg() so a BS can be the first character pressed.
+ * v5.1
+ *  Modified by Dominic Danis
+ *  UART2 RX and TX are interrupt driven through RingBuf ring buffers so BIOWrite() only blocks
+ *  when the TX buffer is full. Added BIOWriteBuf(), BIOReadBuf() and overflow counters.
  *******************************************************************************************
 * Project master header file
 ********************************************************************/
 #include "MCUType.h"
 #include "BasicIO.h"
+#include "RingBuf.h"
 #include "math.h"
 
 /*******************************************************************************************
@@ -34,6 +39,12 @@
 static INT8C bioHtoA(INT8U hnib);   //Convert nibble to ascii
 static INT8U bioIsHex(INT8C c);
 static INT8U bioHtoB(INT8C c);
+static RING_BUF_T bioTxBuf;         //Producer is the task level, consumer is the ISR
+static RING_BUF_T bioRxBuf;         //Producer is the ISR, consumer is the task level
+static INT8U bioTxStore[BIO_TX_BUF_SIZE];
+static INT8U bioRxStore[BIO_RX_BUF_SIZE];
+static volatile INT32U bioRxOverruns = 0;   //UART overruns, counted by the ISR
+void UART2_RX_TX_IRQHandler(void);
 /*******************************************************************************************
  * void BIOOpen(INT8U rate) - Initializes UART to operate at a specified rate.
  * MCU: K65, UART2 configured for debugger USB.
@@ -83,24 +94,58 @@ void BIOOpen(INT8U rate){
         UART2->C4 = 0x14U;
         break;
     }
+    RingBufInit(&bioTxBuf, bioTxStore, BIO_TX_BUF_SIZE);
+    RingBufInit(&bioRxBuf, bioRxStore, BIO_RX_BUF_SIZE);
+    bioRxOverruns = 0;
     UART2->C2 |= UART_C2_TE_MASK;    //enables transmission
     UART2->C2 |= UART_C2_RE_MASK;    //enables receive
+    UART2->C2 |= UART_C2_RIE_MASK;   //RX interrupt, TX interrupt is enabled when there is data
+    NVIC_ClearPendingIRQ(UART2_RX_TX_IRQn);
+    NVIC_EnableIRQ(UART2_RX_TX_IRQn);
 
 }
 
+/*******************************************************************************************
+* UART2_RX_TX_IRQHandler() - Moves a received character into the RX buffer and the next
+*                            character from the TX buffer to the UART. The TX interrupt is
+*                            turned off when the TX buffer is empty.
+*    MCU: K65, UART2
+*******************************************************************************************/
+void UART2_RX_TX_IRQHandler(void){
+    INT8U s1;
+    INT8U c;
+    s1 = UART2->S1;                                         //S1 then D read clears RDRF and OR
+    if((s1 & (UART_S1_RDRF_MASK | UART_S1_OR_MASK)) != 0){
+        c = UART2->D;
+        if((s1 & UART_S1_OR_MASK) != 0){
+            bioRxOverruns++;
+        }else{
+        }
+        (void)RingBufPut(&bioRxBuf, c);                     //a full buffer counts as dropped
+    }else{
+    }
+    if(((UART2->C2 & UART_C2_TIE_MASK) != 0) && ((s1 & UART_S1_TDRE_MASK) != 0)){
+        if(RingBufGet(&bioTxBuf, &c) != 0){
+            UART2->D = c;
+        }else{
+            UART2->C2 &= (INT8U)~UART_C2_TIE_MASK;
+        }
+    }else{
+    }
+}
+
 /*******************************************************************************************
 * BIORead() - Checks for a character received
 *    MCU: K65, UART2
 *    return: ASCII character received or 0 if no character received
 *******************************************************************************************/
 INT8C BIORead(void){
-    INT8C c;
-    if ((UART2->S1 & UART_S1_RDRF_MASK) != 0){   //check if char received
-        c = UART2->D;
-    }else{
+    INT8U c;
+    if (RingBufGet(&bioRxBuf, &c) == 0){        //check if char received
         c = '\0';                           //If not return 0
+    }else{
     }
-    return (c);
+    return ((INT8C)c);
 }
 /*******************************************************************************************
 * BIOGetChar() - Blocks until character is received
@@ -116,13 +161,54 @@ INT8C BIOGetChar(void){
 
 /*******************************************************************************************
 * BIOWrite() - Sends an ASCII character
-*              Blocks as much as one character time
+*              Blocks only while the TX buffer is full
 *    MCU: K65, UART2
 *    parameter: c is the ASCII character to be sent
 *******************************************************************************************/
 void BIOWrite(INT8C c){
-    while ((UART2->S1 & UART_S1_TDRE_MASK)==0){} //waits until transmission
-    UART2->D = (INT8U)c;                             //is ready
+    while (RingBufSpace(&bioTxBuf) == 0){}      //waits for the ISR to make room
+    (void)RingBufPut(&bioTxBuf, (INT8U)c);
+    UART2->C2 |= UART_C2_TIE_MASK;              //ISR turns it off when empty
+}
+
+/*******************************************************************************************
+* BIOWriteBuf() - Queues up to len bytes for transmit without blocking
+*    MCU: K65, UART2
+*    parameters: buf is a pointer to the bytes, len is the number of bytes
+*    return: the number of bytes accepted
+*******************************************************************************************/
+INT16U BIOWriteBuf(const INT8C *const buf, INT16U len){
+    INT16U n;
+    n = RingBufWrite(&bioTxBuf, (const INT8U *)buf, len);
+    if(n != 0){
+        UART2->C2 |= UART_C2_TIE_MASK;
+    }else{
+    }
+    return n;
+}
+
+/*******************************************************************************************
+* BIOReadBuf() - Copies up to len received bytes without blocking
+*    parameters: buf is a pointer to the destination, len is its size
+*    return: the number of bytes copied
+*******************************************************************************************/
+INT16U BIOReadBuf(INT8C *const buf, INT16U len){
+    return RingBufRead(&bioRxBuf, (INT8U *)buf, len);
+}
+
+/*******************************************************************************************
+* BIOGetTxOverflows() - returns the number of bytes BIOWriteBuf() could not queue
+*******************************************************************************************/
+INT32U BIOGetTxOverflows(void){
+    return bioTxBuf.dropped;
+}
+
+/*******************************************************************************************
+* BIOGetRxOverflows() - returns the number of received bytes lost to a full RX buffer or
+*                       a UART overrun
+*******************************************************************************************/
+INT32U BIOGetRxOverflows(void){
+    return bioRxBuf.dropped + bioRxOverruns;
 }
 
 /*******************************************************************************************
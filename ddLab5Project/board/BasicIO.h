@@ -21,6 +21,10 @@
  * v4.2
  *  Created by Todd Morton
  *  Modified to fix bug in BOIGetStrg() so a BS can be the first character pressed.
+ * v5.1
+ *  Modified by Dominic Danis
+ *  UART2 RX and TX are interrupt driven through RingBuf ring buffers so BIOWrite() only blocks
+ *  when the TX buffer is full. Added BIOWriteBuf(), BIOReadBuf() and overflow counters.
 ********************************************************************/
 #ifndef BIO_INCL
 #define BIO_INCL
@@ -34,6 +38,12 @@
 #define BIO_BIT_RATE_57600  3
 #define BIO_BIT_RATE_115200 4
 
+/******************************************************************************************
+ * Ring buffer sizes, must be powers of 2
+ ******************************************************************************************/
+#define BIO_TX_BUF_SIZE     1024U
+#define BIO_RX_BUF_SIZE     128U
+
 /*************************************************************************
 * Enumerated type for mode parameter in BIOOutDecWord()
 *************************************************************************/
@@ -90,11 +100,41 @@ INT8U BIOGetStrg(INT8U strglen,INT8C *const strg); /*input a string */
 
 /********************************************************************
 * BIOWrite() - Sends an ASCII character
-*              Blocks as much as one character time
+*              Queues the character for the TX interrupt. Only blocks
+*              while the TX buffer is full. Must not be called with
+*              interrupts masked.
 *    parameter: c is the ASCII character to be sent
 ********************************************************************/
 void BIOWrite(INT8C c);  /* Send an ascii character */
 
+/********************************************************************
+* BIOWriteBuf() - Queues up to len bytes for transmit. Never blocks.
+*    parameters: buf is a pointer to the bytes, len is the number of bytes
+*    return: the number of bytes accepted. The rest are counted as
+*            TX overflows.
+********************************************************************/
+INT16U BIOWriteBuf(const INT8C *const buf, INT16U len);
+
+/********************************************************************
+* BIOReadBuf() - Copies up to len received bytes. Never blocks.
+*    parameters: buf is a pointer to the destination, len is its size
+*    return: the number of bytes copied
+********************************************************************/
+INT16U BIOReadBuf(INT8C *const buf, INT16U len);
+
+/********************************************************************
+* BIOGetTxOverflows() - returns the number of bytes BIOWriteBuf()
+*                       could not queue since BIOOpen()
+********************************************************************/
+INT32U BIOGetTxOverflows(void);
+
+/********************************************************************
+* BIOGetRxOverflows() - returns the number of received bytes lost
+*                       because the RX buffer was full or the UART
+*                       overran since BIOOpen()
+********************************************************************/
+INT32U BIOGetRxOverflows(void);
+
 /********************************************************************
 * BIOPutStrg() - Sends a C string
 *    parameter: strg is a pointer to the string
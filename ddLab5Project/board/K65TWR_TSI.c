@@ -2,107 +2,229 @@
  * Todd Morton, 11/18/2014
  * Todd Morton, 11/19/2018 MCUXpresso version
  * Todd Morton, 11/17/2020 MCUX11.2 version
+ * Dominic Danis, End of scan interrupt processing, no busy waits
+ * Dominic Danis, Adaptive baseline with touch/release hysteresis, see TSIFilter.c
+ * Dominic Danis, Table driven electrode list scanned round-robin
+ * Dominic Danis, Cycle count stamp of the first touch since the last read for latency measurement
+ * Dominic Danis, Register, pin and NVIC access through macros so the driver runs against a mock TSI0
+ * Dominic Danis, Touch stamp from SysTickGetCycleStamp(), the DWT cycle count stops in WFI sleep
  */
 #include "MCUType.h"
 #include "K65TWR_GPIO.h"
 #include "K65TWR_TSI.h"
-
-typedef enum {PROC1START2, PROC2START1} TSI_TASK_STATE_T;
-typedef struct{
-    INT16U baseline;
-    INT16U offset;
-    INT16U threshold;
-}TOUCH_LEVEL_T;
-
+#include "Profile.h"
+#include "SysTickDelay.h"
+#include "TSIFilter.h"
 
 #define MAX_NUM_ELECTRODES 16U
+#define MAX_SCAN_SEQ     32U        // Max scans in one round, sum of the weights
+
+/* Electrode configuration. The pin is set to ALT0 for TSI. weight is the number
+ * of times the channel is scanned in each round, interleaved with the others.
+ * touch_offset and release_offset are the thresholds above the baseline. */
+typedef struct{
+    INT8U channel;
+    PORT_Type *port;
+    INT8U pin;
+    INT16U touch_offset;
+    INT16U release_offset;
+    INT8U weight;
+}TSI_ELECTRODE_T;
 
 #define E1_TOUCH_OFFSET  0x0400U    // Touch offset from baseline
 #define E2_TOUCH_OFFSET  0x0400U    // Determined experimentally
-#define TSI0_ENABLE()    TSI0->GENCS |= TSI_GENCS_TSIEN_MASK
-#define TSI0_DISABLE()   TSI0->GENCS &= ~TSI_GENCS_TSIEN_MASK
+#define E1_RELEASE_OFFSET 0x0300U   // Release offset from baseline, hysteresis
+#define E2_RELEASE_OFFSET 0x0300U
+#define TOUCH_DEBOUNCE   2U         // Scans in a row to accept a touch
+#define RELEASE_DEBOUNCE 2U         // Scans in a row to accept a release
+
+/* TSI0 registers. Can be defined on the command line to use a mock TSI0 */
+#ifndef TSI_REGS
+#define TSI_REGS         TSI0
+#endif
+#define TSI0_ENABLE()    TSI_REGS->GENCS |= TSI_GENCS_TSIEN_MASK
+#define TSI0_DISABLE()   TSI_REGS->GENCS &= ~TSI_GENCS_TSIEN_MASK
 
+/* Clock gates and pin mux, and the NVIC setup. Can be defined on the command line to stub them out */
+#ifndef TSI_HW_INIT
+#define TSI_HW_INIT()    tsiHwInit()
+#endif
+#ifndef TSI_IRQ_INIT
+#define TSI_IRQ_INIT()   do{NVIC_ClearPendingIRQ(TSI0_IRQn); NVIC_EnableIRQ(TSI0_IRQn);}while(0)
+#endif
 
-static TOUCH_LEVEL_T tsiSensorLevels[MAX_NUM_ELECTRODES];
+
+void TSI0_IRQHandler(void);         // Must not be static so linker can see it
+static TSI_FILT_T tsiSensorLevels[MAX_NUM_ELECTRODES];
+static TSI_FILT_CFG_T tsiSensorCfg[MAX_NUM_ELECTRODES];
 static void tsiStartScan(INT8U channel);
-static void tsiProcScan(INT8U channel);
-static INT16U tsiSensorFlags = 0;
+static void tsiProcScan(INT8U channel, INT16U count);
+static void tsiStartRound(void);
+static volatile INT16U tsiSensorFlags = 0;
+static volatile INT32U tsiSensorStamp = 0;  // Cycle stamp when tsiSensorFlags went non-zero
+static volatile INT16U tsiCalPending = 0;   // Channels whose next scan is a calibration
+static volatile INT8U tsiScanBusy = 0;      // A scan round is in progress
+static INT8U tsiScanIndex = 0;              // Index in tsiScanSeq being scanned
+static INT8U tsiScanSeq[MAX_SCAN_SEQ];      // Channels in scan order for one round
+static INT8U tsiScanLen = 0;
+static void tsiBuildScanSeq(void);
+static void tsiHwInit(void);
+
+/* Electrodes in use. Pads E1 and E2 on the K65 tower board. Can be defined on
+ * the command line to scan another electrode set */
+#ifndef TSI_ELECTRODES
+#define TSI_ELECTRODES \
+    /* channel, port, pin, touch offset, release offset, weight */ \
+    {BRD_PAD1_CH, PORTB, 19U, E1_TOUCH_OFFSET, E1_RELEASE_OFFSET, 1U}, \
+    {BRD_PAD2_CH, PORTB, 18U, E2_TOUCH_OFFSET, E2_RELEASE_OFFSET, 1U}
+#endif
+static const TSI_ELECTRODE_T tsiElectrodes[] = {
+    TSI_ELECTRODES
+};
+#define TSI_NUM_ELECTRODES (sizeof(tsiElectrodes)/sizeof(tsiElectrodes[0]))
 
 
 /********************************************************************************
  * K65TWR_TSI0Init: Initializes TSI0 module
  * Notes:
- *    -
+ *    - Scans are processed by TSI0_IRQHandler() at the end of each scan. The
+ *      first round calibrates every electrode so they must not be pressed.
  ********************************************************************************/
 void TSIInit(void){
+    INT8U i;
+    const TSI_ELECTRODE_T *elec;
 
-    SIM->SCGC5 |= SIM_SCGC5_TSI(1);         //Turn on clock to TSI module
-    SIM->SCGC5 |= SIM_SCGC5_PORTB(1);
-
-    PORTB->PCR[18]=PORT_PCR_MUX(0);         //Set electrode pins to ALT0
-    PORTB->PCR[19]=PORT_PCR_MUX(0);
-    tsiSensorLevels[BRD_PAD1_CH].offset = E1_TOUCH_OFFSET;
-    tsiSensorLevels[BRD_PAD2_CH].offset = E2_TOUCH_OFFSET;
+    TSI_HW_INIT();
+    for(i = 0; i < TSI_NUM_ELECTRODES; i++){
+        elec = &tsiElectrodes[i];
+        tsiSensorCfg[elec->channel].touch_offset = elec->touch_offset;
+        tsiSensorCfg[elec->channel].release_offset = elec->release_offset;
+        tsiSensorCfg[elec->channel].touch_cnt = TOUCH_DEBOUNCE;
+        tsiSensorCfg[elec->channel].release_cnt = RELEASE_DEBOUNCE;
+    }
+    tsiBuildScanSeq();
 
 
     //16 consecutive scans, Prescale divide by 32, software trigger
     //16uA ext. charge current, 16uA Ref. charge current, .592V dV
-    TSI0->GENCS = ((TSI_GENCS_EXTCHRG(5))|
-                   (TSI_GENCS_REFCHRG(5))|
-                   (TSI_GENCS_DVOLT(1))|
-                   (TSI_GENCS_PS(5))|
-                   (TSI_GENCS_NSCN(15)));
+    //Interrupt at end of scan
+    TSI_REGS->GENCS = ((TSI_GENCS_EXTCHRG(5))|
+                       (TSI_GENCS_REFCHRG(5))|
+                       (TSI_GENCS_DVOLT(1))|
+                       (TSI_GENCS_PS(5))|
+                       (TSI_GENCS_NSCN(15))|
+                       (TSI_GENCS_TSIIEN(1))|
+                       (TSI_GENCS_ESOR(1)));
 
     TSI0_ENABLE();
-    TSIChCalibration(BRD_PAD1_CH);
-    TSIChCalibration(BRD_PAD2_CH);
+    TSI_IRQ_INIT();
+    for(i = 0; i < TSI_NUM_ELECTRODES; i++){
+        TSIChCalibration(tsiElectrodes[i].channel);
+    }
+}
+
+/********************************************************************************
+ *   tsiHwInit: Turns on the TSI and port clocks and sets the electrode pins
+ *              to ALT0.
+ ********************************************************************************/
+static void tsiHwInit(void){
+    INT8U i;
+    const TSI_ELECTRODE_T *elec;
+    SIM->SCGC5 |= SIM_SCGC5_TSI(1);         //Turn on clock to TSI module
+    SIM->SCGC5 |= SIM_SCGC5_PORTA(1)|SIM_SCGC5_PORTB(1)|SIM_SCGC5_PORTC(1); //TSI pins are on A,B,C
+    for(i = 0; i < TSI_NUM_ELECTRODES; i++){
+        elec = &tsiElectrodes[i];
+        elec->port->PCR[elec->pin] = PORT_PCR_MUX(0);   //Set electrode pins to ALT0
+    }
+}
+
+/********************************************************************************
+ *   tsiBuildScanSeq: Builds the scan order for one round from tsiElectrodes.
+ *                    Pass n adds every electrode with a weight greater than n,
+ *                    so heavier electrodes are spread through the round.
+ ********************************************************************************/
+static void tsiBuildScanSeq(void){
+    INT8U pass;
+    INT8U i;
+    INT8U added;
+    tsiScanLen = 0;
+    pass = 0;
+    do{
+        added = 0;
+        for(i = 0; i < TSI_NUM_ELECTRODES; i++){
+            if((tsiElectrodes[i].weight > pass) && (tsiScanLen < MAX_SCAN_SEQ)){
+                tsiScanSeq[tsiScanLen] = tsiElectrodes[i].channel;
+                tsiScanLen++;
+                added = 1;
+            }else{
+            }
+        }
+        pass++;
+    }while(added != 0);
 }
 
 /********************************************************************************
  *   TSICalibration: Calibration to find non-touch baseline for a channel
  *                   channel - the channel to calibrate, range 0-15
- *                   Note - the sensor must not be pressed when this is executed.
+ *                   Note - the sensor must not be pressed during the next
+ *                   scan of the channel. Does not wait for the scan, the
+ *                   baseline is taken in TSI0_IRQHandler().
  ********************************************************************************/
 void TSIChCalibration(INT8U channel){
-        tsiStartScan(channel);
-        while((TSI0->GENCS & TSI_GENCS_EOSF_MASK) == 0){} //wait for scan to finish
-        TSI0->GENCS |= TSI_GENCS_EOSF(1);    //Clear flag
-        tsiSensorLevels[channel].baseline = (INT16U)(TSI0->DATA & TSI_DATA_TSICNT_MASK);
-        tsiSensorLevels[channel].threshold = tsiSensorLevels[channel].baseline +
-                                             tsiSensorLevels[channel].offset;
+    INT32U primask;
+    if(channel < MAX_NUM_ELECTRODES){
+        primask = __get_PRIMASK();
+        __disable_irq();
+        tsiCalPending |= (INT16U)(1<<channel);
+        __set_PRIMASK(primask);
+        if((tsiScanBusy == 0) && (tsiScanLen != 0)){
+            tsiStartRound();
+        }else{
+        }
+    }else{
+    }
 }
 
 /********************************************************************************
  *   TSITask: Cooperative task for timeslice scheduler
- *            Processes and starts alternate sensors each time through to avoid
- *            blocking.
- *            In order to not block the task period should be > 5ms.
+ *            Starts a scan round if the last one has finished. The round is
+ *            processed and chained from channel to channel by TSI0_IRQHandler()
+ *            so the task never waits on a scan.
  *            To not miss a press, the task period should be < ~25ms.
   ********************************************************************************/
 void TSITask(void){
+    if((tsiScanBusy == 0) && (tsiScanLen != 0)){
+        tsiStartRound();
+    }else{
+    }
+}
 
-    static TSI_TASK_STATE_T tsiTaskState = PROC1START2;
-    DB3_TURN_ON();
-    tsiStartScan(BRD_PAD1_CH);
-
-    switch(tsiTaskState){
-    case PROC1START2:
-        tsiProcScan(BRD_PAD1_CH);
-        DB1_TURN_ON();
-        tsiStartScan(BRD_PAD2_CH);
-        tsiTaskState = PROC2START1;
-        break;
-    case PROC2START1:
-        tsiProcScan(BRD_PAD2_CH);
-        DB1_TURN_OFF();
-        tsiStartScan(BRD_PAD1_CH);
-        tsiTaskState = PROC1START2;
-        break;
-    default:
-        tsiTaskState = PROC1START2;
-        break;
+/********************************************************************************
+ *   TSI0_IRQHandler: End of scan interrupt. Processes the channel that finished
+ *                    and starts the next channel in tsiScanSeq. The round ends
+ *                    after the last channel.
+ ********************************************************************************/
+void TSI0_IRQHandler(void){
+    INT32U start = ProfileStart();
+    TSI_REGS->GENCS |= TSI_GENCS_EOSF(1);    //Clear flag
+    tsiProcScan(tsiScanSeq[tsiScanIndex], (INT16U)(TSI_REGS->DATA & TSI_DATA_TSICNT_MASK));
+    tsiScanIndex++;
+    if(tsiScanIndex < tsiScanLen){
+        tsiStartScan(tsiScanSeq[tsiScanIndex]);
+    }else{
+        tsiScanIndex = 0;
+        tsiScanBusy = 0;
     }
-    DB3_TURN_OFF();
+    ProfileStop(PROF_ID_TSI0, start);
+}
+
+/********************************************************************************
+ *   tsiStartRound: Starts a scan round with the first channel in tsiScanSeq.
+ ********************************************************************************/
+static void tsiStartRound(void){
+    tsiScanBusy = 1;
+    tsiScanIndex = 0;
+    tsiStartScan(tsiScanSeq[0]);
 }
 
 /********************************************************************************
@@ -110,24 +232,29 @@ void TSITask(void){
  *                    channel - the TSI channel to be started. Range 0-15
  ********************************************************************************/
 static void tsiStartScan(INT8U channel){
-    TSI0->DATA = TSI_DATA_TSICH(channel);       //set channel
-    TSI0->DATA |= TSI_DATA_SWTS(1);             //start a scan sequence
+    TSI_REGS->DATA = TSI_DATA_TSICH(channel);   //set channel
+    TSI_REGS->DATA |= TSI_DATA_SWTS(1);         //start a scan sequence
 }
 
 /********************************************************************************
- *   TSIProcScan: Waits for the scan to complete, then sets the appropriate
- *                flags is a touch was detected.
- *                Note the scan must be started before this is called.
+ *   TSIProcScan: Runs the channel filter and sets the appropriate flag while
+ *                the channel is touched, or sets the initial baseline if a
+ *                calibration is pending for the channel.
+ *                Called from TSI0_IRQHandler() with the scan result.
  *                channel - the channel to be processed
+ *                count - the TSI count for the channel
  ********************************************************************************/
-static void tsiProcScan(INT8U channel){
-
-    while((TSI0->GENCS & TSI_GENCS_EOSF_MASK) == 0){}
-    TSI0->GENCS |= TSI_GENCS_EOSF(1);    //Clear flag
-
-    /* Process channel */
-    if((INT16U)(TSI0->DATA & TSI_DATA_TSICNT_MASK) > tsiSensorLevels[channel].threshold){
-        tsiSensorFlags |= (INT16U)(1<<channel);
+static void tsiProcScan(INT8U channel, INT16U count){
+    INT16U chbit = (INT16U)(1<<channel);
+    if((tsiCalPending & chbit) != 0){
+        TSIFiltInit(&tsiSensorLevels[channel], count);
+        tsiCalPending &= (INT16U)~chbit;
+    }else if(TSIFiltUpdate(&tsiSensorLevels[channel], &tsiSensorCfg[channel], count) != 0){
+        if(tsiSensorFlags == 0){
+            tsiSensorStamp = SysTickGetCycleStamp();   // First touch since the last read
+        }else{
+        }
+        tsiSensorFlags |= chbit;
     }else{
     }
 
@@ -135,11 +262,50 @@ static void tsiProcScan(INT8U channel){
 
 /********************************************************************************
  *   TSIGetSensorFlags: Returns value of sensor flag variable and clears it
- *                      to receive sensor press only one time.
+ *                      to receive sensor press only one time. Bit n is set if
+ *                      channel n was touched since the last read.
  ********************************************************************************/
 INT16U TSIGetSensorFlags(void){
+    INT32U stamp;
+    return TSIGetSensorFlagsStamped(&stamp);
+}
+
+/********************************************************************************
+ *   TSIGetSensorFlagsStamped: Same as TSIGetSensorFlags() and also returns in
+ *                      *stamp the SysTickGetCycleStamp() value of the scan
+ *                      that set the first flag since the last read. *stamp is
+ *                      only valid when the returned flags are not zero.
+ ********************************************************************************/
+INT16U TSIGetSensorFlagsStamped(INT32U *stamp){
     INT16U sflags;
+    INT32U primask;
+    primask = __get_PRIMASK();
+    __disable_irq();
     sflags = tsiSensorFlags;
+    *stamp = tsiSensorStamp;
     tsiSensorFlags = 0;
+    __set_PRIMASK(primask);
     return sflags;
 }
+
+/********************************************************************************
+ *   TSIGetChLevels: Copies the last raw count, the filtered count and the
+ *                   baseline of a channel into *levels. The filtered count and
+ *                   baseline are rounded down to whole counts.
+ *                   channel - the channel to read. Range 0-15
+ ********************************************************************************/
+void TSIGetChLevels(INT8U channel, TSI_LEVELS_T *levels){
+    INT32U primask;
+    if(channel < MAX_NUM_ELECTRODES){
+        primask = __get_PRIMASK();
+        __disable_irq();
+        levels->raw = tsiSensorLevels[channel].raw;
+        levels->filtered = (INT16U)(tsiSensorLevels[channel].filtered >> TSI_FILT_FRAC);
+        levels->baseline = (INT16U)(tsiSensorLevels[channel].baseline >> TSI_FILT_FRAC);
+        __set_PRIMASK(primask);
+    }else{
+        levels->raw = 0;
+        levels->filtered = 0;
+        levels->baseline = 0;
+    }
+}
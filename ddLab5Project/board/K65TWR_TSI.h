@@ -4,9 +4,17 @@
 #define BRD_PAD1_CH  12U
 #define BRD_PAD2_CH  11U
 
+typedef struct{
+    INT16U raw;
+    INT16U filtered;
+    INT16U baseline;
+}TSI_LEVELS_T;
+
 void TSIInit(void);
 void TSIChCalibration(INT8U channel);
 INT16U TSIGetSensorFlags(void);
+INT16U TSIGetSensorFlagsStamped(INT32U *stamp);
 void TSITask(void);
+void TSIGetChLevels(INT8U channel, TSI_LEVELS_T *levels);
 
 #endif
@@ -1,8 +1,6 @@
 /****************************************************************************************
-* Key.c - A keypad module for a 4x4 matrix keypad. This version allows for multiple
-*         column keys to be pressed and mapped to a different code by changing ColTable[]
-*         in KeyScan().
-*         Multiple rows can not be resolved. The topmost button will be used.
+* Key.c - A keypad module for a 4x4 matrix keypad. Every key is scanned into a 16-bit
+*         matrix word and debounced on its own, so several keys can be down at once.
 *         The KeyCoeTable[] is currently set to generate ASCII codes.
 * 02/20/2001 TDM Original key.c for 9S12
 * 01/14/2013 TDM Modified for K70 custom tower board.
@@ -11,20 +9,44 @@
 *            from B60 to A64 on the tower. Also, PORTA bit 6 must remain an unsued input.
 * 12/08/2015 Changed type for control codes.
 * 10/29/2018 Modified for MCUXpresso, Todd Morton
+* keyBuffer replaced by a queue of timestamped key down and key up events so fast key
+* entry is not lost between reads. Dominic Danis
+* Idle mode: while no key is down all rows are driven low and the columns are armed for
+* falling-edge interrupts, so KeyTask() does not scan until PORTC_IRQHandler() sees a
+* press. Scanning continues until the keypad has been released for KEY_IDLE_SCANS scans.
+* Dominic Danis
+* Full matrix scan debounced with KeyDebounce(). Events are queued for each key from the
+* press and release masks, KeyGetState() returns the keys held down for chords, and
+* ambiguous samples are ignored and counted. Dominic Danis
+* Pipelined scan: KeyTick() runs from the 1ms SysTick, reads the columns for the row it
+* drove on the last tick and then drives the next row, so keyDly() is gone and the scan
+* does not depend on the core clock. KeyTask() debounces the newest full frame.
+* Dominic Danis
 *****************************************************************************************
 * Project master header file
 ****************************************************************************************/
 #include "MCUType.h"
 #include "Key.h"
 #include "K65TWR_GPIO.h"
+#include "KeyQueue.h"
+#include "KeyDebounce.h"
+#include "SysTickDelay.h"
 /****************************************************************************************
 * Private Resources
 ****************************************************************************************/
-static INT8U keyScan(void);         /* Makes a single keypad scan  */
-static INT8C keyBuffer;             /* Holds the ASCII code for key*/
+static void keyDriveRow(INT8U row);
+static void keyStartScan(void);
+static void keyHwInit(void);
+static KEY_DB_T keyDb;              /* Debounced keys, KeyTask() only */
+static INT32U keyGhosts;            /* Ambiguous scans ignored */
+static KEY_QUEUE_T keyQueue;        /* Key events, KeyTask() pushes */
+static void keyQueueEvent(INT8U kcode, KEY_EVENT_TYPE type);
+static void keyQueueMask(INT16U mask, KEY_EVENT_TYPE type);
+static void keyArm(void);
+static void keyColIrq(INT8U irqc);
+void PORTC_IRQHandler(void);
 static const INT8C keyCodeTable[16] =
    {'1','2','3',DC1,'4','5','6',DC2,'7','8','9',DC3,'*','0','#',DC4};
-static void keyDly(void);           /* Added for GPIO to settle before read */
 /****************************************************************************************
 * Module Defines
 * This version is designed for the custom LCD/Keypad board, which has the following
@@ -32,27 +54,123 @@ static void keyDly(void);           /* Added for GPIO to settle before read */
 *  COL1->PTC3, COL2->PTC4, COL3->PTC5, COL4->PTC6
 *  ROW1->PTC7, ROW2->PTC8, ROW3->PTC9, ROW4->PTC10
 ****************************************************************************************/
-typedef enum{KEY_OFF,KEY_EDGE,KEY_VERF} KEYSTATES;
-#define KEY_PORT_OUT   GPIOC->PDOR
-#define KEY_PORT_DIR   GPIOC->PDDR
-#define KEY_PORT_IN	   GPIOC->PDIR
+typedef enum{KEY_MODE_IDLE,KEY_MODE_SCAN} KEYMODES;
+#define KEY_IDLE_SCANS 3U   /* Released scans in a row before going back to idle */
+#define KEY_COL_FIRST  3U   /* First column pin, PTC3-PTC6 */
+#define KEY_NUM_COLS   4U
+#define KEY_NUM_ROWS   4U   /* Must be a power of 2 */
+#define KEY_ROW_FIRST  0x00000080U
+static volatile KEYMODES keyMode;   /* Interrupt armed idle or scanning, KeyTick() reads */
+static volatile INT8U keyWake;      /* Set by PORTC_IRQHandler() on a column edge */
+static INT8U keyRow;                /* Row driven on the last tick, KeyTick() only while scanning */
+static INT16U keyRowKeys;           /* Frame being collected, KeyTick() only while scanning */
+static volatile INT16U keyFrame;    /* Last complete frame, written by KeyTick() */
+static volatile INT8U keyFrameCnt;  /* Counts complete frames, written by KeyTick() */
+#ifndef KEY_GPIO
+#define KEY_GPIO       GPIOC  /* Can be defined on the command line to use a mock port */
+#define KEY_PORT       PORTC
+#endif
+#define KEY_PORT_OUT   KEY_GPIO->PDOR
+#define KEY_PORT_DIR   KEY_GPIO->PDDR
+#define KEY_PORT_IN	   KEY_GPIO->PDIR
+/* Pin mux, clock gate and NVIC setup. Can be defined on the command line for a host build */
+#ifndef KEY_HW_INIT
+#define KEY_HW_INIT()  keyHwInit()
+#endif
 #define COLS_MASK 0x00000078U
 #define ROWS_MASK 0x00000780U
 #define COLS_IN() (((~KEY_PORT_IN) & COLS_MASK)>>3)
+/* Timestamp source for key events. Can be defined on the command line for a host build */
+#ifndef KEY_MS
+#define KEY_MS() SysTickGetmsCount()
+#endif
+/* Orders the scan state setup before the mode change that KeyTick() reads. Can be defined on the
+ * command line for a host build */
+#ifndef KEY_BARRIER
+#define KEY_BARRIER() __DMB()
+#endif
 /****************************************************************************************
-* KeyGet() - This function provides public access to keyBuffer. It clears keyBuffer
-*            after for read-once handshaking. Note: this handshaking method only works
-*            when 0x00 is not a valid keycode. If it is a valid keycode then a semaphore
-*            should be added.
+* KeyGet() - Returns the code of the oldest queued key press and removes it. Key up events
+*            in front of it are discarded. Returns 0 if there are no key presses queued.
+*            0x00 is not a valid keycode.
 * - Public
 ****************************************************************************************/
 INT8C KeyGet(void){
-    INT8C key;
-    key = keyBuffer;
-    keyBuffer = '\0';
+    KEY_EVENT_T event;
+    INT8C key = '\0';
+    while((key == '\0') && (KeyQueuePop(&keyQueue, &event) != 0)){
+        if(event.type == KEY_DOWN){
+            key = event.code;
+        }else{
+        }
+    }
     return (key);
 }
 
+/****************************************************************************************
+* KeyPeek() - Copies the oldest key event without removing it. Returns 1 if there was one.
+* - Public
+****************************************************************************************/
+INT8U KeyPeek(KEY_EVENT_T *event){
+    return KeyQueuePeek(&keyQueue, event);
+}
+
+/****************************************************************************************
+* KeyPop() - Copies and removes the oldest key event. Returns 1 if there was one.
+* - Public
+****************************************************************************************/
+INT8U KeyPop(KEY_EVENT_T *event){
+    return KeyQueuePop(&keyQueue, event);
+}
+
+/****************************************************************************************
+* KeyGetStats() - Copies the queue statistics. Each count is read once so the copy is
+*                 close to consistent while KeyTask() runs.
+* - Public
+****************************************************************************************/
+void KeyGetStats(KEY_STATS_T *stats){
+    stats->events = keyQueue.pushed;
+    stats->overflows = keyQueue.overflows;
+    stats->max_depth = keyQueue.max_depth;
+    stats->ghosts = keyGhosts;
+}
+
+/****************************************************************************************
+* KeyGetState() - Returns the debounced keys that are down, bit n for keyCodeTable[n].
+* - Public
+****************************************************************************************/
+INT16U KeyGetState(void){
+    return keyDb.state;
+}
+
+/****************************************************************************************
+* keyQueueEvent() - Queues a key event for a scan code, stamped with the ms count.
+* - Private
+****************************************************************************************/
+static void keyQueueEvent(INT8U kcode, KEY_EVENT_TYPE type){
+    KEY_EVENT_T event;
+    event.ms = KEY_MS();
+    event.code = keyCodeTable[kcode - 1];
+    event.type = type;
+    (void)KeyQueuePush(&keyQueue, &event);     /* A full queue counts an overflow */
+}
+
+/****************************************************************************************
+* keyQueueMask() - Queues one event for each key in mask, lowest key code first.
+* - Private
+****************************************************************************************/
+static void keyQueueMask(INT16U mask, KEY_EVENT_TYPE type){
+    INT8U kcode = 1;
+    while(mask != 0){
+        if((mask & 1U) != 0){
+            keyQueueEvent(kcode, type);
+        }else{
+        }
+        mask >>= 1;
+        kcode++;
+    }
+}
+
 /****************************************************************************************
 * KeyInit() - Initialization routine for the keypad module. The columns are normally set
 *             as inputs and, since they are pulled high, they are one. Then to pull a row
@@ -60,7 +178,21 @@ INT8C KeyGet(void){
 ****************************************************************************************/
 void KeyInit(void){
 
-    /* Key port init */
+    KEY_HW_INIT();
+    KEY_PORT_OUT &= ~ROWS_MASK;            /* Preset all rows to zero    */
+    KeyQueueInit(&keyQueue);               /* Init event queue   */
+    KeyDebounceInit(&keyDb);
+    keyGhosts = 0;
+    keyFrame = 0;
+    keyFrameCnt = 0;
+    keyArm();
+}
+
+/****************************************************************************************
+* keyHwInit() - Pin mux and interrupt setup for the keypad port.
+* - Private
+****************************************************************************************/
+static void keyHwInit(void){
     SIM->SCGC5 |= SIM_SCGC5_PORTC(1);     //Make sure that the gated clock for PORTC is on
     PORTC->PCR[3]=PORT_PCR_MUX(1)|PORT_PCR_PS_MASK|PORT_PCR_PE_MASK;   //Columns
     PORTC->PCR[4]=PORT_PCR_MUX(1)|PORT_PCR_PS_MASK|PORT_PCR_PE_MASK;
@@ -70,99 +202,141 @@ void KeyInit(void){
     PORTC->PCR[8]=PORT_PCR_MUX(1);
     PORTC->PCR[9]=PORT_PCR_MUX(1);
     PORTC->PCR[10]=PORT_PCR_MUX(1);
-    KEY_PORT_OUT &= ~ROWS_MASK;            /* Preset all rows to zero    */
-    keyBuffer = '\0';                      /* Init keyBuffer      */
+    NVIC_ClearPendingIRQ(PORTC_IRQn);
+    NVIC_EnableIRQ(PORTC_IRQn);
+}
+
+/****************************************************************************************
+* keyArm() - Enters idle mode. Stops KeyTick(), drives all rows low and arms the column
+*            falling-edge interrupts. A key that went down after the last frame makes no
+*            edge, so KeyTask() also checks the columns while idle.
+* - Private
+****************************************************************************************/
+static void keyArm(void){
+    keyMode = KEY_MODE_IDLE;               /* First, so KeyTick() leaves the rows alone */
+    KEY_PORT_OUT &= ~ROWS_MASK;
+    KEY_PORT_DIR |= ROWS_MASK;             /* All rows low */
+    keyWake = 0;
+    KEY_PORT->ISFR = COLS_MASK;            /* Clear old edges */
+    keyColIrq(PORT_IRQ_FE);
+}
+
+/****************************************************************************************
+* keyStartScan() - Leaves idle mode. Disarms the column interrupts, drives the first row
+*                  and hands the rows to KeyTick(), which reads it on the next tick.
+* - Private
+****************************************************************************************/
+static void keyStartScan(void){
+    keyColIrq(PORT_IRQ_OFF);
+    KEY_PORT->ISFR = COLS_MASK;
+    keyWake = 0;
+    keyRow = 0;
+    keyRowKeys = 0;
+    keyDriveRow(0);
+    KEY_BARRIER();                         /* keyRow and keyRowKeys are not volatile */
+    keyMode = KEY_MODE_SCAN;               /* Last, KeyTick() starts here */
+}
+
+/****************************************************************************************
+* keyDriveRow() - Pulls one row low by making it an output. The other rows are inputs.
+* - Private
+****************************************************************************************/
+static void keyDriveRow(INT8U row){
+    KEY_PORT_DIR = (KEY_PORT_DIR & ~ROWS_MASK)|(KEY_ROW_FIRST << row);
+}
+
+/****************************************************************************************
+* keyColIrq() - Sets the interrupt control of all four column pins. The ISF bits are
+*               masked so a pending flag is not cleared by accident.
+* - Private
+****************************************************************************************/
+static void keyColIrq(INT8U irqc){
+    INT8U pin;
+    for(pin = KEY_COL_FIRST; pin < (KEY_COL_FIRST + KEY_NUM_COLS); pin++){
+        KEY_PORT->PCR[pin] = (KEY_PORT->PCR[pin] & ~(PORT_PCR_IRQC_MASK|PORT_PCR_ISF_MASK))|PORT_PCR_IRQC(irqc);
+    }
 }
 
 /****************************************************************************************
-* KeyTask() - Reads the keypad and updates keyBuffer. A task decomposed into states for
-*             detecting and verifying keypresses. This task should be called periodically
-*             with a period between: Tb/2 < Tp < (Tact-Tb)/2
-*             The switch must be released to have multiple acknowledged presses.
+* PORTC_IRQHandler() - A column went low while idle. Disarms the column interrupts and
+*                      wakes KeyTask() to start scanning.
+* - Interrupt
+****************************************************************************************/
+void PORTC_IRQHandler(void){
+    KEY_PORT->ISFR = COLS_MASK;
+    keyColIrq(PORT_IRQ_OFF);
+    keyWake = 1;
+}
+
+/****************************************************************************************
+* KeyTick() - One step of the pipelined scan. Reads the columns for the row driven on the
+*             last tick, then drives the next row, so each row has a whole tick to
+*             settle. Every KEY_NUM_ROWS ticks a frame is complete. The frame has bit
+*             (row*4)+column set for each key down, so bit n is keyCodeTable[n]:
+*               1->bit0, 2->bit1, 3->bit2, A->bit3 ... *->bit12, 0->bit13, #->bit14,
+*               D->bit15
+*             Does nothing while idle.
+* (Public)
+****************************************************************************************/
+void KeyTick(void){
+    if(keyMode == KEY_MODE_SCAN){
+        keyRowKeys |= (INT16U)(COLS_IN() << (keyRow * KEY_NUM_COLS));   /*Read columns */
+        keyRow = (INT8U)((keyRow + 1U) & (KEY_NUM_ROWS - 1U));
+        if(keyRow == 0){
+            keyFrame = keyRowKeys;
+            keyFrameCnt++;
+            keyRowKeys = 0;
+        }else{
+        }
+        keyDriveRow(keyRow);
+    }else{
+    }
+}
+
+/****************************************************************************************
+* KeyTask() - Debounces the newest frame from KeyTick() and queues key events. Each task
+*             period is one debounce sample, so a key is queued after KEY_DB_SAMPLES
+*             samples. This task should be called periodically with a period between:
+*             Tb/KEY_DB_SAMPLES < Tp and KEY_DB_SAMPLES*Tp < Tact-Tb. The period must be
+*             longer than a frame, KEY_NUM_ROWS ticks.
 * (Public)
 ****************************************************************************************/
 void KeyTask(void) {
 
-    INT8U cur_key;
-    static INT8U last_key = 0;
-    static KEYSTATES keyState = KEY_OFF;
+    INT16U cur_keys;
+    INT8U frame_cnt;
+    static INT8U last_cnt = 0;
+    static INT8U idle_cnt = 0;
 
-    DB2_TURN_ON();
-    cur_key = keyScan();
-    if(keyState == KEY_OFF){    /* Key released state */
-        if(cur_key != 0){
-            keyState = KEY_EDGE;
-        }else{ /* wait for key press */
+    if(keyMode == KEY_MODE_IDLE){
+        if((keyWake != 0) || (COLS_IN() != 0)){     /* Edge seen or key already down */
+            last_cnt = keyFrameCnt;
+            idle_cnt = 0;
+            keyStartScan();
+        }else{                          /* Idle, nothing pressed */
         }
-    }else if(keyState == KEY_EDGE){     /* Keypress detected state*/
-        if(cur_key == last_key){        /* Keypress verified */
-            keyState = KEY_VERF;
-            keyBuffer = keyCodeTable[cur_key - 1]; /*update buffer */
-        }else if(cur_key == 0){        /* Unvalidated, start over */
-            keyState = KEY_OFF;
-        }else{                          /*Unvalidated, diff key edge*/
+    }else{
+        frame_cnt = keyFrameCnt;
+        if(frame_cnt != last_cnt){
+            last_cnt = frame_cnt;
+            cur_keys = keyFrame;
+            (void)KeyDebounce(&keyDb, cur_keys);
+            if(keyDb.ghost != 0){
+                keyGhosts++;
+            }else{
+            }
+            keyQueueMask(keyDb.released, KEY_UP);
+            keyQueueMask(keyDb.pressed, KEY_DOWN);
+            if((keyDb.state == 0) && (cur_keys == 0)){
+                idle_cnt++;
+                if(idle_cnt >= KEY_IDLE_SCANS){
+                    keyArm();
+                }else{
+                }
+            }else{
+                idle_cnt = 0;
+            }
+        }else{                          /* No new frame yet */
         }
-    }else if(keyState == KEY_VERF){     /* Keypress verified state */
-        if((cur_key == 0) || (cur_key != last_key)){
-            keyState = KEY_OFF;
-        }else{ /* wait for release or key change */
-        }
-    }else{ /* In case of error */
-        keyState = KEY_OFF;             /* Should never get here */
-    }
-    last_key = cur_key;                 /* Save key for next time */
-    DB2_TURN_OFF();
-}
-
-/****************************************************************************************
-* keyScan() - Scans the keypad and returns a keycode.
-*           - Designed for 4x4 keypad with columns pulled high.
-*           - Current keycodes follow:
-*               1->0x01,2->0x02,3->0x03,A->0x04
-*               4->0x05,5->0x06,6->0x07,B->0x08
-*               7->0x09,8->0x0A,9->0x0B,C->0x0C
-*               *->0x0D,0->0x0E,#->0x0F,D->0x10
-*           - Returns zero if no key is pressed.
-*           - ColTable[] can be changed to distinguish multiple keys
-*             pressed in the same row.
-* (Private)
-****************************************************************************************/
-static INT8U keyScan(void) {
-
-    INT8U kcode;
-    INT8U roff;
-    INT32U rbit;
-
-    const INT8U ColTable[16] = {0,1,2,2,3,3,3,3,4,4,4,4,4,4,4,4};
-
-    rbit = 0x00000080U;
-    roff = 0x00U;
-    while(rbit != 0){ /* Until all rows are scanned */
-        KEY_PORT_OUT &= ~ROWS_MASK;
-        KEY_PORT_DIR = (KEY_PORT_DIR & ~ROWS_MASK)|rbit;    /* Pull row low */
-        keyDly();	// wait for direction and col inputs to settle
-        kcode = (INT8U)(COLS_IN());  /*Read columns */
-        KEY_PORT_DIR = (KEY_PORT_DIR &~ROWS_MASK); 
-        if(kcode != 0){        /* generate key code if key pressed */
-            kcode = (INT8U)(roff + ColTable[kcode]);
-            break;
-        }else{}
-        rbit = ROWS_MASK & (rbit<<1);       /* setup for next row */
-        roff = (INT8U)(roff + 4);
     }
-    return (kcode); 
-}
-/****************************************************************************************
- * KeyDly() a software delay for KeyScan() to wait until port row bit direction and
- * column inputs are settled.
- * With debug bits included and a 180Mhz bus the delay is
- * 	Tdly = (55.5ns)i + 85ns
- * Currently set to ~862ns with i=14.
- * TDM 01/20/2013
- * Modified for 180MHz bus. Todd Morton 11/04/2015
- ****************************************************************************************/
-static void keyDly(void){
-	INT32U i;
-	for(i=0;i<14;i++){
-	}
 }
@@ -7,11 +7,15 @@
 *            from B60 to A64 on the tower. Also, PORTA bit 6 must remain an unsued input.
 * 12/08/2015 Changed type for control codes.
 * 10/29/2018 Modified for MCUXpresso, Todd Morton
+* Key event queue with timestamps, KeyPeek(), KeyPop() and KeyGetStats(). Dominic Danis
+* Full matrix debounce, KeyGetState() and a ghost count in KEY_STATS_T. Dominic Danis
+* KeyTick() pipelined row scan. Dominic Danis
 ******************************************************************************************
 * Public Resources
 *****************************************************************************************/
 #ifndef KEY_INC
 #define KEY_INC
+#include "KeyQueue.h"
 
 /*****************************************************************************************
 * Defines for the alpha keys: A, B, C, D
@@ -24,21 +28,64 @@
 
 
 /*****************************************************************************************
-* KeyGet() - Returns current value of the keypad buffer then clears the buffer.
-*            The value returned is the ASCII code for the key pressed or zero if no key
-*            was pressed.
+* Key event queue statistics
+*****************************************************************************************/
+typedef struct{
+    INT32U events;      /* Events queued since KeyInit() */
+    INT32U overflows;   /* Events dropped because the queue was full */
+    INT8U max_depth;    /* Most events waiting at one time */
+    INT32U ghosts;      /* Scans ignored because keys could not be resolved */
+}KEY_STATS_T;
+
+/*****************************************************************************************
+* KeyGet() - Returns the ASCII code of the oldest queued key press and removes it, or zero
+*            if no key was pressed. Release events ahead of it are discarded. Use KeyPop()
+*            to see releases and timestamps.
 *****************************************************************************************/
 INT8C KeyGet(void);
+
+/*****************************************************************************************
+* KeyPeek() - Copies the oldest key event into *event without removing it.
+*             Returns 1 if there was an event, 0 if the queue is empty.
+*****************************************************************************************/
+INT8U KeyPeek(KEY_EVENT_T *event);
+
+/*****************************************************************************************
+* KeyPop() - Copies the oldest key event into *event and removes it. event can be 0 to
+*            discard it. Returns 1 if there was an event, 0 if the queue is empty.
+*****************************************************************************************/
+INT8U KeyPop(KEY_EVENT_T *event);
+
+/*****************************************************************************************
+* KeyGetStats() - Copies the event queue statistics into *stats.
+*****************************************************************************************/
+void KeyGetStats(KEY_STATS_T *stats);
                               
+/*****************************************************************************************
+* KeyGetState() - Returns the debounced keys that are down. Bit n is set for the nth key
+*                 in reading order: '1','2','3',A,'4',...,'*','0','#',D. Used for chords.
+*****************************************************************************************/
+INT16U KeyGetState(void);
+
 /*****************************************************************************************
 * KeyInit() - Keypad Initialization. Must run before calling KeyTask.
 *****************************************************************************************/
 void KeyInit(void);
 
 /*****************************************************************************************
-* KeyTask() - The main keypad scanning task. It scans the keypad and updates the keypad
-*             buffer if a keypress was verified. This is a cooperative task that must be
-*             called with a period between: Tb/2 < Tp < (Tact-Tb)/2
+* KeyTick() - Advances the row scan by one row. Call it from a periodic interrupt, the
+*             1ms SysTick with SysTickSetTickHook(), after KeyInit(). A frame of all rows
+*             takes 4 calls.
+*****************************************************************************************/
+void KeyTick(void);
+
+/*****************************************************************************************
+* KeyTask() - The main keypad scanning task. It scans the keypad and queues a key down
+*             event when a keypress is verified and a key up event when it is released.
+*             It uses the frames scanned by KeyTick(). Keys are debounced over
+*             KEY_DB_SAMPLES scans. This is a cooperative task that must be called with a
+*             period between:
+*             Tb/KEY_DB_SAMPLES < Tp < (Tact-Tb)/KEY_DB_SAMPLES
 *****************************************************************************************/
 void KeyTask(void);
 
@@ -0,0 +1,65 @@
+/* KeyDebounce.c
+ * Vertical counter debounce for the keypad matrix. Each key has a 2-bit down counter held across two words, so
+ * one sample for all 16 keys costs a few logic operations no matter how many keys are down. A counter is reset
+ * while its key agrees with the debounced state and counts down while it differs. The key toggles when the
+ * counter wraps, after KEY_DB_SAMPLES samples.
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "KeyDebounce.h"
+
+#define KEY_DB_ROW(m, r)    (((m) >> ((r) * 4U)) & 0x0FU)
+
+/* KeyDebounceInit - takes a context, returns nothing.
+ * */
+void KeyDebounceInit(KEY_DB_T *db){
+    db->state = 0;
+    db->cnt0 = 0xFFFFU;
+    db->cnt1 = 0xFFFFU;
+    db->pressed = 0;
+    db->released = 0;
+    db->ghost = 0;
+}
+
+/* KeyDebounce - takes a context and a raw sample, returns the debounced keys.
+ * */
+INT16U KeyDebounce(KEY_DB_T *db, INT16U raw){
+    INT16U delta;
+    INT16U toggle;
+    if(KeyGhosting(raw) != 0){
+        db->ghost = 1;
+        db->pressed = 0;
+        db->released = 0;
+    }else{
+        db->ghost = 0;
+        delta = (INT16U)(raw ^ db->state);                      /*keys that differ*/
+        db->cnt0 = (INT16U)~(db->cnt0 & delta);                 /*count down, reset to 3 where equal*/
+        db->cnt1 = (INT16U)(db->cnt0 ^ (db->cnt1 & delta));
+        toggle = (INT16U)(delta & db->cnt0 & db->cnt1);         /*counter wrapped*/
+        db->state ^= toggle;
+        db->pressed = (INT16U)(toggle & db->state);
+        db->released = (INT16U)(toggle & ~db->state);
+    }
+    return db->state;
+}
+
+/* KeyGhosting - takes a raw sample, returns 1 if it is ambiguous.
+ * */
+INT8U KeyGhosting(INT16U raw){
+    INT8U ghost = 0;
+    INT8U r1;
+    INT8U r2;
+    INT8U both;
+    for(r1 = 0; r1 < 3U; r1++){
+        for(r2 = (INT8U)(r1 + 1U); r2 < 4U; r2++){
+            both = (INT8U)(KEY_DB_ROW(raw, r1) | KEY_DB_ROW(raw, r2));
+            if(((KEY_DB_ROW(raw, r1) & KEY_DB_ROW(raw, r2)) != 0) && ((both & (both - 1U)) != 0)){
+                ghost = 1;
+            }else{
+            }
+        }
+    }
+    return ghost;
+}
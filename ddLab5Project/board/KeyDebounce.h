@@ -0,0 +1,42 @@
+/* KeyDebounce.h - Header file for KeyDebounce.c - debounces all 16 keys of the 4x4 keypad at once with
+ * vertical counters.
+ * A key is a bit in a 16-bit matrix word, bit (row * 4) + column, the same order as the key codes in Key.c.
+ * The functions only work on the context passed to them so they can be run on the host.
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef KEY_DEBOUNCE_INC
+#define KEY_DEBOUNCE_INC
+
+/*Defined constants*/
+#define KEY_DB_SAMPLES  4U                      /*equal samples before a key changes state, set by the 2-bit counters*/
+
+/*Debounce context. cnt0 and cnt1 are bit 0 and bit 1 of a 2-bit down counter for each key*/
+typedef struct{
+    INT16U state;                               /*debounced keys, 1 is down*/
+    INT16U cnt0;
+    INT16U cnt1;
+    INT16U pressed;                             /*keys that went down on the last sample*/
+    INT16U released;                            /*keys that went up on the last sample*/
+    INT8U ghost;                                /*1 if the last sample was ambiguous and was ignored*/
+}KEY_DB_T;
+
+/* KeyDebounceInit - takes a context, returns nothing. All keys start up.
+ * */
+void KeyDebounceInit(KEY_DB_T *db);
+
+/* KeyDebounce - takes a context and one raw matrix sample, returns the debounced keys.
+ * A key changes state after KEY_DB_SAMPLES samples in a row differ from its debounced state. The edges are in
+ * db->pressed and db->released. A sample that KeyGhosting() flags is ignored, so no edges are reported and the
+ * counters hold until the ambiguous keys are released.
+ * */
+INT16U KeyDebounce(KEY_DB_T *db, INT16U raw);
+
+/* KeyGhosting - takes a matrix sample, returns 1 if it could hold a ghost key. Without diodes three keys on the
+ * corners of a rectangle also pull the fourth corner, so any two rows that share a column while together using
+ * more than one column can not be resolved.
+ * */
+INT8U KeyGhosting(INT16U raw);
+
+#endif
@@ -0,0 +1,95 @@
+/* KeyQueue.c
+ * A fixed size single producer, single consumer queue of key events. The producer owns head and the
+ * statistics, the consumer owns tail, so neither side masks interrupts. The event is copied before head is
+ * moved and read before tail is moved with a barrier in between, the same scheme as RingBuf. The indexes are
+ * 8-bit and run freely so head - tail is the count.
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "KeyQueue.h"
+
+/*Orders the event copy and the index update. Can be defined on the command line for a host build*/
+#ifndef KQ_BARRIER
+#define KQ_BARRIER() __DMB()
+#endif
+
+/* KeyQueueInit - takes a queue, returns nothing.
+ * */
+void KeyQueueInit(KEY_QUEUE_T *q){
+    q->head = 0;
+    q->tail = 0;
+    q->pushed = 0;
+    q->overflows = 0;
+    q->max_depth = 0;
+}
+
+/* KeyQueuePush - takes a queue and an event, returns 1 if it was queued or 0 if the queue was full.
+ * */
+INT8U KeyQueuePush(KEY_QUEUE_T *q, const KEY_EVENT_T *event){
+    INT8U added;
+    INT8U head = q->head;
+    INT8U depth;
+    depth = (INT8U)(head - q->tail);
+    if(depth < KEY_QUEUE_LEN){
+        q->events[head & (KEY_QUEUE_LEN - 1U)] = *event;
+        KQ_BARRIER();
+        q->head = (INT8U)(head + 1U);
+        q->pushed++;
+        depth++;
+        if(depth > q->max_depth){
+            q->max_depth = depth;
+        }
+        else{}
+        added = 1;
+    }
+    else{
+        q->overflows++;
+        added = 0;
+    }
+    return added;
+}
+
+/* KeyQueuePeek - takes a queue and a pointer for the event, returns 1 if an event was copied.
+ * */
+INT8U KeyQueuePeek(const KEY_QUEUE_T *q, KEY_EVENT_T *event){
+    INT8U found;
+    INT8U tail = q->tail;
+    if(q->head != tail){
+        KQ_BARRIER();
+        *event = q->events[tail & (KEY_QUEUE_LEN - 1U)];
+        found = 1;
+    }
+    else{
+        found = 0;
+    }
+    return found;
+}
+
+/* KeyQueuePop - takes a queue and a pointer for the event or 0, returns 1 if an event was removed.
+ * */
+INT8U KeyQueuePop(KEY_QUEUE_T *q, KEY_EVENT_T *event){
+    INT8U found;
+    INT8U tail = q->tail;
+    if(q->head != tail){
+        KQ_BARRIER();
+        if(event != 0){
+            *event = q->events[tail & (KEY_QUEUE_LEN - 1U)];
+        }
+        else{}
+        KQ_BARRIER();
+        q->tail = (INT8U)(tail + 1U);
+        found = 1;
+    }
+    else{
+        found = 0;
+    }
+    return found;
+}
+
+/* KeyQueueCount - takes a queue, returns the number of events waiting.
+ * */
+INT8U KeyQueueCount(const KEY_QUEUE_T *q){
+    return (INT8U)(q->head - q->tail);
+}
@@ -0,0 +1,56 @@
+/* KeyQueue.h - Header file for KeyQueue.c - a fixed size queue of timestamped key events.
+ * One context pushes and one context peeks and pops, so the keypad can be read from an ISR or a task while the
+ * application reads events from another task. The functions only work on the queue passed to them so they can
+ * be run on the host.
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef KEY_QUEUE_INC
+#define KEY_QUEUE_INC
+
+/*Defined constants*/
+#define KEY_QUEUE_LEN   16U                     /*events, must be a power of 2 and at most 128*/
+
+typedef enum{KEY_DOWN, KEY_UP}KEY_EVENT_TYPE;
+
+/*One key event. ms is the millisecond count when the press or release was verified*/
+typedef struct{
+    INT32U ms;
+    INT8C code;
+    KEY_EVENT_TYPE type;
+}KEY_EVENT_T;
+
+/*Event queue. Each field is only written by the side named in its comment*/
+typedef struct{
+    KEY_EVENT_T events[KEY_QUEUE_LEN];
+    volatile INT8U head;                        /*next slot to write, producer only*/
+    volatile INT8U tail;                        /*next event to read, consumer only*/
+    volatile INT32U pushed;                     /*events queued, producer only*/
+    volatile INT32U overflows;                  /*events dropped because the queue was full, producer only*/
+    volatile INT8U max_depth;                   /*most events waiting at one time, producer only*/
+}KEY_QUEUE_T;
+
+/* KeyQueueInit - takes a queue, returns nothing. Empties it and clears the statistics.
+ * */
+void KeyQueueInit(KEY_QUEUE_T *q);
+
+/* KeyQueuePush - producer. Takes a queue and an event, returns 1 if it was queued or 0 if the queue was full.
+ * The newest event is dropped when the queue is full so the order of the queued events is kept.
+ * */
+INT8U KeyQueuePush(KEY_QUEUE_T *q, const KEY_EVENT_T *event);
+
+/* KeyQueuePeek - consumer. Takes a queue and a pointer for the event, returns 1 and copies the oldest event
+ * without removing it, or returns 0 if the queue is empty.
+ * */
+INT8U KeyQueuePeek(const KEY_QUEUE_T *q, KEY_EVENT_T *event);
+
+/* KeyQueuePop - consumer. Same as KeyQueuePeek() but removes the event. event can be 0 to discard it.
+ * */
+INT8U KeyQueuePop(KEY_QUEUE_T *q, KEY_EVENT_T *event);
+
+/* KeyQueueCount - takes a queue, returns the number of events waiting.
+ * */
+INT8U KeyQueueCount(const KEY_QUEUE_T *q);
+
+#endif
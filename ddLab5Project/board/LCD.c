@@ -10,11 +10,20 @@
 * Fixed LcdDispDecWord, Todd Morton, 12/13/2017
 * Modified for MCUXpresso, Todd Morton, 10/29/2018
 * Modified for MCUXpresso v11.2, added new LcdDispDecWord(), Todd Morton, 10/31/2020
+* Shadow framebuffer and LcdTask(), Dominic Danis
+*   The public functions only write a 2x16 shadow of the display and move a shadow cursor,
+*   so they return in microseconds. LcdTask() sends the cells that differ from what the
+*   LCD holds. It never waits for the 40us execution time of the last byte, which is timed
+*   with the SysTick cycle stamp. If it has not passed LcdTask() returns and sends the byte
+*   on the next call, so one byte goes out per slice. LcdDispInit() still blocks.
+*   All pin writes, the pin setup, the delays and the cycle counter go through macros that a
+*   host build can define to run this file unmodified against an emulated controller.
 ******************************************************************************************
 * Master Include File  
 *****************************************************************************************/
 #include "MCUType.h"
 #include "LCD.h"
+#include "SysTickDelay.h"
 
 /*****************************************************************************************
 * LCD Port Defines 
@@ -22,13 +31,43 @@
 #define LCD_RS_BIT     0x2U
 #define LCD_E_BIT      0x4U
 #define LCD_DB_MASK    0x78U
-#define LCD_PORT       GPIOD->PDOR
-#define LCD_PORT_DIR   GPIOD->PDDR
+#ifndef LCD_GPIO
+#define LCD_GPIO       GPIOD  /* Can be defined on the command line to use a mock port */
+#endif
+#define LCD_PORT_DIR   LCD_GPIO->PDDR
 #define INIT_BIT_DIR() (LCD_PORT_DIR |= (LCD_RS_BIT|LCD_E_BIT|LCD_DB_MASK))
-#define LCD_SET_RS()   GPIOD->PSOR = LCD_RS_BIT
-#define LCD_CLR_RS()   GPIOD->PCOR = LCD_RS_BIT
-#define LCD_SET_E()    GPIOD->PSOR = LCD_E_BIT
-#define LCD_CLR_E()    GPIOD->PCOR = LCD_E_BIT
+
+/* Pin access. Can be defined on the command line so an emulator sees every pin write */
+#ifndef LCD_PORT_WR
+#define LCD_PORT_WR(v)   (LCD_GPIO->PDOR = (v))
+#define LCD_PORT_RD()    (LCD_GPIO->PDOR)
+#define LCD_PORT_SET(b)  (LCD_GPIO->PSOR = (b))
+#define LCD_PORT_CLR(b)  (LCD_GPIO->PCOR = (b))
+#endif
+
+/* Pin mux, clock gate and port direction setup */
+#ifndef LCD_HW_INIT
+#define LCD_HW_INIT()  lcdHwInit()
+#endif
+
+#define LCD_SET_RS()   LCD_PORT_SET(LCD_RS_BIT)
+#define LCD_CLR_RS()   LCD_PORT_CLR(LCD_RS_BIT)
+#define LCD_SET_E()    LCD_PORT_SET(LCD_E_BIT)
+#define LCD_CLR_E()    LCD_PORT_CLR(LCD_E_BIT)
+
+/* Delay in ns. Can be defined on the command line to advance an emulator clock instead */
+#ifdef LCD_DLY_NS
+#define LCD_DLY_500NS() LCD_DLY_NS(500U)
+#else
+#define LCD_DLY_500NS() lcdDly500nsLoop()
+#endif
+
+/* Cycle counter used to pace LcdTask(). The SysTick stamp keeps counting while the core
+ * sleeps in SysTickWaitEvent(), the DWT cycle counter does not. Can be defined on the
+ * command line to use a fake clock */
+#ifndef LCD_CYCLES
+#define LCD_CYCLES()   SysTickGetCycleStamp()
+#endif
 
 /*****************************************************************************************
 * LCD Defines
@@ -44,6 +83,13 @@
 #define LCD_BS_CMD     0x10   /* Move cursor left one space */
 #define LCD_FS_CMD     0x14   /* Move cursor right one space */
 
+#define NUM_ROWS       2
+#define NUM_COLS_ADDR  40     /* DDRAM addresses per line, cursor wraps after this */
+#ifndef LCD_EXEC_CYCLES
+#define LCD_EXEC_CYCLES ((SystemCoreClock/1000000U)*40U) /* 40us of LCD_CYCLES() */
+#endif
+#define LCD_ADDR_NONE  0xFFU  /* LCD address is not known */
+
 /*****************************************************************************************
 * Private Function prototypes
 *****************************************************************************************/
@@ -53,6 +99,24 @@ static void lcdDly40us(void);
 static void lcdDlyms(const INT8U ms);
 static void lcdWrNib(INT8U nib);
 static INT8C lcdHtoA(INT8U hnib);
+static void lcdWrByte(const INT8U byte);
+static INT8U lcdReady(void);
+static INT8U lcdFlushNext(void);
+static void lcdShadowFill(const INT8U row);
+static void lcdHwInit(void);
+static void lcdDly500nsLoop(void);
+
+/*****************************************************************************************
+* Private Variables
+*****************************************************************************************/
+static INT8C lcdShadow[NUM_ROWS][NUM_CHARS];    /* What should be displayed */
+static INT8C lcdShown[NUM_ROWS][NUM_CHARS];     /* What the LCD holds */
+static INT8U lcdCurRow = 0;                     /* Shadow cursor, 0 based */
+static INT8U lcdCurCol = 0;
+static INT8U lcdCurCmd = LCD_DIS_INIT;          /* Cursor mode command wanted */
+static INT8U lcdCurCmdShown = LCD_DIS_INIT;
+static INT8U lcdHwAddr = LCD_ADDR_NONE;         /* LCD DDRAM address counter */
+static INT32U lcdLastByte = 0;                  /* LCD_CYCLES() when the last byte was sent */
 
 /*****************************************************************************************
 * Function Definitions
@@ -64,6 +128,7 @@ static INT8C lcdHtoA(INT8U hnib);
 static void lcdWrCmd(const INT8U cmd) {
       LCD_CLR_RS();                 //Select command
       lcdWrNib(cmd>>4);             //Out most sig nibble
+      lcdDly500ns();                //RS setup, 40ns min
       LCD_SET_E();                  //Pulse E. 230ns min per Seiko doc
       lcdDly500ns();
       LCD_CLR_E();
@@ -77,6 +142,36 @@ static void lcdWrCmd(const INT8U cmd) {
       LCD_SET_RS();                 //Set back to data
 }
 
+/*****************************************************************************************
+* lcdWrByte(INT8U byte) - Private
+*  PARAMETERS: byte - byte to be sent with the current RS
+*  DESCRIPTION: Sends both nibbles of a byte. The last byte must have had LCD_EXEC_CYCLES
+*               to execute, see lcdReady(). Does not wait for this byte, the time is saved
+*               in lcdLastByte.
+*****************************************************************************************/
+static void lcdWrByte(const INT8U byte){
+    lcdWrNib(byte >> 4);
+    lcdDly500ns();                                          /*RS setup, 40ns min*/
+    LCD_SET_E();
+    lcdDly500ns();
+    LCD_CLR_E();
+    lcdDly500ns();
+    lcdDly500ns();
+    lcdWrNib(byte & 0x0fu);
+    LCD_SET_E();
+    lcdDly500ns();
+    LCD_CLR_E();
+    lcdLastByte = LCD_CYCLES();
+}
+
+/*****************************************************************************************
+* lcdReady() - Private
+*  RETURNS: 1 if the last byte sent by lcdWrByte() has had LCD_EXEC_CYCLES to execute
+*****************************************************************************************/
+static INT8U lcdReady(void){
+    return (INT8U)((LCD_CYCLES() - lcdLastByte) >= LCD_EXEC_CYCLES);
+}
+
 /*****************************************************************************************
 * lcdWrNib(INT8U nib) - Private
 *  PARAMETERS: nib - 4-bit nibble (upper four bits zero) sent to the LCD
@@ -84,7 +179,7 @@ static void lcdWrCmd(const INT8U cmd) {
 *****************************************************************************************/
 static void lcdWrNib(INT8U nib){
     INT8U lnib = nib & 0x0fu;
-    GPIOD->PDOR = (GPIOD->PDOR & (INT32U)~LCD_DB_MASK)|((INT32U)lnib << 3);
+    LCD_PORT_WR((LCD_PORT_RD() & (INT32U)~LCD_DB_MASK)|((INT32U)lnib << 3));
 }
 
 /*****************************************************************************************
@@ -94,20 +189,14 @@ static void lcdWrNib(INT8U nib){
 *               Data sheet. In this case, 4-bit mode.
 *****************************************************************************************/
 void LcdDispInit(void) {
-    SIM->SCGC5 |= SIM_SCGC5_PORTD(1);
-	PORTD->PCR[1] = PORT_PCR_MUX(1);
-	PORTD->PCR[2] = PORT_PCR_MUX(1);
-	PORTD->PCR[3] = PORT_PCR_MUX(1);
-	PORTD->PCR[4] = PORT_PCR_MUX(1);
-	PORTD->PCR[5] = PORT_PCR_MUX(1);
-	PORTD->PCR[6] = PORT_PCR_MUX(1);
-	INIT_BIT_DIR();
+    LCD_HW_INIT();
     LCD_CLR_E(); 
     LCD_SET_RS();               /*Data select unless in lcdWrCmd()  */
     lcdDlyms(15);               /* LCD requires 15ms delay at powerup */
    
     LCD_CLR_RS();               /*Send first command for RESET sequence*/
     lcdWrNib(0x3u);
+    lcdDly500ns();              /*RS setup, 40ns min*/
     LCD_SET_E();
     lcdDly500ns();
     LCD_CLR_E();
@@ -134,8 +223,118 @@ void LcdDispInit(void) {
     lcdWrCmd(LCD_DAT_INIT);     /*Send command for 4-bit mode */
     lcdWrCmd(LCD_SHIFT_CUR);
     lcdWrCmd(LCD_DIS_INIT);
-    LcdDispClear();
-} 
+    lcdWrCmd(LCD_CLR_CMD);
+    lcdDlyms(2);
+    lcdShadowFill(0);           /*Shadow matches the cleared LCD */
+    lcdShadowFill(1);
+    for(lcdCurRow = 0; lcdCurRow < NUM_ROWS; lcdCurRow++){
+        for(lcdCurCol = 0; lcdCurCol < NUM_CHARS; lcdCurCol++){
+            lcdShown[lcdCurRow][lcdCurCol] = ' ';
+        }
+    }
+    lcdCurRow = 0;
+    lcdCurCol = 0;
+    lcdCurCmd = LCD_DIS_INIT;
+    lcdCurCmdShown = LCD_DIS_INIT;
+    lcdHwAddr = 0;
+    lcdLastByte = LCD_CYCLES();
+}
+
+/*****************************************************************************************
+* lcdHwInit() - Private
+*  DESCRIPTION: Sets the LCD pins to GPIO outputs
+*****************************************************************************************/
+static void lcdHwInit(void){
+    SIM->SCGC5 |= SIM_SCGC5_PORTD(1);
+	PORTD->PCR[1] = PORT_PCR_MUX(1);
+	PORTD->PCR[2] = PORT_PCR_MUX(1);
+	PORTD->PCR[3] = PORT_PCR_MUX(1);
+	PORTD->PCR[4] = PORT_PCR_MUX(1);
+	PORTD->PCR[5] = PORT_PCR_MUX(1);
+	PORTD->PCR[6] = PORT_PCR_MUX(1);
+	INIT_BIT_DIR();
+}
+
+/*****************************************************************************************
+** LcdTask() - Public
+*  PARAMETERS: None
+*  DESCRIPTION: Sends the next byte needed to bring the LCD up to date with the shadow if
+*               the last one has had 40us to execute, otherwise returns at once and the
+*               byte is sent by a later call. Meant to be called every slice from the
+*               scheduler.
+*****************************************************************************************/
+void LcdTask(void){
+    if(lcdReady() != 0){
+        (void)lcdFlushNext();
+    }else{
+    }
+}
+
+/*****************************************************************************************
+* lcdFlushNext() - Private
+*  DESCRIPTION: Sends the next byte needed to update the LCD. In order: a cursor mode change,
+*               an address set or the data for the first cell that differs, then moving the
+*               LCD cursor to the shadow cursor if the cursor is on.
+*  RETURNS: 1 if a byte was sent, 0 if the LCD is up to date
+*****************************************************************************************/
+static INT8U lcdFlushNext(void){
+    INT8U row;
+    INT8U col;
+    INT8U addr;
+    INT8U sent = 1;
+    if(lcdCurCmd != lcdCurCmdShown){
+        LCD_CLR_RS();
+        lcdWrByte(lcdCurCmd);
+        LCD_SET_RS();
+        lcdCurCmdShown = lcdCurCmd;
+    }else{
+        row = 0;
+        col = 0;
+        while((row < NUM_ROWS) && (lcdShadow[row][col] == lcdShown[row][col])){
+            col++;
+            if(col >= NUM_CHARS){
+                col = 0;
+                row++;
+            }else{
+            }
+        }
+        if(row < NUM_ROWS){                                 /*Found a dirty cell*/
+            addr = (INT8U)((row * 0x40U) + col);
+            if(lcdHwAddr != addr){
+                LCD_CLR_RS();
+                lcdWrByte((INT8U)(LCD_LINE1_ADDR | addr));
+                LCD_SET_RS();
+                lcdHwAddr = addr;
+            }else{
+                lcdWrByte((INT8U)lcdShadow[row][col]);
+                lcdShown[row][col] = lcdShadow[row][col];
+                lcdHwAddr++;
+            }
+        }else{
+            addr = (INT8U)((lcdCurRow * 0x40U) + lcdCurCol);
+            if((lcdCurCmd != LCD_DIS_INIT) && (lcdHwAddr != addr)){ /*Cursor visible*/
+                LCD_CLR_RS();
+                lcdWrByte((INT8U)(LCD_LINE1_ADDR | addr));
+                LCD_SET_RS();
+                lcdHwAddr = addr;
+            }else{
+                sent = 0;
+            }
+        }
+    }
+    return sent;
+}
+
+/*****************************************************************************************
+* lcdShadowFill() - Private
+*  PARAMETERS: row - 0 based row to fill with spaces
+*****************************************************************************************/
+static void lcdShadowFill(const INT8U row){
+    INT8U i;
+    for(i = 0; i < NUM_CHARS; i++){
+        lcdShadow[row][i] = ' ';
+    }
+}
 
 /*****************************************************************************************
 ** LcdDispChar() - Public
@@ -146,17 +345,16 @@ void LcdDispInit(void) {
 *               configured for a data write.
 *****************************************************************************************/
 void LcdDispChar(const INT8C c) {
-    lcdWrNib(((INT8U)c >> 4));
-    LCD_SET_E();
-    lcdDly500ns();
-    LCD_CLR_E();
-    lcdDly500ns();
-    lcdDly500ns();
-    lcdWrNib(((INT8U)c & 0x0fu));
-    LCD_SET_E();
-    lcdDly500ns();
-    LCD_CLR_E();
-    lcdDly40us();
+    if(lcdCurCol < NUM_CHARS){      /*Past column 16 is off screen*/
+        lcdShadow[lcdCurRow][lcdCurCol] = c;
+    }else{
+    }
+    lcdCurCol++;
+    if(lcdCurCol >= NUM_COLS_ADDR){ /*LCD address wraps to the other line*/
+        lcdCurCol = 0;
+        lcdCurRow ^= 1U;
+    }else{
+    }
 }
 
 /*****************************************************************************************
@@ -165,9 +363,10 @@ void LcdDispChar(const INT8C c) {
 *  DESCRIPTION: Clears the LCD display and returns the cursor to row1, col1.
 *****************************************************************************************/
 void LcdDispClear(void) {
-
-    lcdWrCmd(LCD_CLR_CMD);
-    lcdDlyms(2);
+    lcdShadowFill(0);
+    lcdShadowFill(1);
+    lcdCurRow = 0;
+    lcdCurCol = 0;
 }
 
 /*****************************************************************************************
@@ -177,24 +376,10 @@ void LcdDispClear(void) {
 *               column 1 of that line.
 *****************************************************************************************/
 void LcdDispLineClear(const INT8U line) {
-  
-   INT8U start_addr; 
-   INT8U i;
-
-   if(line == 1){ 
-      start_addr = LCD_LINE1_ADDR;  
-      lcdWrCmd(start_addr);
-      for(i = 0x0; i < (NUM_CHARS); i++) {
-         LcdDispChar(' ');
-      }
-      lcdWrCmd(start_addr);
-   }else if(line == 2){ 
-      start_addr = LCD_LINE2_ADDR;
-      lcdWrCmd(start_addr);
-      for(i = 0x0; i < (NUM_CHARS); i++) {
-         LcdDispChar(' ');
-      }
-      lcdWrCmd(start_addr);
+   if((line == 1) || (line == 2)){
+      lcdShadowFill(line - 1);
+      lcdCurRow = line - 1;
+      lcdCurCol = 0;
    }else{
       /* Input error, do nothing */
    }
@@ -332,9 +517,14 @@ void LcdDispDecWord(INT32U binword, INT8U field, LCD_MODE mode){
 void LcdCursorMove(const INT8U row, const INT8U col) {
 
     if(row == 1) {
-        lcdWrCmd((INT8U)(LCD_LINE1_ADDR + col - 1));
+        lcdCurRow = 0;
+    }else{
+        lcdCurRow = 1;
+    }
+    lcdCurCol = (INT8U)(col - 1);
+    if(lcdCurCol >= NUM_COLS_ADDR){
+        lcdCurCol = 0;
     }else{
-        lcdWrCmd((INT8U)(LCD_LINE2_ADDR + col - 1));
     }
 }
 
@@ -359,7 +549,7 @@ void LcdCursorMode(const INT8U on, const INT8U blink) {
     }else{
                             //Cursor no blink
     }
-    lcdWrCmd(curcmd);
+    lcdCurCmd = curcmd;
 }
 
 /*****************************************************************************************
@@ -372,6 +562,14 @@ void LcdCursorMode(const INT8U on, const INT8U blink) {
  * TDM 11/03/2015
 *****************************************************************************************/
 static void lcdDly500ns(void){
+    LCD_DLY_500NS();
+}
+
+/*****************************************************************************************
+** lcdDly500nsLoop(void)
+*   The target delay loop used by lcdDly500ns()
+*****************************************************************************************/
+static void lcdDly500nsLoop(void){
 	INT32U i;
 	for(i=0;i<12;i++){
 	}
@@ -406,7 +604,12 @@ static void lcdDlyms(const INT8U ms){
 *   Moves cursor back one space.
 *****************************************************************************************/
 void LcdBSpace(void) {
-    lcdWrCmd(LCD_BS_CMD);
+    if(lcdCurCol == 0){
+        lcdCurCol = NUM_COLS_ADDR - 1;
+        lcdCurRow ^= 1U;
+    }else{
+        lcdCurCol--;
+    }
 }
 
 /*****************************************************************************************
@@ -414,7 +617,12 @@ void LcdBSpace(void) {
 *   Moves cursor right one space.
 *****************************************************************************************/
 void LcdFSpace(void) {
-    lcdWrCmd(LCD_FS_CMD);
+    lcdCurCol++;
+    if(lcdCurCol >= NUM_COLS_ADDR){
+        lcdCurCol = 0;
+        lcdCurRow ^= 1U;
+    }else{
+    }
 }
 /*******************************************************************************************
 * lcdHtoA() - Converts a hex nibble to ASCII - private
@@ -9,6 +9,9 @@
 * Fixed LcdDispDecWord, Todd Morton, 12/13/2017
 * Modified for MCUXpresso, Todd Morton, 10/29/2018
 * Modified for MCUXpresso v11.2, added new LcdDispDecWord(), Todd Morton, 10/31/2020
+* Shadow framebuffer and LcdTask(), Dominic Danis
+*   Display functions write a shadow of the display and return right away. LcdTask() must
+*   be called periodically to send the changes to the LCD.
 *****************************************************************************************/
 #ifndef LCD_INC
 #define LCD_INC
@@ -51,10 +54,20 @@ typedef enum {
 * WWULCD Function prototypes
 *****************************************************************************************/
 /*****************************************************************************************
-* LcdDispInit() Initializes display. Takes ~24ms to run
+* LcdDispInit() Initializes display. Takes ~24ms to run. SysTickDlyInit() must be called
+*               first, LcdTask() is paced with SysTickGetCycleStamp().
 *****************************************************************************************/
 void LcdDispInit(void);
 
+/*****************************************************************************************
+** LcdTask
+*  PARAMETERS: None
+*  DESCRIPTION: Sends one changed cell or command to the LCD if the last one has finished
+*               executing, never waits. Meant to be run every slice from the scheduler.
+*               Takes less than ~10us.
+*****************************************************************************************/
+void LcdTask(void);
+
 /*****************************************************************************************
 ** LcdDispClear
 *  PARAMETERS: None
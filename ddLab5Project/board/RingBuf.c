@@ -0,0 +1,117 @@
+/* RingBuf.c
+ * Lock free single producer, single consumer byte ring buffers. The producer owns head and the consumer owns
+ * tail, so as long as only one context writes and one context reads neither side has to mask interrupts.
+ * The data is copied before head is moved and read before tail is moved, with a barrier in between so the
+ * other side never sees an index ahead of the data. The indexes are 16-bit and run freely, head - tail is the
+ * count even after they wrap.
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "RingBuf.h"
+
+/*Orders the data access before the index update. Can be defined on the command line for a host build*/
+#ifndef RB_BARRIER
+#define RB_BARRIER() __DMB()
+#endif
+
+/* RingBufInit - takes a ring buffer, its storage and the storage size, returns nothing.
+ * */
+void RingBufInit(RING_BUF_T *rb, INT8U *storage, INT16U size){
+    rb->buf = storage;
+    rb->size = size;
+    rb->head = 0;
+    rb->tail = 0;
+    rb->dropped = 0;
+}
+
+/* RingBufPut - takes a ring buffer and a byte, returns 1 if the byte was added or 0 if the buffer was full.
+ * */
+INT8U RingBufPut(RING_BUF_T *rb, INT8U byte){
+    INT8U added;
+    INT16U head = rb->head;
+    if((INT16U)(head - rb->tail) < rb->size){
+        rb->buf[head & (rb->size - 1U)] = byte;
+        RB_BARRIER();
+        rb->head = (INT16U)(head + 1U);
+        added = 1;
+    }
+    else{
+        rb->dropped++;
+        added = 0;
+    }
+    return added;
+}
+
+/* RingBufWrite - takes a ring buffer, a pointer to the data and its length, returns the number of bytes added.
+ * The space is read once so the whole copy is published with one head update.
+ * */
+INT16U RingBufWrite(RING_BUF_T *rb, const INT8U *data, INT16U len){
+    INT16U head = rb->head;
+    INT16U space;
+    INT16U i;
+    space = (INT16U)(rb->size - (INT16U)(head - rb->tail));
+    if(len > space){
+        rb->dropped += (INT32U)(len - space);
+        len = space;
+    }
+    else{}
+    for(i=0;i<len;i++){
+        rb->buf[(INT16U)(head + i) & (rb->size - 1U)] = data[i];
+    }
+    RB_BARRIER();
+    rb->head = (INT16U)(head + len);
+    return len;
+}
+
+/* RingBufGet - takes a ring buffer and a pointer for the byte, returns 1 if a byte was removed or 0 if empty.
+ * */
+INT8U RingBufGet(RING_BUF_T *rb, INT8U *byte){
+    INT8U removed;
+    INT16U tail = rb->tail;
+    if(rb->head != tail){
+        RB_BARRIER();
+        *byte = rb->buf[tail & (rb->size - 1U)];
+        RB_BARRIER();
+        rb->tail = (INT16U)(tail + 1U);
+        removed = 1;
+    }
+    else{
+        removed = 0;
+    }
+    return removed;
+}
+
+/* RingBufRead - takes a ring buffer, a pointer to the destination and its length, returns the number of bytes
+ * removed.
+ * */
+INT16U RingBufRead(RING_BUF_T *rb, INT8U *data, INT16U len){
+    INT16U tail = rb->tail;
+    INT16U count;
+    INT16U i;
+    count = (INT16U)(rb->head - tail);
+    if(len > count){
+        len = count;
+    }
+    else{}
+    RB_BARRIER();
+    for(i=0;i<len;i++){
+        data[i] = rb->buf[(INT16U)(tail + i) & (rb->size - 1U)];
+    }
+    RB_BARRIER();
+    rb->tail = (INT16U)(tail + len);
+    return len;
+}
+
+/* RingBufCount - takes a ring buffer, returns the number of bytes in it.
+ * */
+INT16U RingBufCount(const RING_BUF_T *rb){
+    return (INT16U)(rb->head - rb->tail);
+}
+
+/* RingBufSpace - takes a ring buffer, returns the number of free bytes.
+ * */
+INT16U RingBufSpace(const RING_BUF_T *rb){
+    return (INT16U)(rb->size - (INT16U)(rb->head - rb->tail));
+}
@@ -0,0 +1,55 @@
+/* RingBuf.h - Header file for RingBuf.c - lock free single producer, single consumer byte ring buffers.
+ * One context (task or ISR) may write and one other context may read at the same time without masking
+ * interrupts. The functions only work on the structure passed to them so they can be run on the host.
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef RING_BUF_INC
+#define RING_BUF_INC
+
+/*Ring buffer. head is only written by the producer and tail only by the consumer. Both run freely and are
+ * masked with size-1 so all size bytes can be used. size must be a power of 2 and at most 32768*/
+typedef struct{
+    INT8U *buf;
+    INT16U size;
+    volatile INT16U head;                       /*next byte to write*/
+    volatile INT16U tail;                       /*next byte to read*/
+    volatile INT32U dropped;                    /*bytes the producer could not fit, only written by the producer*/
+}RING_BUF_T;
+
+/* RingBufInit - takes a ring buffer, its storage and the storage size, returns nothing. Empties the buffer.
+ * Must be called before either side uses it.
+ * */
+void RingBufInit(RING_BUF_T *rb, INT8U *storage, INT16U size);
+
+/* RingBufPut - producer. Takes a ring buffer and a byte, returns 1 if the byte was added or 0 if the buffer was
+ * full. A byte that does not fit is counted in dropped.
+ * */
+INT8U RingBufPut(RING_BUF_T *rb, INT8U byte);
+
+/* RingBufWrite - producer. Takes a ring buffer, a pointer to the data and its length, returns the number of
+ * bytes added. Bytes that do not fit are counted in dropped.
+ * */
+INT16U RingBufWrite(RING_BUF_T *rb, const INT8U *data, INT16U len);
+
+/* RingBufGet - consumer. Takes a ring buffer and a pointer for the byte, returns 1 if a byte was removed or 0
+ * if the buffer was empty.
+ * */
+INT8U RingBufGet(RING_BUF_T *rb, INT8U *byte);
+
+/* RingBufRead - consumer. Takes a ring buffer, a pointer to the destination and its length, returns the number
+ * of bytes removed.
+ * */
+INT16U RingBufRead(RING_BUF_T *rb, INT8U *data, INT16U len);
+
+/* RingBufCount - takes a ring buffer, returns the number of bytes in it. Exact for either side, a snapshot for
+ * anyone else.
+ * */
+INT16U RingBufCount(const RING_BUF_T *rb);
+
+/* RingBufSpace - takes a ring buffer, returns the number of free bytes.
+ * */
+INT16U RingBufSpace(const RING_BUF_T *rb);
+
+#endif
@@ -0,0 +1,66 @@
+/* TSIFilter.c
+ * Adaptive baseline tracking for the TSI pads. Each channel has a fixed-point IIR filter on the raw count and
+ * a much slower IIR baseline that follows the filtered count while the pad is not touched, so temperature and
+ * humidity drift do not cause false touches or dead pads. Touch and release use separate thresholds above the
+ * baseline and a number of samples in a row before the state changes.
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "TSIFilter.h"
+
+/* TSIFiltInit - takes a pointer to a channel state and an untouched count, returns nothing.
+ * */
+void TSIFiltInit(TSI_FILT_T *ch, INT16U count){
+    ch->raw = count;
+    ch->filtered = (INT32U)count << TSI_FILT_FRAC;
+    ch->baseline = ch->filtered;
+    ch->touched = 0;
+    ch->debounce = 0;
+}
+
+/* TSIFiltUpdate - takes a pointer to a channel state, a pointer to its configuration and a new count.
+ * Returns 1 if the channel is touched and 0 if it is released.
+ * */
+INT8U TSIFiltUpdate(TSI_FILT_T *ch, const TSI_FILT_CFG_T *cfg, INT16U count){
+    INT32U touch_level;
+    INT32U release_level;
+    ch->raw = count;
+    ch->filtered = (INT32U)((INT32S)ch->filtered +
+                   ((((INT32S)count << TSI_FILT_FRAC) - (INT32S)ch->filtered) >> TSI_FILT_SHIFT));
+    touch_level = ch->baseline + ((INT32U)cfg->touch_offset << TSI_FILT_FRAC);
+    release_level = ch->baseline + ((INT32U)cfg->release_offset << TSI_FILT_FRAC);
+    if(ch->touched == 0){
+        if(ch->filtered > touch_level){
+            ch->debounce++;
+            if(ch->debounce >= cfg->touch_cnt){
+                ch->touched = 1;
+                ch->debounce = 0;
+            }
+            else{}
+        }
+        else{
+            ch->debounce = 0;
+            if(ch->filtered < release_level){                                   /*only track a quiet pad*/
+                ch->baseline = (INT32U)((INT32S)ch->baseline +
+                               (((INT32S)ch->filtered - (INT32S)ch->baseline) >> TSI_BASE_SHIFT));
+            }
+            else{}
+        }
+    }
+    else{
+        if(ch->filtered < release_level){
+            ch->debounce++;
+            if(ch->debounce >= cfg->release_cnt){
+                ch->touched = 0;
+                ch->debounce = 0;
+            }
+            else{}
+        }
+        else{
+            ch->debounce = 0;
+        }
+    }
+    return ch->touched;
+}
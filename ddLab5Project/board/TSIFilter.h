@@ -0,0 +1,45 @@
+/* TSIFilter.h - Header file for TSIFilter.c - adaptive baseline tracking and touch detection for one TSI channel.
+ * The functions only work on the structures passed to them so they can be run on recorded sample traces.
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef TSI_FILTER_INC
+#define TSI_FILTER_INC
+
+/*Defined constants*/
+#define TSI_FILT_FRAC   4U                      /*fraction bits of filtered and baseline*/
+#define TSI_FILT_SHIFT  2U                      /*count filter, new = old + (in - old)/4*/
+#define TSI_BASE_SHIFT  8U                      /*baseline filter, new = old + (filt - old)/256*/
+
+/*Touch and release thresholds are offsets above the baseline in counts. release_offset should be less than
+ * touch_offset for hysteresis. A state change needs touch_cnt or release_cnt samples in a row past the threshold*/
+typedef struct{
+    INT16U touch_offset;
+    INT16U release_offset;
+    INT8U touch_cnt;
+    INT8U release_cnt;
+}TSI_FILT_CFG_T;
+
+/*State of one channel. filtered and baseline have TSI_FILT_FRAC fraction bits*/
+typedef struct{
+    INT16U raw;
+    INT32U filtered;
+    INT32U baseline;
+    INT8U touched;
+    INT8U debounce;
+}TSI_FILT_T;
+
+/* TSIFiltInit - takes a pointer to a channel state and an untouched count, returns nothing. Sets the filter
+ * and the baseline to count and the channel to released.
+ * */
+void TSIFiltInit(TSI_FILT_T *ch, INT16U count);
+
+/* TSIFiltUpdate - takes a pointer to a channel state, a pointer to its configuration and a new count.
+ * Filters the count, moves the baseline towards the filtered count only while the channel is released and
+ * below the release threshold, then runs the debounced touch/release decision.
+ * Returns 1 if the channel is touched and 0 if it is released.
+ * */
+INT8U TSIFiltUpdate(TSI_FILT_T *ch, const TSI_FILT_CFG_T *cfg, INT16U count);
+
+#endif
@@ -9,6 +9,20 @@
 * 10/23/2018 Todd Morton
 * v4.1 Modified for MCUX11.2
 * 10/21/2020 Todd Morton
+* v5.1 Absolute deadlines for SysTickWaitEvent(), overrun and jitter statistics
+* Dominic Danis
+* v5.2 Sleep with WFI while waiting for the slice and account idle time for CPU load
+* Dominic Danis
+* v5.3 Add SysTickSetTickHook() to run a short function every 1ms tick
+* Dominic Danis
+* v5.4 Mask interrupts between the deadline check and WFI, lost wakeup
+* Dominic Danis
+* v5.5 SysTickDlyInit() clears the jitter histogram windows
+* Dominic Danis
+* v5.6 Export the cycle stamp as SysTickGetCycleStamp(), it keeps counting in WFI sleep
+* Dominic Danis
+* v5.7 SysTickGetCycleStamp() counts a pending tick so it is right in a higher priority ISR
+* Dominic Danis
 ******************************************************************************************
 * Project master header file
 *****************************************************************************************/
@@ -27,12 +41,49 @@ void SysTick_Handler(void);  /* SysTick interrupt service routine*/
 static volatile INT32U stmsCount;   /* 1ms counter variable */
 static INT32U stSliceCount;   /* 1ms counter variable */
 static INT8U stInitFlag;
-static INT32U stLastEvent;
+static INT32U stNextEvent;    /* absolute deadline of the current slice */
+static INT32U stOverrunCount; /* slices that started after their deadline */
+static INT32U stOverrunms;    /* stmsCount at the most recent overrun */
+static INT32U stSkipCount;    /* whole slices dropped to catch up */
+static INT32U stJitterHist[ST_JITTER_BINS];  /* window being collected */
+static INT32U stJitterLast[ST_JITTER_BINS];  /* last complete window */
+static INT32U stJitterSlices;
+static INT32U stIdleCycles;   /* cycles spent waiting in the window being collected */
+static INT32U stWindowStart;  /* cycle stamp at the start of the window */
+static INT16U stCPULoad;      /* load of the last complete window in 0.1% */
+static void (*volatile stTickHook)(void);   /* called from SysTick_Handler(), 0 for none */
+static void stSliceStats(const INT32U late);
 
 /*****************************************************************************************
 * Module Defines
 *****************************************************************************************/
 #define CLK_PER_MS 180000U          /* Clock cycles per 1ms, (must be < 16777216)        */
+#define ST_JITTER_WINDOW 100U       /* slices per jitter histogram and CPU load window   */
+#define ST_IDLE_WFI_EN 1            /* 1 - sleep while waiting for a slice, 0 - spin     */
+
+/*****************************************************************************************
+* Tick source. Can be defined on the command line to inject a simulated tick.
+*****************************************************************************************/
+#ifndef ST_MS_COUNT
+#define ST_MS_COUNT() (stmsCount)
+#endif
+
+/*****************************************************************************************
+* Idle instruction and cycle stamp. Can be defined on the command line to stub out WFI and
+* the SysTick current value register.
+* Only sleep mode is used. Stop and VLPS stop the core clock that SysTick runs from and
+* VLPR requires leaving the 180MHz HSRUN clock, so neither can keep the 1ms tick.
+*****************************************************************************************/
+#ifndef ST_IDLE
+#if ST_IDLE_WFI_EN
+#define ST_IDLE() __WFI()
+#else
+#define ST_IDLE()
+#endif
+#endif
+#ifndef ST_CYCLES
+#define ST_CYCLES() SysTickGetCycleStamp()
+#endif
 
 /*****************************************************************************************
 * SysTickDelay Function
@@ -50,28 +101,135 @@ void SysTickDelay(const INT32U ms){
 * Period Delay Function
 *    - Public - NOT reentrant...in fact only one instance.
 *    - Wait to next event every 'period' milliseconds
+*    - Deadlines are absolute, next = last + period, so an overrun does not shift
+*      later slices.
+*    - Catch up rules when called after the deadline (an overrun):
+*        late < period  - return at once, the grid is kept and the next slice is short.
+*        late >= period - the missed slices are dropped and counted, the deadline
+*                         moves to the latest grid point, then return at once.
+*    - While waiting the core sleeps with WFI and wakes on the SysTick or any other
+*      interrupt. The deadline is checked again with interrupts masked before each WFI
+*      so a tick that lands just before it cannot make the slice a whole ms late.
+*      The time spent waiting is accounted as idle time.
 *    - Accuracy +0/-1 ms
 *****************************************************************************************/
 void SysTickWaitEvent(const INT32U period){
-    DB0_TURN_ON();
+    INT32U now;
+    INT32U idle_start;
+    INT32U primask;
     if(stInitFlag == 1){
-        while((stmsCount - stLastEvent) < period){}
+        stNextEvent += period;
+        now = ST_MS_COUNT();
+        if((INT32S)(now - stNextEvent) > 0){    /* overrun */
+            stOverrunCount++;
+            stOverrunms = now;
+            while((now - stNextEvent) >= period){
+                stNextEvent += period;
+                stSkipCount++;
+            }
+        }else{
+            idle_start = ST_CYCLES();
+            primask = __get_PRIMASK();
+            while((INT32S)(ST_MS_COUNT() - stNextEvent) < 0){
+                __disable_irq();                /* a tick between the check and WFI would be slept through */
+                if((INT32S)(ST_MS_COUNT() - stNextEvent) < 0){
+                    ST_IDLE();                  /* a pending interrupt still wakes WFI with PRIMASK set */
+                }else{
+                }
+                __set_PRIMASK(primask);         /* the pending interrupt runs here */
+            }
+            stIdleCycles += ST_CYCLES() - idle_start;
+        }
+        stSliceStats(ST_MS_COUNT() - stNextEvent);
     }else{
         stInitFlag = 1;
+        stNextEvent = ST_MS_COUNT();
+        stWindowStart = ST_CYCLES();
     }
-    stLastEvent = stmsCount;
     stSliceCount++;
-    DB0_TURN_OFF();
+}
+
+/*****************************************************************************************
+* stSliceStats() - Adds the release lateness in ms to the jitter histogram. Every
+*                  ST_JITTER_WINDOW slices the histogram is latched for
+*                  SysTickGetJitterHist() and cleared, and the CPU load of the window is
+*                  calculated from the idle cycles.
+*    - Private
+*****************************************************************************************/
+static void stSliceStats(const INT32U late){
+    INT8U bin;
+    INT32U now;
+    INT32U total;
+    if(late < (ST_JITTER_BINS - 1U)){
+        bin = (INT8U)late;
+    }else{
+        bin = ST_JITTER_BINS - 1U;
+    }
+    stJitterHist[bin]++;
+    stJitterSlices++;
+    if(stJitterSlices >= ST_JITTER_WINDOW){
+        for(bin = 0; bin < ST_JITTER_BINS; bin++){
+            stJitterLast[bin] = stJitterHist[bin];
+            stJitterHist[bin] = 0;
+        }
+        stJitterSlices = 0;
+        now = ST_CYCLES();
+        total = now - stWindowStart;
+        if((total != 0) && (stIdleCycles <= total)){
+            stCPULoad = (INT16U)(1000U - (INT32U)(((INT64U)stIdleCycles*1000U)/total));
+        }else{}
+        stIdleCycles = 0;
+        stWindowStart = now;
+    }else{}
+}
+
+/*****************************************************************************************
+* SysTickGetCycleStamp() - Returns a core clock cycle stamp built from the ms count and
+*                          the SysTick current value. SysTick keeps counting in sleep mode,
+*                          unlike the DWT cycle counter. Wraps every ~23.8s so only
+*                          differences shorter than that are valid.
+*                          In an ISR that preempts SysTick_Handler(), or with interrupts
+*                          masked, SysTick may have reloaded without the ms count being
+*                          incremented. That tick is pending, so it is added here if VAL
+*                          was read after the reload.
+*    - Public
+*****************************************************************************************/
+INT32U SysTickGetCycleStamp(void){
+    INT32U ms;
+    INT32U val;
+    INT32U pend;
+    do{
+        ms = stmsCount;
+        val = SysTick->VAL;
+        pend = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+    }while(ms != stmsCount);              /* read again if the tick happened in between */
+    if((pend != 0) && (val > (CLK_PER_MS/2U))){
+        ms++;                             /* reloaded before VAL was read, handler not run yet */
+    }else{}
+    return (ms*CLK_PER_MS) + (CLK_PER_MS - 1U - val);
 }
 
 /*****************************************************************************************
 * SysTickDlyInit() - Initialization routine for SysTickDelay()
 *****************************************************************************************/
 void SysTickDlyInit(void){
+    INT8U bin;
     stInitFlag = 0;
     stmsCount = 0;
     stSliceCount = 0;
-    stLastEvent = 0;
+    stNextEvent = 0;
+    stOverrunCount = 0;
+    stOverrunms = 0;
+    stSkipCount = 0;
+    stJitterSlices = 0;
+    for(bin = 0; bin < ST_JITTER_BINS; bin++){
+        stJitterHist[bin] = 0;
+        stJitterLast[bin] = 0;
+    }
+    stIdleCycles = 0;
+    stCPULoad = 0;
+    stTickHook = 0;
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;   /* WFI enters sleep, not deep sleep */
     (void)SysTick_Config(CLK_PER_MS);
 }
 /*****************************************************************************************
@@ -89,11 +247,63 @@ INT32U SysTickGetmsCount(void){
 INT32U SysTickGetSliceCount(void){
     return stSliceCount;
 }
+
+/*****************************************************************************************
+* SysTickGetOverrunCount() - Get the number of slices that started after their deadline.
+*****************************************************************************************/
+INT32U SysTickGetOverrunCount(void){
+    return stOverrunCount;
+}
+
+/*****************************************************************************************
+* SysTickGetOverrunms() - Get the millisecond count of the most recent overrun.
+*****************************************************************************************/
+INT32U SysTickGetOverrunms(void){
+    return stOverrunms;
+}
+
+/*****************************************************************************************
+* SysTickGetSkipCount() - Get the number of whole slices dropped to catch up.
+*****************************************************************************************/
+INT32U SysTickGetSkipCount(void){
+    return stSkipCount;
+}
+
+/*****************************************************************************************
+* SysTickGetCPULoad() - Get the CPU load of the last complete window in 0.1% units,
+*                       0 to 1000. The load is the time not spent waiting for a slice.
+*****************************************************************************************/
+INT16U SysTickGetCPULoad(void){
+    return stCPULoad;
+}
+
+/*****************************************************************************************
+* SysTickGetJitterHist() - Copies the last complete jitter histogram window into hist.
+*    - hist must hold ST_JITTER_BINS entries. Entry n is the number of slices released
+*      n ms after their deadline, the last entry holds ST_JITTER_BINS-1 ms or more.
+*****************************************************************************************/
+void SysTickGetJitterHist(INT32U *const hist){
+    INT8U bin;
+    for(bin = 0; bin < ST_JITTER_BINS; bin++){
+        hist[bin] = stJitterLast[bin];
+    }
+}
 /*****************************************************************************************
 * SysTick_Handler() - System Tick Interrupt Handler.
 *    - setup for a 1ms periodic interrupt.
 *****************************************************************************************/
 void SysTick_Handler(void){
+    void (*hook)(void) = stTickHook;
     stmsCount++;                    /* Increment 1ms counter    */
+    if(hook != 0){
+        hook();
+    }else{
+    }
+}
+/*****************************************************************************************
+* SysTickSetTickHook() - Sets the function called every 1ms tick, 0 to remove it.
+*****************************************************************************************/
+void SysTickSetTickHook(void (*hook)(void)){
+    stTickHook = hook;
 }
 /****************************************************************************************/
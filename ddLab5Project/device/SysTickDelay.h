@@ -14,6 +14,11 @@
 ****************************************************************************************/
 #ifndef SYS_TICK_INC
 #define SYS_TICK_INC
+/****************************************************************************************
+ * Number of bins in the SysTickWaitEvent() jitter histogram, 1ms per bin
+ ***************************************************************************************/
+#define ST_JITTER_BINS 8U
+
 /****************************************************************************************
  * SysTickDelay()
  * Blocking delay routine. The parameter is the number of ms to delay.
@@ -32,6 +37,8 @@ void SysTickDlyInit(void);
  * SysTickWaitEvent is a periodic blocking routine. It's more like a task - it should
  * only be called one time in timed event or task loop.
  * That is: ONLY ONE INSTANCE is allowed.
+ * Deadlines are absolute so an overrun does not shift later slices. Slices missed
+ * entirely are dropped and counted. The core sleeps with WFI while it waits.
  ***************************************************************************************/
 void SysTickWaitEvent(const INT32U period);
 
@@ -47,4 +54,47 @@ INT32U SysTickGetmsCount(void);
 *****************************************************************************************/
 INT32U SysTickGetSliceCount(void);
 
+/*****************************************************************************************
+* SysTickGetOverrunCount() - Get the number of slices that started after their deadline.
+*****************************************************************************************/
+INT32U SysTickGetOverrunCount(void);
+
+/*****************************************************************************************
+* SysTickGetOverrunms() - Get the millisecond count of the most recent overrun.
+*****************************************************************************************/
+INT32U SysTickGetOverrunms(void);
+
+/*****************************************************************************************
+* SysTickGetSkipCount() - Get the number of whole slices dropped to catch up.
+*****************************************************************************************/
+INT32U SysTickGetSkipCount(void);
+
+/*****************************************************************************************
+* SysTickGetCPULoad() - Get the CPU load of the last complete window in 0.1% units,
+*                       0 to 1000. The load is the time not spent waiting for a slice.
+*****************************************************************************************/
+INT16U SysTickGetCPULoad(void);
+
+/*****************************************************************************************
+* SysTickGetJitterHist() - Copies the last complete jitter histogram window into hist.
+*                          hist must hold ST_JITTER_BINS entries. Entry n counts slices
+*                          released n ms late, the last entry counts the rest.
+*****************************************************************************************/
+void SysTickGetJitterHist(INT32U *const hist);
+
+/*****************************************************************************************
+* SysTickGetCycleStamp() - Get a core clock cycle stamp that keeps counting while the core
+*                          sleeps in WFI, unlike the DWT cycle counter. Differences of two
+*                          stamps are valid up to ~23.8s. SysTickDlyInit() must be called
+*                          first.
+*****************************************************************************************/
+INT32U SysTickGetCycleStamp(void);
+
+/*****************************************************************************************
+* SysTickSetTickHook() - Sets a function to be called from the SysTick interrupt every
+*                        1ms, after the ms count is incremented. It must be short and
+*                        interrupt safe. Passing 0 removes it. SysTickDlyInit() clears it.
+*****************************************************************************************/
+void SysTickSetTickHook(void (*hook)(void));
+
 #endif
@@ -1,25 +1,56 @@
 /* AlarmWave.C
  * The purpose of this module is to output values on DAC0. It can either output a 0-3.3V sinewave
- * or a DC 1.65V. It contains functions for intialization, setting mode and a interrput handler to output on DAC0.
- * DAC0 writing is triggered by the PIT.
+ * or a DC 1.65V. It contains functions for intialization and setting mode.
+ * The sinewave is streamed from alarmSineVal[] into DAC0 by eDMA channel 0, which is triggered by PIT0 through
+ * the DMAMUX periodic trigger. The major loop reloads itself at the end of the table so the CPU is not
+ * interrupted while the wave plays. In DC mode the DMA request is disabled and DAC0 holds the DC value.
+ * Tones and sweeps of any frequency are made by the DDS engine, which renders blocks into a ping-pong buffer.
+ * The DMA plays the buffer and the half and major loop interrupts refill the half it is not playing.
+ * The registers are reached through ALARM_DMA, ALARM_DMAMUX and ALARM_DAC so the transfers can be replayed on
+ * mock peripherals.
  *
  * Dominic Danis last edit 12/6/2021
  * */
 
 #include "MCUType.h"
 #include "AlarmWave.h"
-#include "K65TWR_GPIO.h"
+#include "DDS.h"
+#include "Profile.h"
 
 #define DC_VAL 2047
 #define PIT_CNT_VAL 3124
+#define ALARM_DMA_CH 0U                                                         /*must be 0-3 for the PIT trigger*/
+#define ALARM_DMA_SOURCE 60U                                                    /*DMAMUX always enabled slot*/
+#define ALARM_SINE_LEN 64U
 
-typedef enum{SINE,DC}OUTPUT;
+/*eDMA, DMAMUX and DAC0 registers. Can be defined on the command line to use mock peripherals*/
+#ifndef ALARM_DMA
+#define ALARM_DMA DMA0
+#define ALARM_DMAMUX DMAMUX
+#define ALARM_DAC DAC0
+#endif
+#define ALARM_TCD ALARM_DMA->TCD[ALARM_DMA_CH]
+
+/*Clock gates and the PIT0 trigger. Can be defined on the command line to stub them out*/
+#ifndef ALARM_CLK_INIT
+#define ALARM_CLK_INIT() alarmClkInit()
+#define ALARM_PIT_INIT() AlarmWavePitInit()
+#endif
+
+typedef enum{SINE,DC,SYNTH}OUTPUT;
 static OUTPUT Current;
+static DDS_T alarmDDS;
+static INT16U alarmDDSBuf[2*DDS_BLOCK_LEN];                                     /*ping-pong buffer for DDS samples*/
 static void AlarmWavePitInit(void);
+static void alarmClkInit(void);
 static void AlarmWaveDACInit(void);
-void PIT0_IRQHandler(void);
-static INT8U alarmSineIndex = 0;
-static const INT16U alarmSineVal[64] = {2047,2248,2447,2642,2831,3012,3185,3346,
+static void AlarmWaveDMAInit(void);
+static void alarmDACWrite(INT16U val);
+static void alarmDMAStop(void);
+static void alarmDMAStart(const INT16U *src, INT16U len, INT16U csr);
+static void alarmSynthStart(void);
+void DMA0_DMA16_IRQHandler(void);
+static const INT16U alarmSineVal[ALARM_SINE_LEN] = {2047,2248,2447,2642,2831,3012,3185,3346,
                                    3495,3630,3750,3853,3939,4007,4056,4085,
                                    4095,4085,4056,4007,3939,3853,3750,3630,
                                    3495,3346,3185,3012,2831,2642,2447,2248,
@@ -28,75 +59,174 @@ static const INT16U alarmSineVal[64] = {2047,2248,2447,2642,2831,3012,3185,3346,
                                    0,9,38,87,155,241,344,464,
                                    599,748,909,1082,1263,1452,1647,1846};
 /*AlarmWaveInit()
- * This function initializes everything necessary for the Alarm Wave, will initialize PIT and DAC - new returns or parameters
+ * This function initializes everything necessary for the Alarm Wave, will initialize DMA, PIT and DAC - new returns or parameters
  * */
 void AlarmWaveInit(void){
+    ALARM_CLK_INIT();
     AlarmWaveDACInit();
     Current = DC;
-    AlarmWavePitInit();
+    alarmDACWrite(DC_VAL);
+    DDSInit(&alarmDDS, alarmSineVal);
+    AlarmWaveDMAInit();
+    ALARM_PIT_INIT();
 }
 /*AlarmWaveSetMode
- * This function changes the private variable inside AlarmWave.c that determines the output of the DAC
+ * This function changes the output of the DAC.
  * If parameter is 0 mode is set to output a sine wave, if parameter is 1 mode is set to output a DC 1.65v.
- * All other parameters do nothing
+ * The sine wave restarts from the first sample when it is selected while in DC. Selecting the current mode
+ * does nothing. All other parameters do nothing
  * */
-void AlarmWaveSetMode(INT8U mode){                                              /*setter for Current (the output state)*/
-    if(mode==0){
+void AlarmWaveSetMode(INT8U mode){
+    if((mode==0) && (Current != SINE)){
         Current = SINE;
-        alarmSineIndex = 0;
+        alarmDMAStop();
+        alarmDMAStart(alarmSineVal, ALARM_SINE_LEN, 0);                         /*loops with no interrupts*/
     }
-    else if(mode==1){
+    else if((mode==1) && (Current != DC)){
         Current = DC;
+        alarmDMAStop();
+        alarmDACWrite(DC_VAL);
+    }
+    else{
+    }
+}
+/*AlarmWaveSetTone
+ * This function plays a steady sine tone of freq_hz on the DAC using the DDS engine. freq_hz must be less than
+ * DDS_SAMPLE_HZ/2. Leave with AlarmWaveSetMode()
+ * */
+void AlarmWaveSetTone(INT32U freq_hz){
+    if(Current == SYNTH){
+        NVIC_DisableIRQ(DMA0_DMA16_IRQn);                                       /*DDS state is shared with the ISR*/
+        DDSSetTone(&alarmDDS, freq_hz);
+        NVIC_EnableIRQ(DMA0_DMA16_IRQn);
+    }
+    else{
+        DDSSetTone(&alarmDDS, freq_hz);
+        alarmSynthStart();
+    }
+}
+/*AlarmWaveSweep
+ * This function plays a sine that sweeps from f0_hz to f1_hz in ms milliseconds and then starts over, like a
+ * siren. type is DDS_SWEEP_LIN or DDS_SWEEP_EXP. Leave with AlarmWaveSetMode()
+ * */
+void AlarmWaveSweep(INT32U f0_hz, INT32U f1_hz, INT32U ms, DDS_SWEEP_T type){
+    if(Current == SYNTH){
+        NVIC_DisableIRQ(DMA0_DMA16_IRQn);
+        DDSSweep(&alarmDDS, f0_hz, f1_hz, ms, type);
+        NVIC_EnableIRQ(DMA0_DMA16_IRQn);
     }
     else{
+        DDSSweep(&alarmDDS, f0_hz, f1_hz, ms, type);
+        alarmSynthStart();
+    }
+}
+/*
+ * alarmSynthStart()
+ * Switches the output to the DDS engine. Both halves of the buffer are rendered before the DMA is started
+ * */
+static void alarmSynthStart(void){
+    Current = SYNTH;
+    alarmDMAStop();
+    DDSRender(&alarmDDS, &alarmDDSBuf[0], DDS_BLOCK_LEN);
+    DDSRender(&alarmDDS, &alarmDDSBuf[DDS_BLOCK_LEN], DDS_BLOCK_LEN);
+    ALARM_DMA->CINT = DMA_CINT_CINT(ALARM_DMA_CH);
+    NVIC_ClearPendingIRQ(DMA0_DMA16_IRQn);
+    NVIC_EnableIRQ(DMA0_DMA16_IRQn);
+    alarmDMAStart(alarmDDSBuf, 2*DDS_BLOCK_LEN, DMA_CSR_INTHALF(1) | DMA_CSR_INTMAJOR(1));
+}
+/*
+ * DMA0_DMA16_IRQHandler()
+ * Half and major loop interrupt for the DDS buffer. The half the DMA is playing is read from CITER, which counts
+ * down from 2*DDS_BLOCK_LEN, and the other half is refilled. Taking it from the hardware instead of toggling keeps
+ * the refill off the playing half if a half and a major loop interrupt are ever served by one call
+ * */
+void DMA0_DMA16_IRQHandler(void){
+    INT32U start = ProfileStart();
+    INT16U citer;
+    ALARM_DMA->CINT = DMA_CINT_CINT(ALARM_DMA_CH);
+    if(Current == SYNTH){
+        citer = (INT16U)(ALARM_TCD.CITER_ELINKNO & DMA_CITER_ELINKNO_CITER_MASK);
+        if(citer > DDS_BLOCK_LEN){                                              /*playing the first half*/
+            DDSRender(&alarmDDS, &alarmDDSBuf[DDS_BLOCK_LEN], DDS_BLOCK_LEN);
+        }
+        else{
+            DDSRender(&alarmDDS, &alarmDDSBuf[0], DDS_BLOCK_LEN);
+        }
     }
+    else{}
+    ProfileStop(PROF_ID_DMA0, start);
+}
+/*
+ * alarmClkInit()
+ * Turns on the clocks for the DAC, the DMAMUX, the eDMA and the PIT
+ * */
+static void alarmClkInit(void){
+    SIM->SCGC2 |= SIM_SCGC2_DAC0(1);
+    SIM->SCGC6 |= SIM_SCGC6_DMAMUX(1) | SIM_SCGC6_PIT(1);
+    SIM->SCGC7 |= SIM_SCGC7_DMA(1);
 }
 /*
  * AlarmWaveDACInit()
- * This function starts the clock for the DAC and configures the DAC for AlarmWave output
+ * This function configures the DAC for AlarmWave output. The clock is turned on by alarmClkInit()
  * */
 static void AlarmWaveDACInit(void){
-    SIM->SCGC2 |= SIM_SCGC2_DAC0(1);
-    DAC0->C0 = DAC_C0_DACTRGSEL(1) | DAC_C0_DACEN(1) | DAC_C0_DACRFS(1);      /*set DAC reference voltage and enable*/
+    ALARM_DAC->C0 = DAC_C0_DACTRGSEL(1) | DAC_C0_DACEN(1) | DAC_C0_DACRFS(1);      /*set DAC reference voltage and enable*/
+}
+/*
+ * AlarmWaveDMAInit()
+ * This function configures eDMA channel ALARM_DMA_CH to move one 16-bit sample to DAC0 DAT0 per PIT0 trigger.
+ * The source is set by alarmDMAStart(). The request is left disabled until a wave is selected.
+ * */
+static void AlarmWaveDMAInit(void){
+    ALARM_DMAMUX->CHCFG[ALARM_DMA_CH] = 0;                                      /*disable while configuring*/
+    ALARM_DMA->CERQ = DMA_CERQ_CERQ(ALARM_DMA_CH);
+    ALARM_TCD.SOFF = sizeof(INT16U);
+    ALARM_TCD.ATTR = DMA_ATTR_SSIZE(1) | DMA_ATTR_DSIZE(1);                     /*16-bit source and destination*/
+    ALARM_TCD.NBYTES_MLNO = DMA_NBYTES_MLNO_NBYTES(sizeof(INT16U));
+    ALARM_TCD.DADDR = (INT32U)&ALARM_DAC->DAT[0].DATL;
+    ALARM_TCD.DOFF = 0;
+    ALARM_TCD.DLAST_SGA = 0;
+    ALARM_TCD.CSR = 0;
+    ALARM_DMAMUX->CHCFG[ALARM_DMA_CH] = DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_TRIG(1) |
+                                        DMAMUX_CHCFG_SOURCE(ALARM_DMA_SOURCE);
+}
+/*
+ * alarmDMAStart()
+ * Starts the DMA playing len samples from src in a loop. SLAST rewinds the source at the end of the major loop
+ * and CITER reloads from BITER so the buffer loops by itself. csr selects the half and major loop interrupts,
+ * DREQ is always clear so the request stays enabled
+ * */
+static void alarmDMAStart(const INT16U *src, INT16U len, INT16U csr){
+    ALARM_TCD.SADDR = (INT32U)src;
+    ALARM_TCD.SLAST = (INT32U)(-(INT32S)(len*sizeof(INT16U)));
+    ALARM_TCD.CITER_ELINKNO = DMA_CITER_ELINKNO_CITER(len);
+    ALARM_TCD.BITER_ELINKNO = DMA_BITER_ELINKNO_BITER(len);
+    ALARM_TCD.CSR = csr;
+    ALARM_DMA->SERQ = DMA_SERQ_SERQ(ALARM_DMA_CH);
+}
+/*
+ * alarmDMAStop()
+ * Disables the DMA request and its interrupt, and waits for a transfer in progress to finish
+ * */
+static void alarmDMAStop(void){
+    ALARM_DMA->CERQ = DMA_CERQ_CERQ(ALARM_DMA_CH);
+    while((ALARM_TCD.CSR & DMA_CSR_ACTIVE_MASK) != 0){}
+    NVIC_DisableIRQ(DMA0_DMA16_IRQn);
 }
 /*
  * AlarmWavePitInit()
- * This function will configure PIT load value, control register for the AlarmWave use
- * and enable the PIT IRQ. No returns or parameters
+ * This function will configure PIT load value and control register for the AlarmWave use.
+ * PIT0 only triggers the DMA so its interrupt is not enabled. No returns or parameters
  * */
 static void AlarmWavePitInit(void){
-    SIM->SCGC6 |= SIM_SCGC6_PIT(1);
     PIT->MCR = PIT_MCR_MDIS(0);
     PIT->CHANNEL[0].LDVAL = PIT_CNT_VAL;
-    PIT->CHANNEL[0].TCTRL = PIT_TCTRL_TIE(1) | PIT_TCTRL_TEN(1);
-    NVIC_EnableIRQ(PIT0_IRQn);
+    PIT->CHANNEL[0].TCTRL = PIT_TCTRL_TEN(1);
 }
 /*
- * PIT0_IRQHandler()
- * This is the handler for the PIT0 IRQ
- * It will clear the flag and output either sinewave or DC values onto the
- * DAC dependent on 'Current' - the variable holding the state of output we want
+ * alarmDACWrite()
+ * Writes a 12-bit value to DAC0 DAT0 with a single 16-bit access
  * */
-void PIT0_IRQHandler(void){
-    DB3_TURN_ON();
-    PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF(1);
-    switch(Current){                                                        /*write different values to DAC depending on state*/
-    case SINE:
-        DAC0->DAT[0].DATL = (INT8U)(alarmSineVal[alarmSineIndex]);
-        DAC0->DAT[0].DATH = (INT8U)(alarmSineVal[alarmSineIndex]>>8);
-        if(alarmSineIndex >= 63){
-            alarmSineIndex = 0;
-        }
-        else{
-            alarmSineIndex++;
-        }
-        break;
-    case DC:
-        DAC0->DAT[0].DATL = (INT8U)(DC_VAL);
-        DAC0->DAT[0].DATH = (INT8U)(DC_VAL>>8);
-        break;
-    default:
-        break;
-    }
-    DB3_TURN_OFF();
+static void alarmDACWrite(INT16U val){
+    *(volatile INT16U *)&ALARM_DAC->DAT[0].DATL = val;
 }
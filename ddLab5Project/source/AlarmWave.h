@@ -1,18 +1,30 @@
-/* AlarmWave.h - Header file for AlarmWave.c - outputs a sinewave or dc on DAC0 with period from PIT
+/* AlarmWave.h - Header file for AlarmWave.c - outputs a sinewave or dc on DAC0, streamed by DMA with period from PIT
  * Dominic Danis 11/19/2021
  * */
 #ifndef ALARM_WAVE_INC
 #define ALARM_WAVE_INC
+#include "DDS.h"
 
 /*Public functions*/
 /*AlarmWaveInit()
- * This function initializes everything necessary for the Alarm Wave, will initialize PIT and DAC - new returns or parameters
+ * This function initializes everything necessary for the Alarm Wave, will initialize DMA, PIT and DAC - new returns or parameters
  * */
 void AlarmWaveInit(void);
 /*AlarmWaveSetMode
- * This function changes the private variable inside AlarmWave.c that determines the output of the DAC
+ * This function changes the output of the DAC.
  * If parameter is 0 mode is set to output a sine wave, if parameter is 1 mode is set to output a DC 1.65v.
- * All other parameters do nothing
+ * The sine wave restarts from the first sample when it is selected while in DC. Selecting the current mode
+ * does nothing. All other parameters do nothing
  * */
 void AlarmWaveSetMode(INT8U mode);
+/*AlarmWaveSetTone
+ * This function plays a steady sine tone of freq_hz on the DAC using the DDS engine. freq_hz must be less than
+ * DDS_SAMPLE_HZ/2. Leave with AlarmWaveSetMode()
+ * */
+void AlarmWaveSetTone(INT32U freq_hz);
+/*AlarmWaveSweep
+ * This function plays a sine that sweeps from f0_hz to f1_hz in ms milliseconds and then starts over, like a
+ * siren. type is DDS_SWEEP_LIN or DDS_SWEEP_EXP. Leave with AlarmWaveSetMode()
+ * */
+void AlarmWaveSweep(INT32U f0_hz, INT32U f1_hz, INT32U ms, DDS_SWEEP_T type);
 #endif
@@ -0,0 +1,274 @@
+/* Control.c
+ * Security system controller as a StateMachine table. What each state shows is data in ctlStateInfo, so the
+ * entry and tick actions are shared by every state. The transition table is a grid of states by events, so a new
+ * state is one more row and a new event one more column.
+ *
+ * Entry and exit delays, the siren warble and the siren time limit are Timer.c timers. They are started by entry
+ * actions and all stopped by the shared exit action, and their callbacks post events. Touching the door zone
+ * while armed starts the entry delay, the instant zone goes straight to alarm. Arming is refused while a zone is
+ * touched.
+ *
+ * A zone event is on the touch to siren latency path so the entry action starts the siren and LEDs first and only
+ * marks the state name for the LCD. The name is written by the next tick action.
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "Control.h"
+#include "StateMachine.h"
+#include "LED.h"
+#include "LCD.h"
+#include "AlarmWave.h"
+#include "Timer.h"
+
+#define CTL_LED_SENSE   0xFFFFU                         /*LED state follows the sensor flags*/
+#define CTL_SIREN_ON    0U                              /*AlarmWaveSetMode() values*/
+#define CTL_SIREN_OFF   1U
+#define CTL_WARBLE_MS   500U                            /*siren on for this long, then off for the same*/
+
+/*What a state shows. Applied by ctlActEnter() and ctlActTick()*/
+typedef struct{
+    const INT8C *name;                                  /*LCD row 1, written by the first tick in the state*/
+    INT16U entry_led;                                   /*LEDSetState() on entry*/
+    INT8U offset;                                       /*LEDInOffset() on entry*/
+    INT8U siren;                                        /*AlarmWaveSetMode() on entry*/
+    INT16U tick_led;                                    /*LEDSetState() each tick*/
+    INT8U tick_period;                                  /*LEDSetPeriod() each tick*/
+    INT8U warble;                                       /*1 to switch the siren on and off*/
+}CTL_STATE_INFO_T;
+
+/*Controller context, passed to every guard and action*/
+typedef struct{
+    INT16U sense;                                       /*sensor flags of the event being handled*/
+    INT8U siren;                                        /*last AlarmWaveSetMode() value*/
+    INT8U show_name;                                    /*1 when the state name is not on the LCD yet*/
+    const INT8C *trouble;                               /*message for CTL_TROUBLE*/
+    TMR_T delay_tmr;                                    /*entry or exit delay, posts CTL_EV_DELAY_DONE*/
+    TMR_T warble_tmr;                                   /*periodic, switches the siren*/
+    TMR_T limit_tmr;                                    /*siren time limit, posts CTL_EV_SIREN_LIMIT*/
+}CTL_CTX_T;
+
+/*Stored Constants*/
+static const INT8C ctlDisarmed[] = "DISARMED";
+static const INT8C ctlExitDelay[] = "EXIT DELAY";
+static const INT8C ctlArmed[] = "ARMED";
+static const INT8C ctlEntryDelay[] = "ENTRY DELAY";
+static const INT8C ctlAlarm[] = "ALARM";
+static const INT8C ctlTamper[] = "TAMPER";
+static const INT8C ctlTroubleName[] = "TROUBLE";
+
+static const CTL_STATE_INFO_T ctlStateInfo[CTL_NUM_STATES] = {
+    /*name           entry_led      offset siren          tick_led       period warble*/
+    {ctlDisarmed,   CTL_LED_SENSE, 0U,    CTL_SIREN_OFF, CTL_LED_SENSE, 25U,   0U},    /*CTL_DISARMED*/
+    {ctlExitDelay,  LED_OFFSET,    1U,    CTL_SIREN_OFF, TSI_BOTH_ON,   10U,   0U},    /*CTL_EXIT_DELAY*/
+    {ctlArmed,      LED_OFFSET,    1U,    CTL_SIREN_OFF, TSI_BOTH_ON,   25U,   0U},    /*CTL_ARMED*/
+    {ctlEntryDelay, LED_OFFSET,    1U,    CTL_SIREN_OFF, TSI_BOTH_ON,   10U,   0U},    /*CTL_ENTRY_DELAY*/
+    {ctlAlarm,      CTL_LED_SENSE, 0U,    CTL_SIREN_ON,  CTL_LED_SENSE, 5U,    1U},    /*CTL_ALARM*/
+    {ctlTamper,     CTL_LED_SENSE, 0U,    CTL_SIREN_ON,  CTL_LED_SENSE, 5U,    1U},    /*CTL_TAMPER*/
+    {ctlTroubleName,CTL_LED_SENSE, 0U,    CTL_SIREN_OFF, CTL_LED_SENSE, 25U,   0U}     /*CTL_TROUBLE*/
+};
+
+/*Private function prototypes*/
+static INT8U ctlGuardZonesClear(void *ctx);
+static void ctlActEnter(void *ctx);
+static void ctlActTick(void *ctx);
+static void ctlActStartExit(void *ctx);
+static void ctlActStartEntry(void *ctx);
+static void ctlActLeave(void *ctx);
+static void ctlActShowTrouble(void *ctx);
+static void ctlActSilence(void *ctx);
+static void ctlDelayDone(void *arg);
+static void ctlWarble(void *arg);
+static void ctlSirenLimit(void *arg);
+
+/*Action lists*/
+static const SM_ACTION ctlEnter[] = {ctlActEnter, 0};
+static const SM_ACTION ctlEnterExit[] = {ctlActEnter, ctlActStartExit, 0};
+static const SM_ACTION ctlEnterEntry[] = {ctlActEnter, ctlActStartEntry, 0};
+static const SM_ACTION ctlEnterTrouble[] = {ctlActEnter, ctlActShowTrouble, 0};
+static const SM_ACTION ctlLeave[] = {ctlActLeave, 0};
+static const SM_ACTION ctlTick[] = {ctlActTick, 0};
+static const SM_ACTION ctlTrouble[] = {ctlActShowTrouble, 0};
+static const SM_ACTION ctlSilence[] = {ctlActSilence, 0};
+
+static const SM_STATE_T ctlStates[CTL_NUM_STATES] = {
+    {ctlEnter, ctlLeave},                               /*CTL_DISARMED*/
+    {ctlEnterExit, ctlLeave},                           /*CTL_EXIT_DELAY*/
+    {ctlEnter, ctlLeave},                               /*CTL_ARMED*/
+    {ctlEnterEntry, ctlLeave},                          /*CTL_ENTRY_DELAY*/
+    {ctlEnter, ctlLeave},                               /*CTL_ALARM*/
+    {ctlEnter, ctlLeave},                               /*CTL_TAMPER*/
+    {ctlEnterTrouble, ctlLeave}                         /*CTL_TROUBLE*/
+};
+
+/*Transition table, one row per state and one column per event*/
+#define CTL_IGN         {0, 0, SM_IGNORE}
+#define CTL_GO(state)   {0, 0, (state)}
+#define CTL_TICK        {0, ctlTick, SM_STAY}
+#define CTL_TRBL        {0, ctlTrouble, SM_STAY}
+#define CTL_SIL         {0, ctlSilence, SM_STAY}
+static const SM_TRANS_T ctlTable[CTL_NUM_STATES][CTL_NUM_EVENTS] = {
+    /*CTL_EV_PIN                                    DOOR                        INSTANT                 DELAY_DONE              TAMPER                  TROUBLE                 TICK        SIREN_LIMIT*/
+    {{ctlGuardZonesClear, 0, CTL_EXIT_DELAY},       CTL_IGN,                    CTL_IGN,                CTL_IGN,                CTL_GO(CTL_TAMPER),     CTL_GO(CTL_TROUBLE),    CTL_TICK,   CTL_IGN},   /*CTL_DISARMED*/
+    {CTL_GO(CTL_DISARMED),                          CTL_IGN,                    CTL_IGN,                CTL_GO(CTL_ARMED),      CTL_GO(CTL_TAMPER),     CTL_TRBL,               CTL_TICK,   CTL_IGN},   /*CTL_EXIT_DELAY*/
+    {CTL_GO(CTL_DISARMED),                          CTL_GO(CTL_ENTRY_DELAY),    CTL_GO(CTL_ALARM),      CTL_IGN,                CTL_GO(CTL_TAMPER),     CTL_TRBL,               CTL_TICK,   CTL_IGN},   /*CTL_ARMED*/
+    {CTL_GO(CTL_DISARMED),                          CTL_IGN,                    CTL_GO(CTL_ALARM),      CTL_GO(CTL_ALARM),      CTL_GO(CTL_TAMPER),     CTL_TRBL,               CTL_TICK,   CTL_IGN},   /*CTL_ENTRY_DELAY*/
+    {CTL_GO(CTL_DISARMED),                          CTL_IGN,                    CTL_IGN,                CTL_IGN,                CTL_IGN,                CTL_TRBL,               CTL_TICK,   CTL_SIL},   /*CTL_ALARM*/
+    {CTL_GO(CTL_DISARMED),                          CTL_IGN,                    CTL_IGN,                CTL_IGN,                CTL_IGN,                CTL_TRBL,               CTL_TICK,   CTL_SIL},   /*CTL_TAMPER*/
+    {CTL_GO(CTL_DISARMED),                          CTL_IGN,                    CTL_IGN,                CTL_IGN,                CTL_GO(CTL_TAMPER),     CTL_TRBL,               CTL_TICK,   CTL_IGN}    /*CTL_TROUBLE*/
+};
+
+static const SM_DEF_T ctlDef = {&ctlTable[0][0], ctlStates, (INT8U)CTL_NUM_STATES, (INT8U)CTL_NUM_EVENTS};
+
+/*Private Variables*/
+static SM_T ctlSm;
+static CTL_CTX_T ctlCtx;
+
+/* ControlInit - no parameters and returns nothing.
+ * */
+void ControlInit(void){
+    ctlCtx.sense = TSI_BOTH_OFF;
+    ctlCtx.siren = CTL_SIREN_OFF;
+    ctlCtx.show_name = 0;
+    ctlCtx.trouble = ctlTroubleName;
+    TimerSetup(&ctlCtx.delay_tmr, ctlDelayDone, 0);
+    TimerSetup(&ctlCtx.warble_tmr, ctlWarble, 0);
+    TimerSetup(&ctlCtx.limit_tmr, ctlSirenLimit, 0);
+    SmInit(&ctlSm, &ctlDef, (INT8U)CTL_DISARMED, &ctlCtx);
+}
+
+/* ControlPost - takes an event and the sensor flags, returns 1 if it was handled.
+ * */
+INT8U ControlPost(CTL_EVENT event, INT16U sense){
+    ctlCtx.sense = sense;
+    return SmDispatch(&ctlSm, (INT8U)event);
+}
+
+/* ControlTrouble - takes a message, returns nothing.
+ * */
+void ControlTrouble(const INT8C *reason){
+    ctlCtx.trouble = reason;
+    (void)SmDispatch(&ctlSm, (INT8U)CTL_EV_TROUBLE);
+}
+
+/* ControlGetState - no parameters, returns the current state.
+ * */
+CTL_STATE ControlGetState(void){
+    return (CTL_STATE)SmGetState(&ctlSm);
+}
+
+/* ctlGuardZonesClear - private guard. Returns 1 if no zone is touched, so the system can be armed.
+ * */
+static INT8U ctlGuardZonesClear(void *ctx){
+    return (INT8U)(((CTL_CTX_T *)ctx)->sense == TSI_BOTH_OFF);
+}
+
+/* ctlActEnter - private entry action for every state. Sets the siren and LEDs from ctlStateInfo, then leaves the
+ * state name for ctlActTick().
+ * */
+static void ctlActEnter(void *ctx){
+    CTL_CTX_T *c = (CTL_CTX_T *)ctx;
+    const CTL_STATE_INFO_T *info = &ctlStateInfo[SmGetState(&ctlSm)];
+    c->siren = info->siren;
+    AlarmWaveSetMode(c->siren);
+    LEDSetPeriod(0);
+    if(info->entry_led == CTL_LED_SENSE){
+        LEDSetState(c->sense);
+    }
+    else{
+        LEDSetState(info->entry_led);
+    }
+    LEDInOffset(info->offset);
+    c->show_name = 1;
+    if(info->warble != 0){
+        TimerStart(&c->warble_tmr, CTL_WARBLE_MS, CTL_WARBLE_MS);
+        TimerStart(&c->limit_tmr, CTL_SIREN_LIMIT_MS, 0);
+    }
+    else{}
+}
+
+/* ctlActTick - private tick action for every state. Shows the state name if it is new and updates the LEDs.
+ * */
+static void ctlActTick(void *ctx){
+    CTL_CTX_T *c = (CTL_CTX_T *)ctx;
+    const CTL_STATE_INFO_T *info = &ctlStateInfo[SmGetState(&ctlSm)];
+    if(c->show_name != 0){
+        c->show_name = 0;
+        LcdDispLineClear(LCD_ROW_1);
+        LcdDispString((INT8C *const)info->name);
+    }
+    else{}
+    if(info->tick_led == CTL_LED_SENSE){
+        LEDSetState(c->sense);
+    }
+    else{
+        LEDSetState(info->tick_led);
+    }
+    LEDSetPeriod(info->tick_period);
+}
+
+/* ctlActStartExit - private. Starts the exit delay.
+ * */
+static void ctlActStartExit(void *ctx){
+    TimerStart(&((CTL_CTX_T *)ctx)->delay_tmr, CTL_EXIT_DELAY_MS, 0);
+}
+
+/* ctlActStartEntry - private. Starts the entry delay.
+ * */
+static void ctlActStartEntry(void *ctx){
+    TimerStart(&((CTL_CTX_T *)ctx)->delay_tmr, CTL_ENTRY_DELAY_MS, 0);
+}
+
+/* ctlActLeave - private exit action for every state. Stops the state's timers, a delay that has not run out is
+ * cancelled.
+ * */
+static void ctlActLeave(void *ctx){
+    CTL_CTX_T *c = (CTL_CTX_T *)ctx;
+    TimerStop(&c->delay_tmr);
+    TimerStop(&c->warble_tmr);
+    TimerStop(&c->limit_tmr);
+}
+
+/* ctlActSilence - private. Siren time limit. Stops the siren, the state and LEDs stay until a PIN is entered.
+ * */
+static void ctlActSilence(void *ctx){
+    CTL_CTX_T *c = (CTL_CTX_T *)ctx;
+    TimerStop(&c->warble_tmr);
+    c->siren = CTL_SIREN_OFF;
+    AlarmWaveSetMode(c->siren);
+}
+
+/* ctlActShowTrouble - private. Shows the trouble message on row 2.
+ * */
+static void ctlActShowTrouble(void *ctx){
+    LcdDispLineClear(LCD_ROW_2);
+    LcdDispString((INT8C *const)((CTL_CTX_T *)ctx)->trouble);
+}
+
+/* ctlDelayDone - private timer callback. Posts CTL_EV_DELAY_DONE.
+ * */
+static void ctlDelayDone(void *arg){
+    (void)arg;
+    (void)SmDispatch(&ctlSm, (INT8U)CTL_EV_DELAY_DONE);
+}
+
+/* ctlWarble - private timer callback. Switches the siren on or off.
+ * */
+static void ctlWarble(void *arg){
+    (void)arg;
+    if(ctlCtx.siren == CTL_SIREN_ON){
+        ctlCtx.siren = CTL_SIREN_OFF;
+    }
+    else{
+        ctlCtx.siren = CTL_SIREN_ON;
+    }
+    AlarmWaveSetMode(ctlCtx.siren);
+}
+
+/* ctlSirenLimit - private timer callback. Posts CTL_EV_SIREN_LIMIT.
+ * */
+static void ctlSirenLimit(void *arg){
+    (void)arg;
+    (void)SmDispatch(&ctlSm, (INT8U)CTL_EV_SIREN_LIMIT);
+}
@@ -0,0 +1,55 @@
+/* Control.h - Header file for Control.c - the security system controller.
+ * The controller is a StateMachine table. Lab5Main.c turns keypad, sensor and fault inputs into events and
+ * posts them with ControlPost().
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef CONTROL_INC
+#define CONTROL_INC
+#include "LED.h"
+
+/*Defined constants*/
+#define CTL_TICK_MS         50U                         /*period of CTL_EV_TICK*/
+#define CTL_EXIT_DELAY_MS   10000U                      /*time to leave after arming*/
+#define CTL_ENTRY_DELAY_MS  5000U                       /*time to disarm after the door zone trips*/
+#define CTL_SIREN_LIMIT_MS  240000U                     /*siren stops after this, the alarm stays*/
+#define CTL_DOOR_ZONE       TSI_12_ON                   /*delayed zone, pad 1*/
+#define CTL_INSTANT_ZONE    TSI_11_ON                   /*instant zone, pad 2*/
+
+/*Controller states, the rows of the transition table*/
+typedef enum{CTL_DISARMED, CTL_EXIT_DELAY, CTL_ARMED, CTL_ENTRY_DELAY, CTL_ALARM, CTL_TAMPER, CTL_TROUBLE,
+    CTL_NUM_STATES}CTL_STATE;
+
+/*Controller events, the columns of the transition table
+ * CTL_EV_PIN        - a valid PIN was entered
+ * CTL_EV_DOOR       - the door zone is touched
+ * CTL_EV_INSTANT    - the instant zone is touched
+ * CTL_EV_DELAY_DONE - the entry or exit delay ran out
+ * CTL_EV_TAMPER     - keypad locked out after repeated wrong PINs
+ * CTL_EV_TROUBLE    - a fault, see ControlTrouble()
+ * CTL_EV_TICK       - every CTL_TICK_MS, after the other events of that tick
+ * CTL_EV_SIREN_LIMIT - the siren has run for CTL_SIREN_LIMIT_MS
+ * CTL_EV_DELAY_DONE and CTL_EV_SIREN_LIMIT are posted by the controller's own timers*/
+typedef enum{CTL_EV_PIN, CTL_EV_DOOR, CTL_EV_INSTANT, CTL_EV_DELAY_DONE, CTL_EV_TAMPER, CTL_EV_TROUBLE,
+    CTL_EV_TICK, CTL_EV_SIREN_LIMIT, CTL_NUM_EVENTS}CTL_EVENT;
+
+/* ControlInit - no parameters and returns nothing. Starts the controller in CTL_DISARMED. TimerInit() must be
+ * called first. The state name is shown by the first CTL_EV_TICK.
+ * */
+void ControlInit(void);
+
+/* ControlPost - takes an event and the sensor flags from TSIGetSensorFlags(), returns 1 if the event was
+ * handled in the current state.
+ * */
+INT8U ControlPost(CTL_EVENT event, INT16U sense);
+
+/* ControlTrouble - takes a short message for LCD row 2, returns nothing. Posts CTL_EV_TROUBLE.
+ * */
+void ControlTrouble(const INT8C *reason);
+
+/* ControlGetState - no parameters, returns the current state.
+ * */
+CTL_STATE ControlGetState(void);
+
+#endif
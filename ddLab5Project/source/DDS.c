@@ -0,0 +1,102 @@
+/* DDS.c
+ * A fixed-point direct digital synthesis engine. A 32-bit phase accumulator advances by a tuning word every
+ * sample and indexes a one period wave table with linear interpolation, so any frequency up to half the sample
+ * rate can be played from one small table at a fixed sample rate. Sweeps update the tuning word once per block
+ * of samples, either by a fixed step (linear) or a fixed ratio (exponential).
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "DDS.h"
+#include "math.h"
+
+#define DDS_INDEX_SHIFT (32U - DDS_TABLE_BITS)
+#define DDS_FRAC_SHIFT  (DDS_INDEX_SHIFT - 16U)
+#define DDS_TABLE_MASK  ((1U << DDS_TABLE_BITS) - 1U)
+#define DDS_Q30_ONE     0x40000000U
+
+/* DDSInit - takes a pointer to an engine and a pointer to a one period wave table, returns nothing.
+ * */
+void DDSInit(DDS_T *dds, const INT16U *table){
+    dds->table = table;
+    dds->phase = 0;
+    dds->tuning = 0;
+    dds->tuning_start = 0;
+    dds->step = 0;
+    dds->ratio = DDS_Q30_ONE;
+    dds->blocks = 0;
+    dds->block_cnt = 0;
+    dds->sweep = DDS_SWEEP_LIN;
+}
+
+/* DDSTuningWord - takes a frequency in Hz and returns the tuning word, freq * 2^32 / DDS_SAMPLE_HZ rounded.
+ * */
+INT32U DDSTuningWord(INT32U freq_hz){
+    return (INT32U)((((INT64U)freq_hz << 32) + (DDS_SAMPLE_HZ/2U))/DDS_SAMPLE_HZ);
+}
+
+/* DDSSetTone - takes a pointer to an engine and a frequency in Hz, returns nothing.
+ * */
+void DDSSetTone(DDS_T *dds, INT32U freq_hz){
+    dds->tuning = DDSTuningWord(freq_hz);
+    dds->tuning_start = dds->tuning;
+    dds->blocks = 0;
+    dds->block_cnt = 0;
+}
+
+/* DDSSweep - takes a pointer to an engine, the start and end frequency in Hz, the sweep time in ms and the sweep
+ * type, returns nothing. The exponential ratio is found with pow() here so rendering stays integer only.
+ * */
+void DDSSweep(DDS_T *dds, INT32U f0_hz, INT32U f1_hz, INT32U ms, DDS_SWEEP_T type){
+    INT32U blocks;
+    INT32U tw0;
+    INT32U tw1;
+    blocks = (INT32U)(((INT64U)ms*DDS_SAMPLE_HZ)/(1000U*DDS_BLOCK_LEN));
+    tw0 = DDSTuningWord(f0_hz);
+    tw1 = DDSTuningWord(f1_hz);
+    dds->tuning = tw0;
+    dds->tuning_start = tw0;
+    dds->block_cnt = 0;
+    dds->sweep = type;
+    if((blocks == 0) || (f0_hz == 0)){
+        dds->blocks = 0;                                                        /*too short or from DC, steady f0*/
+    }
+    else{
+        dds->blocks = blocks;
+        dds->step = (INT32S)(((INT64S)tw1 - (INT64S)tw0)/(INT64S)blocks);
+        dds->ratio = (INT32U)(pow((FP64)f1_hz/(FP64)f0_hz, 1.0/(FP64)blocks)*(FP64)DDS_Q30_ONE + 0.5);
+    }
+}
+
+/* DDSRender - takes a pointer to an engine, a sample buffer and a number of samples, returns nothing.
+ * */
+void DDSRender(DDS_T *dds, INT16U *buf, INT32U n){
+    INT32U i;
+    INT32U idx;
+    INT32S frac;
+    INT32S a;
+    INT32S b;
+    for(i=0;i<n;i++){
+        idx = dds->phase >> DDS_INDEX_SHIFT;
+        frac = (INT32S)((dds->phase >> DDS_FRAC_SHIFT) & 0xFFFFU);
+        a = (INT32S)dds->table[idx];
+        b = (INT32S)dds->table[(idx + 1U) & DDS_TABLE_MASK];
+        buf[i] = (INT16U)(a + (((b - a)*frac) >> 16));
+        dds->phase += dds->tuning;
+    }
+    if(dds->blocks != 0){
+        dds->block_cnt++;
+        if(dds->block_cnt >= dds->blocks){                                      /*start the sweep over*/
+            dds->block_cnt = 0;
+            dds->tuning = dds->tuning_start;
+        }
+        else if(dds->sweep == DDS_SWEEP_EXP){
+            dds->tuning = (INT32U)(((INT64U)dds->tuning*dds->ratio) >> 30);
+        }
+        else{
+            dds->tuning = (INT32U)((INT32S)dds->tuning + dds->step);
+        }
+    }
+    else{}
+}
@@ -0,0 +1,58 @@
+/* DDS.h - Header file for DDS.c - a fixed-point direct digital synthesis engine for alarm tones and sweeps.
+ * The engine renders blocks of DAC samples into a buffer and does not touch any hardware.
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef DDS_INC
+#define DDS_INC
+
+/*Defined constants*/
+#define DDS_SAMPLE_HZ   19200U                  /*sample rate, 60MHz bus / 3125 PIT counts*/
+#define DDS_BLOCK_LEN   32U                     /*samples per block, sweeps are updated once per block*/
+#define DDS_TABLE_BITS  6U                      /*table has 2^DDS_TABLE_BITS entries*/
+
+typedef enum{DDS_SWEEP_LIN, DDS_SWEEP_EXP}DDS_SWEEP_T;
+
+/*Engine state. phase is a 32-bit accumulator, the top DDS_TABLE_BITS bits index the table and the next 16 bits
+ * interpolate between entries. tuning is added to phase every sample*/
+typedef struct{
+    const INT16U *table;
+    INT32U phase;
+    INT32U tuning;
+    INT32U tuning_start;
+    INT32S step;                                /*linear sweep, added to tuning per block*/
+    INT32U ratio;                               /*exponential sweep, tuning multiplier per block, Q30*/
+    INT32U blocks;                              /*blocks in one sweep, 0 for a steady tone*/
+    INT32U block_cnt;
+    DDS_SWEEP_T sweep;
+}DDS_T;
+
+/* DDSInit - takes a pointer to an engine and a pointer to a table of 2^DDS_TABLE_BITS samples for one period
+ * of the wave, returns nothing. The engine starts silent at the first table entry.
+ * */
+void DDSInit(DDS_T *dds, const INT16U *table);
+
+/* DDSTuningWord - takes a frequency in Hz and returns the tuning word for DDS_SAMPLE_HZ. freq_hz must be less
+ * than DDS_SAMPLE_HZ/2.
+ * */
+INT32U DDSTuningWord(INT32U freq_hz);
+
+/* DDSSetTone - takes a pointer to an engine and a frequency in Hz, returns nothing. Plays a steady tone, the
+ * phase is kept so there is no step in the output.
+ * */
+void DDSSetTone(DDS_T *dds, INT32U freq_hz);
+
+/* DDSSweep - takes a pointer to an engine, the start and end frequency in Hz, the sweep time in ms and the sweep
+ * type, returns nothing. The frequency moves from f0_hz to f1_hz in ms, linearly or exponentially, and then the
+ * sweep starts over at f0_hz like a siren. Sweeps shorter than one block play a steady f0_hz tone.
+ * */
+void DDSSweep(DDS_T *dds, INT32U f0_hz, INT32U f1_hz, INT32U ms, DDS_SWEEP_T type);
+
+/* DDSRender - takes a pointer to an engine, a sample buffer and a number of samples, returns nothing.
+ * Writes n interpolated samples to buf then advances the sweep by one block. Call with n = DDS_BLOCK_LEN
+ * for the sweep time to be correct.
+ * */
+void DDSRender(DDS_T *dds, INT16U *buf, INT32U n);
+
+#endif
@@ -0,0 +1,114 @@
+/* FlashScan.c
+ * A background flash integrity scanner. The boot checksum only catches corruption at reset, so FlashScanTask()
+ * keeps checksumming the image with MemChkSum() a chunk at a time in the lowest priority slot of the scheduler.
+ * The partial sum is kept in a FLASH_SCAN_T context so a pass can be resumed in the next slice. Because the
+ * checksum is a sum of bytes mod 2^16, adding the chunk sums gives the same result as one MemChkSum() of the
+ * whole range. The time each step takes is limited by a cycle budget measured with ProfileStart().
+ * The context functions do not touch any hardware besides the cycle counter so they can run on a buffer.
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "FlashScan.h"
+#include "MemoryTools.h"
+#include "Profile.h"
+
+/*Private variables*/
+static FLASH_SCAN_T flashScan;
+static INT8U flashScanEnabled = 0;
+static INT8U flashScanFault = 0;
+
+/* FlashScanCtxInit - takes a context, the first and last byte of the range and the reference checksum,
+ * returns nothing.
+ * */
+void FlashScanCtxInit(FLASH_SCAN_T *scan, const INT8U *start, const INT8U *end, INT16U ref){
+    scan->start = start;
+    scan->end = end;
+    scan->next = start;
+    scan->sum = 0;
+    scan->ref = ref;
+    scan->chunk_cycles = 0;
+    scan->passes = 0;
+    scan->fails = 0;
+}
+
+/* FlashScanStep - takes a context, the max number of bytes to check and a cycle budget, returns the pass result
+ * or FLASH_SCAN_BUSY. The budget check uses the time of the last chunk to predict the next one, so a step
+ * overruns the budget only when a chunk is slower than the one before it.
+ * */
+FLASH_SCAN_STATUS FlashScanStep(FLASH_SCAN_T *scan, INT32U max_bytes, INT32U budget){
+    FLASH_SCAN_STATUS status = FLASH_SCAN_BUSY;
+    const INT8U *last;
+    INT32U bytes = 0;
+    INT32U start;
+    INT32U chunk_start;
+    INT32U len;
+    start = ProfileStart();
+    do{
+        len = (INT32U)(scan->end - scan->next);                                 /*bytes left after next*/
+        if(len >= FLASH_SCAN_CHUNK){
+            len = FLASH_SCAN_CHUNK - 1U;
+        }
+        else{}
+        last = scan->next + len;
+        chunk_start = ProfileStart();
+        scan->sum = (INT16U)(scan->sum + MemChkSum((INT8U *)scan->next, (INT8U *)last));
+        scan->chunk_cycles = ProfileStart() - chunk_start;
+        bytes += len + 1U;
+        if(last == scan->end){                                                  /*pass complete*/
+            scan->passes++;
+            if(scan->sum == scan->ref){
+                status = FLASH_SCAN_PASS;
+            }
+            else{
+                scan->fails++;
+                status = FLASH_SCAN_FAIL;
+            }
+            scan->next = scan->start;
+            scan->sum = 0;
+        }
+        else{
+            scan->next = last + 1;
+        }
+    }while((status == FLASH_SCAN_BUSY) && ((bytes + FLASH_SCAN_CHUNK) <= max_bytes) &&
+           (((ProfileStart() - start) + scan->chunk_cycles) <= budget));
+    return status;
+}
+
+/* FlashScanInit - takes the first and last byte of the range and the reference checksum, returns nothing.
+ * */
+void FlashScanInit(const INT8U *start, const INT8U *end, INT16U ref){
+    FlashScanCtxInit(&flashScan, start, end, ref);
+    flashScanFault = 0;
+    flashScanEnabled = 1;
+}
+
+/* FlashScanTask - no parameters or returns. Is meant to be used in a timeslice scheduler at the lowest priority.
+ * Does nothing until FlashScanInit() is called.
+ * */
+void FlashScanTask(void){
+    if(flashScanEnabled != 0){
+        if(FlashScanStep(&flashScan, FLASH_SCAN_SLICE_BYTES, FLASH_SCAN_BUDGET) == FLASH_SCAN_FAIL){
+            flashScanFault = 1;
+        }
+        else{}
+    }
+    else{}
+}
+
+/* FlashScanGetFault - no parameters, returns 1 if a pass has failed since the last call, else 0.
+ * Only called from tasks so it does not need to mask interrupts.
+ * */
+INT8U FlashScanGetFault(void){
+    INT8U fault;
+    fault = flashScanFault;
+    flashScanFault = 0;
+    return fault;
+}
+
+/* FlashScanGetPasses - no parameters, returns the number of full passes FlashScanTask() has finished.
+ * */
+INT32U FlashScanGetPasses(void){
+    return flashScan.passes;
+}
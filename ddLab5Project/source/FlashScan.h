@@ -0,0 +1,63 @@
+/* FlashScan.h - Header file for FlashScan.c - a background flash integrity scanner.
+ * Checksums a range of memory a piece at a time so a full pass is spread over many time slices, and compares
+ * each full pass against a reference checksum.
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef FLASHSCAN_INC
+#define FLASHSCAN_INC
+
+/*Defined constants*/
+#define FLASH_SCAN_CHUNK        1024U                   /*bytes per MemChkSum() call*/
+#define FLASH_SCAN_SLICE_BYTES  8192U                   /*max bytes checked by FlashScanTask() per slice*/
+#define FLASH_SCAN_BUDGET       9000U                   /*FlashScanTask() cycle budget per slice, 50us at 180MHz*/
+
+/*Results of FlashScanStep()*/
+typedef enum{FLASH_SCAN_BUSY, FLASH_SCAN_PASS, FLASH_SCAN_FAIL}FLASH_SCAN_STATUS;
+
+/*Resumable scan context. Only changed through the FlashScan functions*/
+typedef struct{
+    const INT8U *start;
+    const INT8U *end;                                   /*last byte in the range, included*/
+    const INT8U *next;                                  /*first byte not yet summed in this pass*/
+    INT16U sum;                                         /*partial checksum of this pass*/
+    INT16U ref;                                         /*expected checksum of a full pass*/
+    INT32U chunk_cycles;                                /*cycles the last chunk took*/
+    INT32U passes;
+    INT32U fails;
+}FLASH_SCAN_T;
+
+/* FlashScanCtxInit - takes a context, the first and last byte of the range and the reference checksum,
+ * returns nothing. The reference is a MemChkSum() of the whole range. The next step starts a new pass.
+ * */
+void FlashScanCtxInit(FLASH_SCAN_T *scan, const INT8U *start, const INT8U *end, INT16U ref);
+
+/* FlashScanStep - takes a context, the max number of bytes to check and a cycle budget, returns
+ * FLASH_SCAN_PASS or FLASH_SCAN_FAIL when a pass was finished by this step, else FLASH_SCAN_BUSY.
+ * Checks FLASH_SCAN_CHUNK bytes at a time. At least one chunk is checked each step so the scan always moves.
+ * Another chunk is only started if the time of the last chunk still fits in the budget. A step never
+ * continues past the end of a pass.
+ * */
+FLASH_SCAN_STATUS FlashScanStep(FLASH_SCAN_T *scan, INT32U max_bytes, INT32U budget);
+
+/* FlashScanInit - takes the first and last byte of the range and the reference checksum, returns nothing.
+ * Sets up the context used by FlashScanTask().
+ * */
+void FlashScanInit(const INT8U *start, const INT8U *end, INT16U ref);
+
+/* FlashScanTask - no parameters or returns. Is meant to be used in a timeslice scheduler. Runs one
+ * FlashScanStep() with FLASH_SCAN_SLICE_BYTES and FLASH_SCAN_BUDGET and latches a failed pass.
+ * */
+void FlashScanTask(void);
+
+/* FlashScanGetFault - no parameters, returns 1 if a pass has failed since the last call, else 0.
+ * The fault is cleared by reading it so it is only reported one time.
+ * */
+INT8U FlashScanGetFault(void);
+
+/* FlashScanGetPasses - no parameters, returns the number of full passes FlashScanTask() has finished.
+ * */
+INT32U FlashScanGetPasses(void);
+
+#endif
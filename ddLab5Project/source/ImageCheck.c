@@ -0,0 +1,93 @@
+/* ImageCheck.c
+ * Boot verification of the flash image. The range is taken from the linker instead of checking all 2MB of flash:
+ * it starts at the vector table and ends at the end of the code or of the initialized data that is copied to
+ * RAM at reset, whichever is later. The expected CRC32 is kept in imageCRCRecord in its own section. The
+ * post-build step finds the record by its magic number and blank crc, computes the CRC32 of the binary without
+ * the crc word and writes it into the record. At boot the CRC module computes the same CRC over the range,
+ * skipping the crc word, and compares.
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "ImageCheck.h"
+#include "MemoryTools.h"
+
+/*Linker and startup symbols*/
+extern void (* const g_pfnVectors[])(void);
+extern unsigned int _etext;
+extern unsigned int __data_section_table;
+extern unsigned int __data_section_table_end;
+
+/*Reference record, stamped after the build. volatile so the compiler does not fold in the blank value*/
+__attribute__((used, section(".rodata.image_crc")))
+static const volatile IMAGE_CRC_REC_T imageCRCRecord = {IMAGE_CRC_MAGIC, IMAGE_CRC_BLANK};
+
+/*Image layout. Can be defined on the command line to verify an image in a buffer*/
+#ifndef IMAGE_START
+#define IMAGE_START ((const INT8U *)g_pfnVectors)
+#define IMAGE_ETEXT ((const INT8U *)&_etext)
+#define IMAGE_DATA_TABLE ((const INT32U *)&__data_section_table)
+#define IMAGE_DATA_TABLE_END ((const INT32U *)&__data_section_table_end)
+#define IMAGE_CRC_REC imageCRCRecord
+#endif
+
+/* ImageRangeFromTable - takes the image start, the end of the code, the data section table and its end, and a
+ * pointer to the range to fill, returns nothing.
+ * */
+void ImageRangeFromTable(const INT8U *start, const INT8U *etext, const INT32U *table, const INT32U *table_end,
+                         IMAGE_RANGE_T *range){
+    const INT8U *load_end;
+    const INT8U *end = etext;
+    while(table < table_end){                                                   /*load, exec, length*/
+        load_end = (const INT8U *)table[0] + table[2];
+        if(load_end > end){
+            end = load_end;
+        }
+        else{}
+        table += 3;
+    }
+    range->start = start;
+    range->end = end - 1;
+}
+
+/* ImageGetRange - takes a pointer to the range to fill, returns nothing.
+ * */
+void ImageGetRange(IMAGE_RANGE_T *range){
+    ImageRangeFromTable(IMAGE_START, IMAGE_ETEXT, IMAGE_DATA_TABLE, IMAGE_DATA_TABLE_END, range);
+}
+
+/* ImageCompare - takes the computed CRC and the stored record, returns the result.
+ * */
+IMAGE_STATUS ImageCompare(INT32U crc, const IMAGE_CRC_REC_T *rec){
+    IMAGE_STATUS status;
+    if(rec->crc == IMAGE_CRC_BLANK){
+        status = IMAGE_NOT_STAMPED;
+    }
+    else if(rec->crc == crc){
+        status = IMAGE_PASS;
+    }
+    else{
+        status = IMAGE_FAIL;
+    }
+    return status;
+}
+
+/* ImageVerify - takes a pointer to the range to fill, returns the result of checking the image.
+ * The CRC covers the range in two pieces, before and after the crc word of the record.
+ * */
+IMAGE_STATUS ImageVerify(IMAGE_RANGE_T *range){
+    IMAGE_CRC_REC_T rec;
+    const INT8U *skip;
+    ImageGetRange(range);
+    rec.magic = IMAGE_CRC_REC.magic;
+    rec.crc = IMAGE_CRC_REC.crc;
+    skip = (const INT8U *)&IMAGE_CRC_REC.crc;
+    MemCRCInit(MEM_CRC32);
+    MemCRCUpdate(range->start, skip - 1);
+    if((skip + sizeof(INT32U)) <= range->end){
+        MemCRCUpdate(skip + sizeof(INT32U), range->end);
+    }
+    else{}
+    return ImageCompare(MemCRCResult(), &rec);
+}
@@ -0,0 +1,53 @@
+/* ImageCheck.h - Header file for ImageCheck.c - boot verification of the flash image.
+ * The image range comes from the linker symbols and the expected CRC32 is stored in the image by the post-build
+ * step tools/ImageCRC.py.
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef IMAGECHECK_INC
+#define IMAGECHECK_INC
+
+/*Defined constants*/
+#define IMAGE_CRC_MAGIC     0x52435249U                 /*"IRCR", marks the record for the post-build step*/
+#define IMAGE_CRC_BLANK     0xFFFFFFFFU                 /*crc value before the post-build step stamps it*/
+
+/*Results of ImageVerify()*/
+typedef enum{IMAGE_PASS, IMAGE_FAIL, IMAGE_NOT_STAMPED}IMAGE_STATUS;
+
+/*First and last byte of the image in flash*/
+typedef struct{
+    const INT8U *start;
+    const INT8U *end;
+}IMAGE_RANGE_T;
+
+/*Reference CRC record. crc is the CRC32 of the image range without the crc word itself*/
+typedef struct{
+    INT32U magic;
+    INT32U crc;
+}IMAGE_CRC_REC_T;
+
+/* ImageRangeFromTable - takes the image start, the end of the code (_etext), the linker data section table and
+ * its end, and a pointer to the range to fill, returns nothing. Each table entry is a load address, an execution
+ * address and a length. The image ends at the end of the code or the last initialized data load, whichever is
+ * later. Does not touch any hardware.
+ * */
+void ImageRangeFromTable(const INT8U *start, const INT8U *etext, const INT32U *table, const INT32U *table_end,
+                         IMAGE_RANGE_T *range);
+
+/* ImageGetRange - takes a pointer to the range to fill, returns nothing. Uses the vector table, _etext and the
+ * data section table from the linker script.
+ * */
+void ImageGetRange(IMAGE_RANGE_T *range);
+
+/* ImageCompare - takes the CRC computed over the image and the stored record, returns IMAGE_PASS, IMAGE_FAIL,
+ * or IMAGE_NOT_STAMPED if the post-build step has not written the record.
+ * */
+IMAGE_STATUS ImageCompare(INT32U crc, const IMAGE_CRC_REC_T *rec);
+
+/* ImageVerify - takes a pointer to the range to fill, returns the result of checking the image against the
+ * stored CRC. Reconfigures the CRC module for MEM_CRC32.
+ * */
+IMAGE_STATUS ImageVerify(IMAGE_RANGE_T *range);
+
+#endif
@@ -92,7 +92,6 @@ void LEDInit(void){
  * based on ledCurrentState and ledDelayPeriod. It also resets the LED's on a state change as long as we haven't set a default offset
  * */
 void LEDTask(void){
-    DB4_TURN_ON();
     if(ledLastState!=ledCurrentState && ledInOffset!=1){                    //reset LED's when we are switching unless we've set a default offset
         LED9_TURN_OFF();
         LED8_TURN_OFF();
@@ -122,5 +121,4 @@ void LEDTask(void){
     }
     else{}
     ledCount++;
-    DB4_TURN_OFF();
 }
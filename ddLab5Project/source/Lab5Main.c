@@ -1,7 +1,9 @@
 /*******************************************************************************
-* Lab5Main.c - is the main module for Lab5. It contains a timeslice scheduler with 5 tasks. This program is a security system.
-* There are 3 main states (Disarmed, Armed and Alarm) what will display different LED patterns and DAC0 output depending on
-* user input from TSI sensors and Keypad presses.
+* Lab5Main.c - is the main module for Lab5. It runs 8 tasks from a table driven timeslice scheduler. This program is a
+* security system. The controller in Control.c has Disarmed, Exit Delay, Armed, Entry Delay, Alarm, Tamper and Trouble
+* states that display different LED patterns and DAC0 output depending on user input from TSI sensors and Keypad
+* presses. The system is armed and disarmed with a PIN entered on the keypad and ended with '#'. A duress PIN disarms as
+* normal and reports over the serial port.
 *
 * Uses several modules written by Todd Morton
 * Author: Dominic Danis Last Edit: 12/5/2021
@@ -17,148 +19,323 @@
 #include "LED.h"
 #include "K65TWR_TSI.h"
 #include "AlarmWave.h"
+#include "Scheduler.h"
+#include "Profile.h"
+#include "FlashScan.h"
+#include "ImageCheck.h"
+#include "SoftCRC.h"
+#include "Pin.h"
+#include "Control.h"
+#include "Timer.h"
 
 /*Defined Constants*/
-#define WAITDELAY 10
-#define ACODE 0x11
-#define DCODE 0x14
-#define START_ADDR 0x00000000
-#define END_ADDR 0x001FFFFF
-/*States for system*/
-typedef enum {ARMED,DISARMED,ALARM}SECURE_STATES;
+#define PCODE 'p'                                                               /*serial request for a profile dump*/
+#define CCODE 'c'                                                               /*serial request for the CRC benchmark*/
+#define CRC_BENCH_BYTES 4096U                                                   /*bytes of the image per benchmark run*/
+#define TOUCH_MAX_MS    15U                                                     /*touch latency bound, one slice plus start jitter*/
+#define CYCLES_PER_US   (SystemCoreClock/1000000U)                              /*core clock cycles per us for the latency report*/
+/*A CRC benchmark row, the matching SoftCRC.c and MemoryTools.c profiles*/
+typedef struct{
+    SOFT_CRC_PROFILE soft;
+    MEM_CRC_PROFILE hard;
+    const INT8C *name;
+}CRC_BENCH_T;
 /*Stored Constants*/
-static const INT8C lab5Alarm[] =  "ALARM";
-static const INT8C lab5Disarmed[] = "DISARMED";
-static const INT8C lab5Armed[] = "ARMED";
+static const CRC_BENCH_T lab5CRCBenchList[] = {
+    {SOFT_CRC16, MEM_CRC16, "CRC16"},
+    {SOFT_CRC32, MEM_CRC32, "CRC32"}
+};
+static const INT8C lab5FlashFault[] = "FLASH FAULT";
+static const INT8C lab5ImagePass[] = "IMAGE OK";
+static const INT8C lab5ImageFail[] = "IMAGE CRC FAIL";
+static const INT8C lab5ImageBlank[] = "IMAGE NO CRC";
+static const INT8C lab5PinBad[] = "BAD CODE";
+static const INT8C lab5PinLocked[] = "LOCKED";
+static const INT8C lab5PinDuress[] = "DURESS USER ";
+/*PIN table, made with tools/PinHash.py. User 1: 1234, user 1 duress: 4321, user 2: 246810*/
+static const PIN_CODE_T lab5PinCodes[] = {
+    {{0x3A9369E6U, 0x04E2A882U}, {0xAC6AAC3DU, 0x21239EA5U}, 1U, 0U},
+    {{0x4E57479DU, 0x76870155U}, {0x649282FAU, 0xFCB1EF56U}, 1U, PIN_FLAG_DURESS},
+    {{0xB864FF19U, 0x85BA131FU}, {0x4541DCA6U, 0x930713BAU}, 2U, 0U}
+};
 /*Private Variables*/
-static SECURE_STATES lab5CurrentState = DISARMED;
-static INT8U lab5WaveToggle = 0;
+static PIN_T lab5Pin;
+static TMR_T lab5TickTmr;                                                       /*periodic CTL_TICK_MS, counted for TimerFired()*/
+static INT32U lab5TouchLate = 0;                                                /*touch latencies over TOUCH_MAX_MS*/
 /*Private function prototypes*/
 static void lab5ControlTask(void);
-static void lab5StateTransition(SECURE_STATES state, INT16U sense);
+static void lab5PostZone(CTL_EVENT event, INT16U sense, INT32U stamp);
+static INT8U lab5PinCheck(INT8C kchar);
+static void lab5DiagTask(void);
+static void lab5CRCBench(void);
+static INT16U lab5ByteSum(const INT8U *start, const INT8U *end);
+/*Task table - task, period(ms), offset(ms), priority*/
+static const SCHED_TASK_T lab5TaskTable[] = {
+    {lab5ControlTask, 10U, 20U, 0U},                                            /*every slice so a touch is handled in the next one*/
+    {KeyTask,         10U,  0U, 1U},
+    {TSITask,         10U,  0U, 2U},
+    {LEDTask,         10U,  0U, 3U},
+    {lab5DiagTask,   100U, 30U, 4U},
+    {FlashScanTask,   10U,  0U, 6U},                                            /*lowest priority, uses what is left*/
+    {LcdTask,         10U,  0U, 5U},                                            /*flushes the LCD shadow*/
+    {TimerTask,       10U,  0U, 0U}                                             /*software timer wheel, one tick per slice*/
+};
+#define LAB5_NUM_TASKS (sizeof(lab5TaskTable)/sizeof(lab5TaskTable[0]))
+_Static_assert(LAB5_NUM_TASKS <= SCHED_MAX_TASKS, "lab5TaskTable has more tasks than SCHED_MAX_TASKS");
 
 void main(void){
     INT16U checksum;
+    IMAGE_RANGE_T image;
+    IMAGE_STATUS image_status;
     K65TWR_BootClock();
     SysTickDlyInit();
+    ProfileInit();
+    BIOOpen(BIO_BIT_RATE_115200);
     LcdDispInit();
     KeyInit();
+    SysTickSetTickHook(KeyTick);                                                /*row scan every 1ms*/
     GpioDBugBitsInit();
     TSIInit();
     LEDInit();
     AlarmWaveInit();
-    checksum = MemChkSum((INT8U *)START_ADDR, (INT8U *)END_ADDR);
+    PinInit(&lab5Pin, lab5PinCodes, (INT8U)(sizeof(lab5PinCodes)/sizeof(lab5PinCodes[0])));
+    image_status = ImageVerify(&image);                                         /*linker range against stored CRC*/
     LcdCursorMove(LCD_ROW_2, LCD_COL_1);
     LcdCursorMode(0,0);
-    LcdDispHexWord((const INT32U)checksum, 4);
-    LcdCursorMove(LCD_ROW_1, LCD_COL_1);
-    LcdCursorMove(LCD_ROW_1, LCD_COL_1);
-    LcdDispString((INT8C *const)lab5Disarmed);
-    while(1){                                                                   /*time slice super loop*/
-        SysTickWaitEvent(WAITDELAY);
-        lab5ControlTask();
-        KeyTask();
-        TSITask();
-        LEDTask();
+    if(image_status == IMAGE_PASS){
+        LcdDispString((INT8C *const)lab5ImagePass);
     }
+    else if(image_status == IMAGE_FAIL){
+        LcdDispString((INT8C *const)lab5ImageFail);
+    }
+    else{
+        LcdDispString((INT8C *const)lab5ImageBlank);
+    }
+    checksum = MemChkSum((INT8U *)image.start, (INT8U *)image.end);
+    FlashScanInit(image.start, image.end, checksum);                            /*boot checksum is the reference*/
+    TimerInit(SysTickGetmsCount());
+    TimerSetup(&lab5TickTmr, 0, 0);
+    TimerStart(&lab5TickTmr, CTL_TICK_MS, CTL_TICK_MS);
+    ControlInit();                                                              /*DISARMED is shown by the first tick*/
+    if(image_status == IMAGE_FAIL){
+        ControlTrouble(lab5ImageFail);
+    }
+    else{}
+    SchedInit(lab5TaskTable, (INT8U)LAB5_NUM_TASKS);
+    SchedRun();                                                                 /*time slice super loop, never returns*/
 }
 
-/* lab5ControlTask - has no parameters and returns nothing. Is meant to be used in a timeslice scheduler for lab5 security system control.
- * It will make appropriate state transitions based on sensors and keypad presses and control LED's and DAC0 output.
+/* lab5ControlTask - has no parameters and returns nothing. Is meant to be used in a timeslice scheduler for lab5
+ * security system control. It is released every 10ms from lab5TaskTable. A touched zone is posted first in every run so
+ * the siren and LEDs start at most one slice after TSI0 accepts the touch. Keypad presses are posted next, and faults
+ * and the tick that updates the LED's, LCD and DAC0 output when lab5TickTmr has run out, with the sensor flags of the
+ * runs since the last tick.
  * */
 static void lab5ControlTask(void){
-    static INT8U control_counter = 0;
     INT8C kchar;
     INT16U sense;
-    DB1_TURN_ON();
-    control_counter++;
-    if(control_counter>=5){                                                 //every 5 time slices (50ms)
-        control_counter = 0;
-        kchar = KeyGet();                                                   //key holds keys pressed
-        sense = TSIGetSensorFlags();                                        //sense holds which sensors pressed
-        switch(lab5CurrentState){
-            case ALARM:
-                if(kchar == DCODE){
-                    lab5WaveToggle = 0;
-                    lab5StateTransition(DISARMED, sense);
-                }
-                else{
-                    LEDSetState(sense);
-                    LEDSetPeriod(5);
-                    lab5WaveToggle++;
-                    if(lab5WaveToggle<=10){
-                        AlarmWaveSetMode(0);
-                    }
-                    else{
-                        AlarmWaveSetMode(1);
-                        if(lab5WaveToggle == 20){
-                            lab5WaveToggle = 0;
-                        }
-                        else{}
-                    }
-                }
-                break;
-            case ARMED:
-                if(kchar == DCODE){
-                    lab5StateTransition(DISARMED, sense);
-                }
-                else if(sense != TSI_BOTH_OFF){
-                    lab5StateTransition(ALARM, sense);
-                }
-                else{
-                    LEDSetState(TSI_BOTH_ON);
-                    LEDSetPeriod(25);
-                }
-                break;
-            case DISARMED:
-                if(kchar == ACODE){
-                    lab5StateTransition(ARMED, sense);
-                }
-                else{
-                    LEDSetState(sense);
-                    LEDSetPeriod(25);
-                }
-                break;
-            default:
-                break;
+    INT32U stamp;
+    static INT16U tick_sense = 0;
+    static INT32U lockouts = 0;
+    static INT8U flash_fault = 0;
+    sense = TSIGetSensorFlagsStamped(&stamp);                           //sense holds which sensors pressed
+    if((sense & CTL_INSTANT_ZONE) != 0){
+        lab5PostZone(CTL_EV_INSTANT, sense, stamp);
+    }
+    else{}
+    if((sense & CTL_DOOR_ZONE) != 0){
+        lab5PostZone(CTL_EV_DOOR, sense, stamp);
+    }
+    else{}
+    kchar = KeyGet();                                                   //key holds keys pressed
+    if(lab5PinCheck(kchar) != 0){                                       //valid PIN
+        (void)ControlPost(CTL_EV_PIN, sense);
+    }
+    else if(PinGetLockouts(&lab5Pin) != lockouts){                      //a new lockout, someone is guessing
+        lockouts = PinGetLockouts(&lab5Pin);
+        (void)ControlPost(CTL_EV_TAMPER, sense);
+    }
+    else{}
+    tick_sense |= sense;
+    if(TimerFired(&lab5TickTmr) != 0){                                  //CTL_TICK_MS since the last tick
+        if((FlashScanGetFault() != 0) && (flash_fault == 0)){           //background scan found a changed image
+            flash_fault = 1;                                            //once, so a PIN can acknowledge it
+            ControlTrouble(lab5FlashFault);
+        }
+        else{}
+        (void)ControlPost(CTL_EV_TICK, tick_sense);
+        tick_sense = 0;
+    }
+    else{}
+}
+
+/* lab5PostZone - takes a zone event, the sensor flags and their TSIGetSensorFlagsStamped() stamp, returns nothing.
+ * Posts the event and, if the controller reacted, records the cycles since the touch was accepted as
+ * PROF_ID_TOUCH and counts it in lab5TouchLate if it took longer than TOUCH_MAX_MS. The cycles are
+ * SysTickGetCycleStamp() differences as the core sleeps in WFI between the touch and the post.
+ * */
+static void lab5PostZone(CTL_EVENT event, INT16U sense, INT32U stamp){
+    INT32U cycles;
+    if(ControlPost(event, sense) != 0){
+        cycles = SysTickGetCycleStamp() - stamp;
+        ProfileRecord(PROF_ID_TOUCH, cycles);
+        if(cycles > (TOUCH_MAX_MS*1000U*CYCLES_PER_US)){
+            lab5TouchLate++;
+        }
+        else{}
+    }
+    else{}
+}
+
+/* lab5PinCheck - takes the key from KeyGet(), '\0' for none, and returns 1 if it completed a valid PIN.
+ * Feeds one key per call to the PIN engine. Wrong codes and lockouts are shown on row 2 and a duress code is
+ * reported over the serial port.
+ * */
+static INT8U lab5PinCheck(INT8C kchar){
+    PIN_RESULT status;
+    INT8U pin_ok = 0;
+    if(kchar != '\0'){
+        status = PinKey(&lab5Pin, kchar, SysTickGetmsCount());
+    }
+    else{
+        status = PinPoll(&lab5Pin, SysTickGetmsCount());
+    }
+    if(status == PIN_OK){
+        pin_ok = 1;
+    }
+    else if(status == PIN_DURESS){
+        pin_ok = 1;
+        BIOPutStrg(lab5PinDuress);
+        BIOOutDecWord(PinGetUser(&lab5Pin), 3, BIO_OD_MODE_AL);
+        BIOOutCRLF();
+    }
+    else if((status == PIN_BAD) || ((status == PIN_LOCKED) && (kchar != '\0'))){
+        LcdDispLineClear(LCD_ROW_2);
+        if(status == PIN_BAD){
+            LcdDispString((INT8C *const)lab5PinBad);
+        }
+        else{
+            LcdDispString((INT8C *const)lab5PinLocked);
         }
     }
     else{}
-    DB1_TURN_OFF();
+    return pin_ok;
+}
+
+/* lab5DiagTask - has no parameters and returns nothing. Is meant to be used in a timeslice scheduler. Dumps the
+ * profiling statistics, CPU load, slice overruns, serial and key overflows, PIN lockouts, worst touch latency over
+ * BasicIO when PCODE is received, or runs the CRC benchmark when CCODE is received. Both block while they are sent.
+ * */
+static void lab5DiagTask(void){
+    INT8C rxchar;
+    KEY_STATS_T keystats;
+    PROF_STATS_T touch;
+    rxchar = BIORead();
+    if(rxchar == PCODE){
+        ProfileDump();
+        BIOPutStrg("LOAD(0.1%) ");
+        BIOOutDecWord(SysTickGetCPULoad(), 4, BIO_OD_MODE_AL);
+        BIOPutStrg(" OVERRUNS ");
+        BIOOutDecWord(SysTickGetOverrunCount(), 10, BIO_OD_MODE_AL);
+        BIOPutStrg(" SCANS ");
+        BIOOutDecWord(FlashScanGetPasses(), 10, BIO_OD_MODE_AL);
+        BIOPutStrg(" TXOVF ");
+        BIOOutDecWord(BIOGetTxOverflows(), 10, BIO_OD_MODE_AL);
+        BIOPutStrg(" RXOVF ");
+        BIOOutDecWord(BIOGetRxOverflows(), 10, BIO_OD_MODE_AL);
+        KeyGetStats(&keystats);
+        BIOPutStrg(" KEYS ");
+        BIOOutDecWord(keystats.events, 10, BIO_OD_MODE_AL);
+        BIOPutStrg(" KEYOVF ");
+        BIOOutDecWord(keystats.overflows, 10, BIO_OD_MODE_AL);
+        BIOPutStrg(" KEYGHOST ");
+        BIOOutDecWord(keystats.ghosts, 10, BIO_OD_MODE_AL);
+        BIOPutStrg(" PINLOCK ");
+        BIOOutDecWord(PinGetLockouts(&lab5Pin), 10, BIO_OD_MODE_AL);
+        ProfileGetStats(PROF_ID_TOUCH, &touch);
+        BIOPutStrg(" TOUCHMAX(us) ");
+        BIOOutDecWord(touch.max/CYCLES_PER_US, 10, BIO_OD_MODE_AL);
+        BIOPutStrg(" TOUCHLATE ");
+        BIOOutDecWord(lab5TouchLate, 10, BIO_OD_MODE_AL);
+        BIOOutCRLF();
+    }
+    else if(rxchar == CCODE){
+        lab5CRCBench();
+    }
+    else{}
+}
+
+/* lab5CRCBench - has no parameters and returns nothing. CRC throughput benchmark. For each lab5CRCBenchList row times
+ * the byte, slice-by-4 and slice-by-8 software CRCs and the CRC module over the first CRC_BENCH_BYTES of the image and
+ * writes the cycles and whether the software and hardware CRCs match over BasicIO. Then times a byte at a time checksum
+ * and MemChkSum() over the same bytes, one byte in so the head and tail bytes are included. Leaves the CRC module in
+ * the last row's profile, MEM_CRC32.
+ * */
+static void lab5CRCBench(void){
+    IMAGE_RANGE_T image;
+    SOFT_CRC_T ctx;
+    INT32U cycles[4];
+    INT32U soft;
+    INT32U hard;
+    INT32U start;
+    const CRC_BENCH_T *bench;
+    INT8U b;
+    INT8U i;
+    ImageGetRange(&image);
+    BIOPutStrg("CRC BYTES ");
+    BIOOutDecWord(CRC_BENCH_BYTES, 5, BIO_OD_MODE_AL);
+    BIOPutStrg(" CYCLES: SW1 SW4 SW8 HW");
+    BIOOutCRLF();
+    for(b=0;b<(INT8U)(sizeof(lab5CRCBenchList)/sizeof(lab5CRCBenchList[0]));b++){
+        bench = &lab5CRCBenchList[b];
+        SoftCRCInit(&ctx, bench->soft);
+        start = ProfileStart();
+        SoftCRCUpdate1(&ctx, image.start, CRC_BENCH_BYTES);
+        cycles[0] = ProfileStart() - start;
+        SoftCRCInit(&ctx, bench->soft);
+        start = ProfileStart();
+        SoftCRCUpdate4(&ctx, image.start, CRC_BENCH_BYTES);
+        cycles[1] = ProfileStart() - start;
+        SoftCRCInit(&ctx, bench->soft);
+        start = ProfileStart();
+        SoftCRCUpdate(&ctx, image.start, CRC_BENCH_BYTES);
+        cycles[2] = ProfileStart() - start;
+        soft = SoftCRCResult(&ctx);
+        MemCRCInit(bench->hard);
+        start = ProfileStart();
+        MemCRCUpdate(image.start, image.start + (CRC_BENCH_BYTES - 1U));
+        cycles[3] = ProfileStart() - start;
+        hard = MemCRCResult();
+        BIOPutStrg(bench->name);
+        for(i=0;i<4;i++){
+            BIOWrite(' ');
+            BIOOutDecWord(cycles[i], 10, BIO_OD_MODE_AL);
+        }
+        BIOPutStrg((soft == hard) ? " MATCH" : " MISMATCH");
+        BIOOutCRLF();
+    }
+    start = ProfileStart();
+    soft = lab5ByteSum(image.start + 1U, image.start + CRC_BENCH_BYTES);
+    cycles[0] = ProfileStart() - start;
+    start = ProfileStart();
+    hard = MemChkSum((INT8U *)image.start + 1U, (INT8U *)image.start + CRC_BENCH_BYTES);
+    cycles[1] = ProfileStart() - start;
+    BIOPutStrg("CHKSUM CYCLES: BYTE ");
+    BIOOutDecWord(cycles[0], 10, BIO_OD_MODE_AL);
+    BIOPutStrg(" WORD ");
+    BIOOutDecWord(cycles[1], 10, BIO_OD_MODE_AL);
+    BIOPutStrg((soft == hard) ? " MATCH" : " MISMATCH");
+    BIOOutCRLF();
 }
 
-/* lab5StateTranisition takes a SECURE_STATES type and an INT16U as a parameter and returns nothing.
- *  Based on the state it will control LED's and DAC0 output based on special behaviour for switching states*/
-static void lab5StateTransition(SECURE_STATES state, INT16U sense){
-    switch(state){
-        case ALARM:
-            lab5CurrentState = ALARM;
-            LcdDispLineClear(LCD_ROW_1);
-            LcdDispString((INT8C *const)lab5Alarm);
-            LEDSetPeriod(0);
-            LEDSetState(sense);
-            AlarmWaveSetMode(0);
-            LEDInOffset(0);
-            break;
-        case ARMED:
-            lab5CurrentState = ARMED;
-            LcdDispLineClear(LCD_ROW_1);
-            LcdDispString((INT8C *const)lab5Armed);
-            LEDSetState(LED_OFFSET);
-            LEDSetPeriod(0);
-            AlarmWaveSetMode(1);
-            LEDInOffset(1);
-            break;
-        case DISARMED:
-            lab5CurrentState = DISARMED;
-            LcdDispLineClear(LCD_ROW_1);
-            LcdDispString((INT8C *const)lab5Disarmed);
-            LEDSetPeriod(0);
-            LEDSetState(sense);
-            AlarmWaveSetMode(1);
-            LEDInOffset(0);
-            break;
-        default:
-            break;
+/* lab5ByteSum - takes the first and last byte, returns their 16-bit sum. The byte loop MemChkSum() replaced, kept
+ * as the lab5CRCBench() reference.
+ * */
+static INT16U lab5ByteSum(const INT8U *start, const INT8U *end){
+    INT16U sum = 0;
+    while(start <= end){
+        sum = (INT16U)(sum + *start);
+        start++;
     }
+    return sum;
 }
@@ -10,21 +10,119 @@
 //Defines for CRC Config
 #define CRC_POLYNOMIAL 0x8005
 #define SEED 0x0000
+#define CRC32_POLYNOMIAL 0x04C11DB7U
+#define CRC32_SEED 0xFFFFFFFFU
+
+//Defines for the DMA fed CRC
+#define MEM_CRC_DMA_CH 1U                                   //Channel 0 is the alarm wave
+#define MEM_ALARM_DMA_CH 0U                                 //AlarmWave.c channel, swapped priority with MEM_CRC_DMA_CH
+#define MEM_CRC_DMA_SOURCE 61U                              //DMAMUX always enabled slot
+#define MEM_CRC_DMA_WORDS 16U                               //words per minor loop
+#define MEM_CRC_DMA_MAX_BURSTS 32767U                       //CITER limit with no channel linking
+
+//CRC module access. Can be defined on the command line to run the CRC functions against a model of the module
+#ifndef MEM_CRC
+#define MEM_CRC CRC0
+#define MEM_CRC_CLK_INIT() (SIM->SCGC6 |= SIM_SCGC6_CRC(1))
+#define MEM_CRC_WR8(b) (MEM_CRC->ACCESS8BIT.DATALL = (b))
+#define MEM_CRC_WR16L(h) (MEM_CRC->ACCESS16BIT.DATAL = (h))
+#define MEM_CRC_WR32(w) (MEM_CRC->DATA = (w))
+#define MEM_CRC_RD16H() (MEM_CRC->ACCESS16BIT.DATAH)
+#define MEM_CRC_RD32() (MEM_CRC->DATA)
+#endif
+
+//Private variables
+static MEM_CRC_PROFILE memCRCProfile = MEM_CRC16;
+static INT8U memCRCDMAReady = 0;
+static volatile INT8U memCRCDMABusy = 0;
+static const INT8U *memCRCDMANext;                          //first byte the DMA does not write
+static const INT8U *memCRCDMAEnd;
+
+//Private function prototypes
+static void memCRCDMAInit(void);
+
+//Adds the four bytes of a word to acc. USADA8 sums the absolute differences of each byte from 0
+#if (defined (__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1))
+#define MEM_SUM4(w, acc) __USADA8((w), 0U, (acc))
+#else
+#define MEM_SUM4(w, acc) ((acc) + ((w) & 0xFFU) + (((w) >> 8) & 0xFFU) + (((w) >> 16) & 0xFFU) + (((w) >> 24) & 0xFFU))
+#endif
 
 /* INT16U MemChkSum(INT8U *startaddr, INT8U *endaddr);
  *  Description: Computes the check sum for a specified block of memory
+ *               Bytes are read one at a time up to a word boundary, then aligned words are summed four bytes
+ *               at a time with USADA8, four words per loop, then the remaining bytes. The sum is kept in 32 bits
+ *               and truncated at the end, which gives the same result as a 16-bit byte by byte sum.
  *  Arguments: INT8U *startaddr - pointer to the address to begin the checksum
  *             INT8U *endaddr   - pointer to the address to end the checksum
  *  Return value: Returns an INT16U containing the checksum value of the specific block
  * */
 INT16U MemChkSum(INT8U *startaddr, INT8U *endaddr){
-    INT16U sum = 0;
-    while(startaddr<endaddr){
-        sum = sum + (INT16U)*startaddr;                 //Accumulate values at each address
+    INT32U sum = 0;
+    const INT32U *wptr;
+    INT32U nwords;
+    INT32U w0, w1, w2, w3;
+    while((startaddr<endaddr) && (((INT32U)startaddr & 0x3U) != 0)){       //Head bytes up to word alignment
+        sum = sum + (INT32U)*startaddr;
         startaddr++;
     }
-    sum = sum + (INT16U)*endaddr;                       //Avoid terminal count bug
-    return sum;
+    if(startaddr<endaddr){
+        nwords = (INT32U)(endaddr - startaddr) >> 2;
+        wptr = (const INT32U *)startaddr;
+        startaddr = startaddr + (nwords << 2);
+        while(nwords >= 4){                                 //Unrolled, loads are issued back to back
+            w0 = wptr[0];
+            w1 = wptr[1];
+            w2 = wptr[2];
+            w3 = wptr[3];
+            sum = MEM_SUM4(w0, sum);
+            sum = MEM_SUM4(w1, sum);
+            sum = MEM_SUM4(w2, sum);
+            sum = MEM_SUM4(w3, sum);
+            wptr += 4;
+            nwords -= 4;
+        }
+        while(nwords > 0){
+            w0 = *wptr;
+            sum = MEM_SUM4(w0, sum);
+            wptr++;
+            nwords--;
+        }
+    }
+    else{}
+    while(startaddr<endaddr){                               //Tail bytes
+        sum = sum + (INT32U)*startaddr;
+        startaddr++;
+    }
+    sum = sum + (INT32U)*endaddr;                           //Avoid terminal count bug
+    return (INT16U)sum;
+}
+
+/* void MemCRCInit(MEM_CRC_PROFILE profile)
+ * Description: Configures the CRC module for a profile and loads its seed. Both profiles transpose bits and bytes
+ *              on writes and reads so words can be written in the native little endian order, and complement
+ *              the result.
+ *              MEM_CRC16 - 16-bit, polynomial 0x8005, seed 0x0000 (the original MemCRCConfig() setup)
+ *              MEM_CRC32 - 32-bit, polynomial 0x04C11DB7, seed 0xFFFFFFFF (the zlib/Ethernet CRC-32)
+ * Arguments: MEM_CRC_PROFILE profile - the profile to use until the next MemCRCInit()
+ * Returns: none
+ * */
+void MemCRCInit(MEM_CRC_PROFILE profile){
+    MEM_CRC_CLK_INIT();
+    memCRCProfile = profile;
+    if(profile == MEM_CRC32){
+        MEM_CRC->CTRL = CRC_CTRL_TCRC(1) | CRC_CTRL_TOTR(2) | CRC_CTRL_TOT(2) | CRC_CTRL_FXOR(1);
+        MEM_CRC->GPOLY = CRC32_POLYNOMIAL;
+        MEM_CRC->CTRL |= CRC_CTRL_WAS(1);
+        MEM_CRC_WR32(CRC32_SEED);
+    }
+    else{
+        MEM_CRC->CTRL = CRC_CTRL_TCRC(0) | CRC_CTRL_TOTR(2) | CRC_CTRL_TOT(2) | CRC_CTRL_FXOR(1);
+        MEM_CRC->GPOLY_ACCESS16BIT.GPOLYL = CRC_GPOLY_LOW(CRC_POLYNOMIAL);
+        MEM_CRC->CTRL |= CRC_CTRL_WAS(1);
+        MEM_CRC_WR16L(CRC_DATAL_DATAL(SEED));
+    }
+    MEM_CRC->CTRL &= ~CRC_CTRL_WAS_MASK;                      //Back to data writes
 }
 
 /* void MemCRCConfig()
@@ -34,20 +132,65 @@ INT16U MemChkSum(INT8U *startaddr, INT8U *endaddr){
  * */
 
 void MemCRCConfig(void){
-    //Hopefully all is enabled correctly
-    SIM->SCGC6 |= SIM_SCGC6_CRC(1);
-    CRC0->CTRL = CRC0->CTRL | CRC_CTRL_TCRC(0);         //Enable 16 bit CRC mode
-    CRC0->CTRL = CRC0->CTRL | CRC_CTRL_TOTR(2) | CRC_CTRL_TOT(2) | CRC_CTRL_FXOR(1) ;      //program transpose and complement options
-    CRC0->GPOLY_ACCESS16BIT.GPOLYL = CRC_GPOLY_LOW(CRC_POLYNOMIAL);
-    CRC0->CTRL = CRC0->CTRL | CRC_CTRL_WAS(1);
-    CRC0->ACCESS16BIT.DATAL = CRC_DATAL_DATAL(SEED);
-    CRC0->CTRL = CRC0->CTRL & (0xFDFFFFFF);
-
+    MemCRCInit(MEM_CRC16);
 }
 
-//States for CRC writing
-typedef enum{HU,HL,LU,LL}WRITE_DEST;
+/* void MemCRCUpdate(const INT8U *startaddr, const INT8U *endaddr)
+ * Description: Adds a block of memory to the CRC in progress. Bytes are written one at a time up to a word
+ *              boundary, aligned words are written to DATA four per loop, then the remaining bytes.
+ *              Can be called repeatedly to CRC a range in pieces.
+ * Arguments: const INT8U *startaddr - pointer to the first byte
+ *            const INT8U *endaddr   - pointer to the last byte, included in the CRC
+ * Returns: none
+ * */
+void MemCRCUpdate(const INT8U *startaddr, const INT8U *endaddr){
+    const INT32U *wptr;
+    INT32U nwords;
+    while((startaddr<endaddr) && (((INT32U)startaddr & 0x3U) != 0)){       //Head bytes up to word alignment
+        MEM_CRC_WR8(*startaddr);
+        startaddr++;
+    }
+    if(startaddr<endaddr){
+        nwords = (INT32U)(endaddr - startaddr) >> 2;
+        wptr = (const INT32U *)startaddr;
+        startaddr = startaddr + (nwords << 2);
+        while(nwords >= 4){
+            MEM_CRC_WR32(wptr[0]);
+            MEM_CRC_WR32(wptr[1]);
+            MEM_CRC_WR32(wptr[2]);
+            MEM_CRC_WR32(wptr[3]);
+            wptr += 4;
+            nwords -= 4;
+        }
+        while(nwords > 0){
+            MEM_CRC_WR32(*wptr);
+            wptr++;
+            nwords--;
+        }
+    }
+    else{}
+    while(startaddr<endaddr){                               //Tail bytes
+        MEM_CRC_WR8(*startaddr);
+        startaddr++;
+    }
+    MEM_CRC_WR8(*endaddr);                                  //Avoid terminal count bug
+}
 
+/* INT32U MemCRCResult(void)
+ * Description: Reads the CRC of everything written since MemCRCInit(). Does not change the CRC in progress.
+ * Arguments: none
+ * Returns: The CRC16 in the low 16 bits for MEM_CRC16 or the CRC32 for MEM_CRC32. SoftCRC gives the same values.
+ * */
+INT32U MemCRCResult(void){
+    INT32U crc;
+    if(memCRCProfile == MEM_CRC32){
+        crc = MEM_CRC_RD32();
+    }
+    else{
+        crc = MEM_CRC_RD16H();                              //Byte transpose on read moves the CRC16 to the top half
+    }
+    return crc;
+}
 
 /* INT16U MemCRCGet(INT8U *startaddr, INT8U *endaddr)
  * Description: Runs CRC test for a given address on the CRC module
@@ -57,50 +200,106 @@ typedef enum{HU,HL,LU,LL}WRITE_DEST;
  * */
 
 INT16U MemCRCGet(INT8U *startaddr, INT8U *endaddr){
-    WRITE_DEST current_state = HU;                     //write to HU first
-    while(startaddr<endaddr){
-
-        switch(current_state){                         //write to different registers depending on state
-            case HU:
-                CRC0->ACCESS8BIT.DATAHU = *startaddr;
-                startaddr++;
-                current_state = HL;
-                break;
-            case HL:
-                CRC0->ACCESS8BIT.DATAHL = *startaddr;
-                startaddr++;
-                current_state = LU;
-                break;
-            case LU:
-                CRC0->ACCESS8BIT.DATALU = *startaddr;
-                startaddr++;
-                current_state = LL;
-                break;
-            case LL:
-                CRC0->ACCESS8BIT.DATALL = *startaddr;
-                startaddr++;
-                current_state = HU;
-                break;
-            default:
-                current_state = HU;
-                break;
+    MemCRCUpdate(startaddr, endaddr);
+    return (INT16U)MemCRCResult();
+}
+
+/* void MemCRCUpdateDMA(const INT8U *startaddr, const INT8U *endaddr)
+ * Description: Starts adding a block of memory to the CRC in progress with eDMA channel MEM_CRC_DMA_CH.
+ *              The head bytes are written here, then the DMA writes aligned words to DATA in bursts of
+ *              MEM_CRC_DMA_WORDS. Each burst is a minor loop so the audio channel can get the bus between
+ *              bursts. MemCRCDMADone() must be polled until it returns 1, it writes the words that did not
+ *              fill a burst and the tail bytes. The CRC module must not be used by anything else until then.
+ * Arguments: const INT8U *startaddr - pointer to the first byte
+ *            const INT8U *endaddr   - pointer to the last byte, included in the CRC
+ * Returns: none
+ * */
+void MemCRCUpdateDMA(const INT8U *startaddr, const INT8U *endaddr){
+    INT32U nbursts;
+    while((startaddr<endaddr) && (((INT32U)startaddr & 0x3U) != 0)){       //Head bytes up to word alignment
+        MEM_CRC_WR8(*startaddr);
+        startaddr++;
+    }
+    nbursts = 0;
+    if(startaddr<endaddr){
+        nbursts = ((INT32U)(endaddr - startaddr) >> 2) / MEM_CRC_DMA_WORDS;
+    }
+    else{}
+    if(nbursts > MEM_CRC_DMA_MAX_BURSTS){
+        nbursts = MEM_CRC_DMA_MAX_BURSTS;
+    }
+    else{}
+    memCRCDMANext = startaddr + (nbursts * MEM_CRC_DMA_WORDS * sizeof(INT32U));
+    memCRCDMAEnd = endaddr;
+    if(nbursts == 0){
+        memCRCDMABusy = 0;
+        MemCRCUpdate(memCRCDMANext, memCRCDMAEnd);
+    }
+    else{
+        memCRCDMAInit();
+        DMA0->TCD[MEM_CRC_DMA_CH].SADDR = (INT32U)startaddr;
+        DMA0->TCD[MEM_CRC_DMA_CH].CITER_ELINKNO = DMA_CITER_ELINKNO_CITER(nbursts);
+        DMA0->TCD[MEM_CRC_DMA_CH].BITER_ELINKNO = DMA_BITER_ELINKNO_BITER(nbursts);
+        DMA0->TCD[MEM_CRC_DMA_CH].CSR = DMA_CSR_DREQ(1);      //Request is cleared at the end of the major loop
+        memCRCDMABusy = 1;
+        DMA0->SERQ = DMA_SERQ_SERQ(MEM_CRC_DMA_CH);
+    }
+}
+
+/* INT8U MemCRCDMADone(void)
+ * Description: Checks a MemCRCUpdateDMA() in progress. When the DMA has finished it writes the rest of the block
+ *              so MemCRCResult() can be read.
+ * Arguments: none
+ * Returns: 1 when no DMA block is in progress, 0 while the DMA is still running
+ * */
+INT8U MemCRCDMADone(void){
+    INT8U done = 1;
+    if(memCRCDMABusy != 0){
+        if((DMA0->TCD[MEM_CRC_DMA_CH].CSR & DMA_CSR_DONE_MASK) != 0){
+            DMA0->CDNE = DMA_CDNE_CDNE(MEM_CRC_DMA_CH);
+            memCRCDMABusy = 0;
+            MemCRCUpdate(memCRCDMANext, memCRCDMAEnd);
+        }
+        else{
+            done = 0;
+        }
+    }
+    else{}
+    return done;
+}
+
+/* memCRCDMAInit()
+ * Configures eDMA channel MEM_CRC_DMA_CH the first time it is used. It is requested by an always enabled DMAMUX
+ * slot so it runs as fast as the bus allows. Channel priorities 0 and 1 are swapped so the alarm wave channel 0
+ * wins arbitration over the CRC. Every level in the group is in use from reset, so there is no free level to swap
+ * through. The alarm channel's request is held off instead while the two channels briefly share a level, eDMA
+ * flags a priority error if a channel starts then.
+ * */
+static void memCRCDMAInit(void){
+    INT32U alarm_erq;
+    if(memCRCDMAReady == 0){
+        SIM->SCGC6 |= SIM_SCGC6_DMAMUX(1);
+        SIM->SCGC7 |= SIM_SCGC7_DMA(1);
+        DMAMUX->CHCFG[MEM_CRC_DMA_CH] = 0;                                      //disable while configuring
+        DMA0->CERQ = DMA_CERQ_CERQ(MEM_CRC_DMA_CH);
+        alarm_erq = DMA0->ERQ & DMA_ERQ_ERQ0_MASK;
+        DMA0->CERQ = DMA_CERQ_CERQ(MEM_ALARM_DMA_CH);                           //no alarm request during the swap
+        DMA0->DCHPRI1 = DMA_DCHPRI1_CHPRI(0);
+        DMA0->DCHPRI0 = DMA_DCHPRI0_CHPRI(1);
+        if(alarm_erq != 0){
+            DMA0->SERQ = DMA_SERQ_SERQ(MEM_ALARM_DMA_CH);
         }
+        else{}
+        DMA0->TCD[MEM_CRC_DMA_CH].SOFF = sizeof(INT32U);
+        DMA0->TCD[MEM_CRC_DMA_CH].ATTR = DMA_ATTR_SSIZE(2) | DMA_ATTR_DSIZE(2);     //32-bit source and destination
+        DMA0->TCD[MEM_CRC_DMA_CH].NBYTES_MLNO = DMA_NBYTES_MLNO_NBYTES(MEM_CRC_DMA_WORDS * sizeof(INT32U));
+        DMA0->TCD[MEM_CRC_DMA_CH].SLAST = 0;
+        DMA0->TCD[MEM_CRC_DMA_CH].DADDR = (INT32U)&MEM_CRC->DATA;
+        DMA0->TCD[MEM_CRC_DMA_CH].DOFF = 0;
+        DMA0->TCD[MEM_CRC_DMA_CH].DLAST_SGA = 0;
+        DMA0->TCD[MEM_CRC_DMA_CH].CSR = 0;
+        DMAMUX->CHCFG[MEM_CRC_DMA_CH] = DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_SOURCE(MEM_CRC_DMA_SOURCE);
+        memCRCDMAReady = 1;
     }
-    switch(current_state){                             //Avoid terminal count bug
-        case HU:
-            CRC0->ACCESS8BIT.DATAHU = *startaddr;
-            break;
-        case HL:
-            CRC0->ACCESS8BIT.DATAHL = *startaddr;
-            break;
-        case LU:
-            CRC0->ACCESS8BIT.DATALU = *startaddr;
-            break;
-        case LL:
-            CRC0->ACCESS8BIT.DATALL = *startaddr;
-            break;
-        default:
-            break;
-    }
-    return CRC0->ACCESS16BIT.DATAL;
+    else{}
 }
@@ -7,6 +7,9 @@
 #ifndef MEMORYTOOLS_H_
 #define MEMORYTOOLS_H_
 
+//CRC module setups, see MemCRCInit()
+typedef enum{MEM_CRC16, MEM_CRC32}MEM_CRC_PROFILE;
+
 /* INT16U MemChkSum(INT8U *startaddr, INT8U *endaddr);
  *  Description: Computes the check sum for a specified block of memory
  *  Arguments: INT8U *startaddr - pointer to the address to begin the checksum
@@ -23,8 +26,53 @@ INT16U MemChkSum(INT8U *startaddr, INT8U *endaddr);
  * */
 void MemCRCConfig(void);
 
+/* void MemCRCInit(MEM_CRC_PROFILE profile)
+ * Description: Configures the CRC module for MEM_CRC16 (poly 0x8005, seed 0, same as MemCRCConfig()) or
+ *              MEM_CRC32 (poly 0x04C11DB7, seed 0xFFFFFFFF) and starts a new CRC
+ * Arguments: MEM_CRC_PROFILE profile - the CRC profile
+ * Returns: none
+ * */
+void MemCRCInit(MEM_CRC_PROFILE profile);
+
+/* void MemCRCUpdate(const INT8U *startaddr, const INT8U *endaddr)
+ * Description: Adds the bytes from startaddr to endaddr, inclusive, to the CRC in progress.
+ *              Aligned words are written 32 bits at a time
+ * Arguments: const INT8U *startaddr - pointer to the first byte
+ *            const INT8U *endaddr   - pointer to the last byte
+ * Returns: none
+ * */
+void MemCRCUpdate(const INT8U *startaddr, const INT8U *endaddr);
+
+/* INT32U MemCRCResult(void)
+ * Description: Reads the CRC in progress
+ * Arguments: none
+ * Returns: The CRC16 in the low 16 bits or the CRC32, depending on the profile
+ * */
+INT32U MemCRCResult(void);
+
+/* INT16U MemCRCGet(INT8U *startaddr, INT8U *endaddr)
+ * Description: Adds a block to the CRC in progress and returns the CRC16. Call MemCRCConfig() first.
+ * Arguments: INT8U *startaddr - pointer to the address to begin the CRC
+ *            INT8U *endaddr   - pointer to the address to end the CRC
+ * Return:    Returns the CRC16 an INT16U
+ * */
 INT16U MemCRCGet(INT8U *startaddr, INT8U *endaddr);
 
+/* void MemCRCUpdateDMA(const INT8U *startaddr, const INT8U *endaddr)
+ * Description: Same as MemCRCUpdate() but the bulk of the block is written to the CRC module by eDMA channel 1
+ *              so the CPU is free. Poll MemCRCDMADone() until it returns 1 before reading the result or
+ *              writing more data.
+ * Arguments: const INT8U *startaddr - pointer to the first byte
+ *            const INT8U *endaddr   - pointer to the last byte
+ * Returns: none
+ * */
+void MemCRCUpdateDMA(const INT8U *startaddr, const INT8U *endaddr);
 
+/* INT8U MemCRCDMADone(void)
+ * Description: Finishes a MemCRCUpdateDMA() block once the DMA is done
+ * Arguments: none
+ * Returns: 1 when the block is complete or none was started, 0 while the DMA is running
+ * */
+INT8U MemCRCDMADone(void);
 
 #endif
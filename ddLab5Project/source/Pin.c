@@ -0,0 +1,247 @@
+/* Pin.c
+ * PIN entry and verification. A code is checked by hashing the entered digits with the salt of every table entry
+ * and comparing the whole hash, so the time taken does not depend on which entry matched, how much of a hash
+ * matched or whether anything matched. SipHash-2-4 is a keyed 64-bit PRF that is short enough to run for a full
+ * table inside one control slice. Each failure after PIN_FREE_TRIES locks entry out for twice as long as the
+ * last one. A match clears the failures.
+ *
+ * Dominic Danis
+ * */
+
+#include "Pin.h"
+
+/*Device key, the second half of the SipHash key. Must match tools/PinHash.py*/
+#ifndef PIN_DEVICE_KEY
+#define PIN_DEVICE_KEY  0x6C35444464616E69ULL
+#endif
+
+#define PIN_ROTL(x, b)  (INT64U)(((x) << (b)) | ((x) >> (64U - (b))))
+
+/*Private function prototypes*/
+static PIN_RESULT pinCheck(PIN_T *pin, INT32U ms);
+static void pinClear(PIN_T *pin);
+static void pinSipRound(INT64U v[4]);
+static INT64U pinLoad(const INT8C *bytes, INT8U num);
+
+/* PinInit - takes a context and the code table, returns nothing.
+ * */
+void PinInit(PIN_T *pin, const PIN_CODE_T *codes, INT8U num_codes){
+    pin->codes = codes;
+    pin->num_codes = num_codes;
+    pin->user = 0;
+    pin->fails = 0;
+    pin->locked = 0;
+    pin->last_ms = 0;
+    pin->lock_until = 0;
+    pin->lockouts = 0;
+    pinClear(pin);
+}
+
+/* PinKey - takes a context, a key and the ms count, returns the entry status.
+ * */
+PIN_RESULT PinKey(PIN_T *pin, INT8C key, INT32U ms){
+    PIN_RESULT result = PinPoll(pin, ms);
+    if(result == PIN_LOCKED){
+        /*keys are ignored while locked*/
+    }
+    else if((key >= '0') && (key <= '9')){
+        if(pin->len < PIN_MAX_DIGITS){
+            pin->digits[pin->len] = key;
+            pin->len++;
+        }
+        else{
+            pin->overflow = 1;                          /*not dropped, the entry is not the code*/
+        }
+        pin->last_ms = ms;
+        result = PIN_ENTRY;
+    }
+    else if(key == PIN_KEY_CLEAR){
+        pinClear(pin);
+        result = PIN_IDLE;
+    }
+    else if((key == PIN_KEY_ENTER) && (pin->len != 0)){
+        result = pinCheck(pin, ms);
+    }
+    else{}
+    return result;
+}
+
+/* PinPoll - takes a context and the ms count, returns the entry status.
+ * */
+PIN_RESULT PinPoll(PIN_T *pin, INT32U ms){
+    PIN_RESULT result;
+    if((pin->locked != 0) && ((INT32S)(ms - pin->lock_until) >= 0)){
+        pin->locked = 0;
+    }
+    else{}
+    if(pin->locked != 0){
+        result = PIN_LOCKED;
+    }
+    else if(pin->len == 0){
+        result = PIN_IDLE;
+    }
+    else if((ms - pin->last_ms) >= PIN_DIGIT_TIMEOUT){
+        pinClear(pin);
+        result = PIN_TIMEOUT;
+    }
+    else{
+        result = PIN_ENTRY;
+    }
+    return result;
+}
+
+/* PinGetUser - takes a context, returns the user of the last match.
+ * */
+INT8U PinGetUser(const PIN_T *pin){
+    return pin->user;
+}
+
+/* PinGetLength - takes a context, returns the digits entered.
+ * */
+INT8U PinGetLength(const PIN_T *pin){
+    return pin->len;
+}
+
+/* PinGetLockouts - takes a context, returns the lockouts since PinInit().
+ * */
+INT32U PinGetLockouts(const PIN_T *pin){
+    return pin->lockouts;
+}
+
+/* PinHash - takes a salt, the digits, their number and a place for the hash. Returns nothing.
+ * Standard SipHash-2-4 with k0 = salt and k1 = PIN_DEVICE_KEY.
+ * */
+void PinHash(const INT32U salt[2], const INT8C *digits, INT8U len, INT32U hash[2]){
+    INT64U k0 = ((INT64U)salt[1] << 32) | salt[0];
+    INT64U k1 = PIN_DEVICE_KEY;
+    INT64U v[4];
+    INT64U m;
+    INT8U blk;
+    INT8U i;
+    v[0] = k0 ^ 0x736F6D6570736575ULL;
+    v[1] = k1 ^ 0x646F72616E646F6DULL;
+    v[2] = k0 ^ 0x6C7967656E657261ULL;
+    v[3] = k1 ^ 0x7465646279746573ULL;
+    for(blk = 0; (INT8U)(len - blk) >= 8U; blk = (INT8U)(blk + 8U)){     /*full 8 byte blocks*/
+        m = pinLoad(&digits[blk], 8U);
+        v[3] ^= m;
+        pinSipRound(v);
+        pinSipRound(v);
+        v[0] ^= m;
+    }
+    m = pinLoad(&digits[blk], (INT8U)(len - blk)) | ((INT64U)len << 56);   /*last block with the length*/
+    v[3] ^= m;
+    pinSipRound(v);
+    pinSipRound(v);
+    v[0] ^= m;
+    v[2] ^= 0xFFU;
+    for(i = 0; i < 4U; i++){
+        pinSipRound(v);
+    }
+    m = v[0] ^ v[1] ^ v[2] ^ v[3];
+    hash[0] = (INT32U)m;
+    hash[1] = (INT32U)(m >> 32);
+}
+
+/* pinCheck - private. Takes a context and the ms count, returns PIN_OK, PIN_DURESS, PIN_BAD or PIN_LOCKED.
+ * Every entry is hashed and compared with no early exit. A short or over-length code still runs the full table
+ * so its time matches any other.
+ * */
+static PIN_RESULT pinCheck(PIN_T *pin, INT32U ms){
+    PIN_RESULT result;
+    const PIN_CODE_T *code;
+    INT32U hash[2];
+    INT32U diff;
+    INT32U match;
+    INT32U found = 0;
+    INT32U user = 0;
+    INT32U flags = 0;
+    INT8U i;
+    for(i = 0; i < pin->num_codes; i++){
+        code = &pin->codes[i];
+        PinHash(code->salt, pin->digits, pin->len, hash);
+        diff = (hash[0] ^ code->hash[0]) | (hash[1] ^ code->hash[1]);
+        match = ((diff | (0U - diff)) >> 31) - 1U;      /*all ones if diff is 0, without a branch*/
+        match &= ~found;                                /*first match wins*/
+        found |= match;
+        user |= match & code->user;
+        flags |= match & code->flags;
+    }
+    if((pin->len < PIN_MIN_DIGITS) || (pin->overflow != 0)){
+        found = 0;
+    }
+    else{}
+    pinClear(pin);
+    if(found != 0){
+        pin->user = (INT8U)user;
+        pin->fails = 0;
+        if((flags & PIN_FLAG_DURESS) != 0){
+            result = PIN_DURESS;
+        }
+        else{
+            result = PIN_OK;
+        }
+    }
+    else{
+        if(pin->fails < 0xFFU){
+            pin->fails++;
+        }
+        else{}
+        if(pin->fails >= PIN_FREE_TRIES){
+            i = (INT8U)(pin->fails - PIN_FREE_TRIES);
+            if(i > PIN_LOCK_MAX_SHIFT){
+                i = PIN_LOCK_MAX_SHIFT;
+            }
+            else{}
+            pin->locked = 1;
+            pin->lock_until = ms + (PIN_LOCK_MS << i);
+            pin->lockouts++;
+            result = PIN_LOCKED;
+        }
+        else{
+            result = PIN_BAD;
+        }
+    }
+    return result;
+}
+
+/* pinClear - private. Takes a context, returns nothing. Wipes the entered digits.
+ * */
+static void pinClear(PIN_T *pin){
+    INT8U i;
+    for(i = 0; i < PIN_MAX_DIGITS; i++){
+        pin->digits[i] = 0;
+    }
+    pin->len = 0;
+    pin->overflow = 0;
+}
+
+/* pinSipRound - private. Takes the SipHash state, returns nothing. One SipRound.
+ * */
+static void pinSipRound(INT64U v[4]){
+    v[0] += v[1];
+    v[1] = PIN_ROTL(v[1], 13U);
+    v[1] ^= v[0];
+    v[0] = PIN_ROTL(v[0], 32U);
+    v[2] += v[3];
+    v[3] = PIN_ROTL(v[3], 16U);
+    v[3] ^= v[2];
+    v[0] += v[3];
+    v[3] = PIN_ROTL(v[3], 21U);
+    v[3] ^= v[0];
+    v[2] += v[1];
+    v[1] = PIN_ROTL(v[1], 17U);
+    v[1] ^= v[2];
+    v[2] = PIN_ROTL(v[2], 32U);
+}
+
+/* pinLoad - private. Takes up to 8 bytes and their number, returns them as a little endian word.
+ * */
+static INT64U pinLoad(const INT8C *bytes, INT8U num){
+    INT64U m = 0;
+    INT8U i;
+    for(i = 0; i < num; i++){
+        m |= (INT64U)(INT8U)bytes[i] << (8U * i);
+    }
+    return m;
+}
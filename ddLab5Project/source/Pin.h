@@ -0,0 +1,94 @@
+/* Pin.h - Header file for Pin.c - multi-digit PIN entry and verification.
+ * Collects digits one key at a time, checks the code against a table of salted SipHash-2-4 hashes in constant
+ * time and locks out further tries after repeated failures. The functions only work on the context passed to
+ * them and take the millisecond count as a parameter.
+ *
+ * Dominic Danis
+ * */
+#ifndef PIN_INC
+#define PIN_INC
+
+#include "MCUType.h"
+
+/*Defined constants*/
+#define PIN_MIN_DIGITS      4U                          /*shorter codes are rejected without a hash*/
+#define PIN_MAX_DIGITS      8U
+#define PIN_DIGIT_TIMEOUT   5000U                       /*ms between digits before the entry is dropped*/
+#define PIN_FREE_TRIES      3U                          /*failures before the first lockout*/
+#define PIN_LOCK_MS         30000U                      /*first lockout, doubles for each further failure*/
+#define PIN_LOCK_MAX_SHIFT  5U                          /*longest lockout is PIN_LOCK_MS << 5, 16 minutes*/
+#define PIN_KEY_ENTER       '#'
+#define PIN_KEY_CLEAR       '*'
+
+/*Code table flags*/
+#define PIN_FLAG_DURESS     0x01U                       /*accepted, but reported as PIN_DURESS*/
+
+/*One stored code. hash is SipHash-2-4 of the ASCII digits keyed with salt and the device key, made by
+ * tools/PinHash.py. Low word first*/
+typedef struct{
+    INT32U salt[2];
+    INT32U hash[2];
+    INT8U user;
+    INT8U flags;
+}PIN_CODE_T;
+
+/*Results of PinKey() and PinPoll()*/
+typedef enum{
+    PIN_IDLE,                                           /*nothing entered*/
+    PIN_ENTRY,                                          /*digits entered, waiting for more or PIN_KEY_ENTER*/
+    PIN_OK,                                             /*code matched, PinGetUser() has the user*/
+    PIN_DURESS,                                         /*duress code matched, PinGetUser() has the user*/
+    PIN_BAD,                                            /*code did not match*/
+    PIN_LOCKED,                                         /*too many failures, keys are ignored*/
+    PIN_TIMEOUT                                         /*entry dropped after PIN_DIGIT_TIMEOUT*/
+}PIN_RESULT;
+
+/*Entry context. Only changed through the Pin functions*/
+typedef struct{
+    const PIN_CODE_T *codes;
+    INT8U num_codes;
+    INT8C digits[PIN_MAX_DIGITS];
+    INT8U len;                                          /*digits entered*/
+    INT8U overflow;                                     /*1 if digits past PIN_MAX_DIGITS were entered*/
+    INT8U user;                                         /*user of the last match*/
+    INT8U fails;                                        /*failures since the last match*/
+    INT8U locked;
+    INT32U last_ms;                                     /*time of the last digit*/
+    INT32U lock_until;
+    INT32U lockouts;                                    /*lockouts since PinInit()*/
+}PIN_T;
+
+/* PinInit - takes a context and the code table, returns nothing. The table must stay valid.
+ * */
+void PinInit(PIN_T *pin, const PIN_CODE_T *codes, INT8U num_codes);
+
+/* PinKey - takes a context, a key code and the ms count, returns the entry status.
+ * Digits are collected up to PIN_MAX_DIGITS. An entry with more digits fails when checked and counts toward a
+ * lockout. PIN_KEY_CLEAR drops the entry and PIN_KEY_ENTER checks it. Other keys are ignored. Keys are ignored while locked. Call PinPoll() when there is no
+ * key so timeouts and lockouts end.
+ * */
+PIN_RESULT PinKey(PIN_T *pin, INT8C key, INT32U ms);
+
+/* PinPoll - takes a context and the ms count, returns PIN_TIMEOUT once when an entry is dropped, PIN_LOCKED
+ * while locked and otherwise PIN_IDLE or PIN_ENTRY.
+ * */
+PIN_RESULT PinPoll(PIN_T *pin, INT32U ms);
+
+/* PinGetUser - takes a context, returns the user of the last PIN_OK or PIN_DURESS.
+ * */
+INT8U PinGetUser(const PIN_T *pin);
+
+/* PinGetLength - takes a context, returns the number of digits entered so far, for a masked display.
+ * */
+INT8U PinGetLength(const PIN_T *pin);
+
+/* PinGetLockouts - takes a context, returns the number of lockouts since PinInit().
+ * */
+INT32U PinGetLockouts(const PIN_T *pin);
+
+/* PinHash - takes a salt, the digits and their number, and a place for the hash. Returns nothing.
+ * SipHash-2-4 of the digits keyed with the salt and the device key.
+ * */
+void PinHash(const INT32U salt[2], const INT8C *digits, INT8U len, INT32U hash[2]);
+
+#endif
@@ -0,0 +1,144 @@
+/* Profile.c
+ * Cycle accurate profiling of tasks and ISRs using the Cortex-M4 DWT cycle counter (CYCCNT). This replaces
+ * the debug bits and the logic analyzer for timing measurements. For each profile ID it keeps the number of
+ * samples, min, max, the sum for the mean and a log2 histogram in RAM. ProfileDump() writes them over BasicIO.
+ * At 180MHz CYCCNT wraps every ~23.8s so a single measurement must be shorter than that.
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "Profile.h"
+#include "BasicIO.h"
+
+/*The cycle counter source. Can be defined on the command line to use a fake clock*/
+#ifndef PROF_CYCCNT
+#define PROF_CYCCNT() (DWT->CYCCNT)
+#endif
+
+/*Private variables*/
+static PROF_STATS_T profStats[PROF_NUM_IDS];
+/*Private function prototypes*/
+static void profClear(PROF_STATS_T *stats);
+
+/* ProfileInit - no parameters or returns. Enables the DWT cycle counter and clears all statistics.
+ * */
+void ProfileInit(void){
+    INT8U i;
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;                            /*enable trace so DWT runs*/
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    for(i=0;i<PROF_NUM_IDS;i++){
+        profClear(&profStats[i]);
+    }
+}
+
+/* ProfileStart - no parameters, returns the current cycle count to be passed to ProfileStop()
+ * */
+INT32U ProfileStart(void){
+    return (INT32U)PROF_CYCCNT();
+}
+
+/* ProfileStop - takes a profile ID and the count returned by ProfileStart(), returns nothing.
+ * Unsigned subtraction handles a single counter wrap.
+ * */
+void ProfileStop(INT8U id, INT32U start){
+    ProfileRecord(id, (INT32U)PROF_CYCCNT() - start);
+}
+
+/* ProfileRecord - takes a profile ID and a number of cycles, returns nothing. Adds the sample to the statistics.
+ * */
+void ProfileRecord(INT8U id, INT32U cycles){
+    PROF_STATS_T *stats;
+    INT8U bin;
+    if(id < PROF_NUM_IDS){
+        stats = &profStats[id];
+        stats->count++;
+        stats->sum += cycles;
+        if(cycles < stats->min){
+            stats->min = cycles;
+        }
+        else{}
+        if(cycles > stats->max){
+            stats->max = cycles;
+        }
+        else{}
+        if(cycles == 0){
+            bin = 0;
+        }
+        else{
+            bin = (INT8U)(32U - __CLZ(cycles));                                 /*number of significant bits*/
+            if(bin >= PROF_NUM_BINS){
+                bin = PROF_NUM_BINS - 1U;
+            }
+            else{}
+        }
+        stats->hist[bin]++;
+    }
+    else{}
+}
+
+/* ProfileGetStats - takes a profile ID and a pointer to a PROF_STATS_T, returns nothing. Copies the statistics
+ * for id into *stats with interrupts masked so the copy is consistent.
+ * */
+void ProfileGetStats(INT8U id, PROF_STATS_T *stats){
+    INT32U primask;
+    if(id < PROF_NUM_IDS){
+        primask = __get_PRIMASK();
+        __disable_irq();
+        *stats = profStats[id];
+        __set_PRIMASK(primask);
+    }
+    else{
+        profClear(stats);
+    }
+}
+
+/* ProfileDump - no parameters or returns. Writes the statistics for every ID that has samples over BasicIO.
+ * One line per ID: id, count, min, max, mean, then bin:count for each non-empty histogram bin.
+ * */
+void ProfileDump(void){
+    PROF_STATS_T stats;
+    INT8U id;
+    INT8U bin;
+    BIOPutStrg("ID COUNT      MIN        MAX        MEAN       HIST(bin:count)");
+    BIOOutCRLF();
+    for(id=0;id<PROF_NUM_IDS;id++){
+        ProfileGetStats(id, &stats);
+        if(stats.count != 0){
+            BIOOutDecWord(id, 2, BIO_OD_MODE_AL);
+            BIOWrite(' ');
+            BIOOutDecWord(stats.count, 10, BIO_OD_MODE_AL);
+            BIOWrite(' ');
+            BIOOutDecWord(stats.min, 10, BIO_OD_MODE_AL);
+            BIOWrite(' ');
+            BIOOutDecWord(stats.max, 10, BIO_OD_MODE_AL);
+            BIOWrite(' ');
+            BIOOutDecWord((INT32U)(stats.sum/stats.count), 10, BIO_OD_MODE_AL);
+            for(bin=0;bin<PROF_NUM_BINS;bin++){
+                if(stats.hist[bin] != 0){
+                    BIOWrite(' ');
+                    BIOOutDecWord(bin, 2, BIO_OD_MODE_AL);
+                    BIOWrite(':');
+                    BIOOutDecWord(stats.hist[bin], 10, BIO_OD_MODE_AL);
+                }
+                else{}
+            }
+            BIOOutCRLF();
+        }
+        else{}
+    }
+}
+
+/* profClear - takes a pointer to a PROF_STATS_T and returns nothing. Resets it to no samples.
+ * */
+static void profClear(PROF_STATS_T *stats){
+    INT8U bin;
+    stats->count = 0;
+    stats->min = 0xFFFFFFFFU;
+    stats->max = 0;
+    stats->sum = 0;
+    for(bin=0;bin<PROF_NUM_BINS;bin++){
+        stats->hist[bin] = 0;
+    }
+}
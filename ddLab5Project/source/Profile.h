@@ -0,0 +1,58 @@
+/* Profile.h - Header file for Profile.c - cycle accurate execution time profiling with the DWT cycle counter.
+ * Keeps min, max, mean and a log2 histogram of cycles for each profile ID.
+ * CYCCNT stops while the core sleeps in WFI, see SysTickWaitEvent(), so a measurement that spans a sleep reads
+ * short by the time slept. Only profile code that runs without sleeping, or time it with SysTickGetCycleStamp()
+ * and pass the cycles to ProfileRecord().
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef PROFILE_INC
+#define PROFILE_INC
+
+/*Defined constants*/
+#define PROF_NUM_IDS    12U                     /*0-7 are scheduler tasks in table order*/
+#define PROF_NUM_BINS   32U                     /*bin n counts times in [2^(n-1), 2^n) cycles, bin 0 counts 0*/
+#define PROF_ID_SLICE   8U                      /*all tasks dispatched in one slice*/
+#define PROF_ID_DMA0    9U                      /*DMA0_DMA16_IRQHandler, DDS refill*/
+#define PROF_ID_TSI0    10U                     /*TSI0_IRQHandler*/
+#define PROF_ID_TOUCH   11U                     /*zone touch accepted by TSI0 to controller reaction, see Lab5Main.c*/
+
+/*Statistics for one profile ID*/
+typedef struct{
+    INT32U count;
+    INT32U min;
+    INT32U max;
+    INT64U sum;
+    INT32U hist[PROF_NUM_BINS];
+}PROF_STATS_T;
+
+/* ProfileInit - no parameters or returns. Enables the DWT cycle counter and clears all statistics.
+ * */
+void ProfileInit(void);
+
+/* ProfileStart - no parameters, returns the current cycle count to be passed to ProfileStop()
+ * */
+INT32U ProfileStart(void);
+
+/* ProfileStop - takes a profile ID and the count returned by ProfileStart(), returns nothing.
+ * Records the cycles between the two calls. Each ID must only be recorded from one context (task or ISR).
+ * */
+void ProfileStop(INT8U id, INT32U start);
+
+/* ProfileRecord - takes a profile ID and a number of cycles, returns nothing. Adds the sample to the statistics.
+ * Does not read the cycle counter.
+ * */
+void ProfileRecord(INT8U id, INT32U cycles);
+
+/* ProfileGetStats - takes a profile ID and a pointer to a PROF_STATS_T, returns nothing. Copies the statistics
+ * for id into *stats with interrupts masked so the copy is consistent.
+ * */
+void ProfileGetStats(INT8U id, PROF_STATS_T *stats);
+
+/* ProfileDump - no parameters or returns. Writes a table of count, min, max and mean cycles and the non-empty
+ * histogram bins for every ID that has samples over BasicIO. BIOOpen() must be called first. Blocks while writing.
+ * */
+void ProfileDump(void);
+
+#endif
@@ -0,0 +1,80 @@
+/* Scheduler.c
+ * A table driven cooperative timeslice scheduler. Tasks are described by a const table of SCHED_TASK_T
+ * entries holding the task function, its period, a phase offset and a priority. Each slice only the tasks
+ * that are due are called, so a task with a long period no longer has to count slices itself. Offsets are
+ * used to keep slower tasks from running in the same slice.
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "Scheduler.h"
+#include "SysTickDelay.h"
+#include "Profile.h"
+
+/*Private variables*/
+static const SCHED_TASK_T *schedTable = 0;
+static INT8U schedNumTasks = 0;
+static INT8U schedOrder[SCHED_MAX_TASKS];                                       /*table indexes sorted by priority*/
+static INT32U schedNextRelease[SCHED_MAX_TASKS];                                /*next release time in ms*/
+
+/* SchedInit - takes a pointer to a const task table and the number of entries, returns nothing.
+ * Must be called before SchedDispatch() or SchedRun(). Entries past SCHED_MAX_TASKS are ignored.
+ * Each task is first released at its offset.
+ * */
+void SchedInit(const SCHED_TASK_T *table, INT8U num_tasks){
+    INT8U i;
+    INT8U j;
+    INT8U idx;
+    if(num_tasks > SCHED_MAX_TASKS){
+        num_tasks = SCHED_MAX_TASKS;
+    }
+    else{}
+    schedTable = table;
+    schedNumTasks = num_tasks;
+    for(i=0;i<num_tasks;i++){                                                   /*insertion sort keeps table order for ties*/
+        idx = i;
+        j = i;
+        while((j > 0) && (table[schedOrder[j-1]].priority > table[idx].priority)){
+            schedOrder[j] = schedOrder[j-1];
+            j--;
+        }
+        schedOrder[j] = idx;
+        schedNextRelease[i] = table[i].offset;
+    }
+}
+
+/* SchedDispatch - takes the current millisecond count and returns nothing. Runs every task that is due at ms
+ * in priority order and schedules its next release. A task that missed releases runs only one time and
+ * its next release is moved to the first one after ms.
+ * */
+void SchedDispatch(INT32U ms){
+    INT8U i;
+    INT8U idx;
+    INT32U start;
+    for(i=0;i<schedNumTasks;i++){
+        idx = schedOrder[i];
+        if((INT32S)(ms - schedNextRelease[idx]) >= 0){                          /*due, signed difference handles wrap*/
+            start = ProfileStart();
+            schedTable[idx].task();
+            ProfileStop(idx, start);                                            /*profile ID is the table index*/
+            do{
+                schedNextRelease[idx] += schedTable[idx].period;
+            }while((INT32S)(ms - schedNextRelease[idx]) >= 0);
+        }
+        else{}
+    }
+}
+
+/* SchedRun - no parameters and never returns. The time slice super loop.
+ * The busy time of each slice is profiled as PROF_ID_SLICE.
+ * */
+void SchedRun(void){
+    INT32U start;
+    while(1){
+        SysTickWaitEvent(SCHED_SLICE_MS);
+        start = ProfileStart();
+        SchedDispatch(SysTickGetmsCount());
+        ProfileStop(PROF_ID_SLICE, start);
+    }
+}
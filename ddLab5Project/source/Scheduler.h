@@ -0,0 +1,43 @@
+/* Scheduler.h - Header file for Scheduler.c - a table driven cooperative timeslice scheduler.
+ * Each task is registered in a const SCHED_TASK_T table with a period, a phase offset and a priority.
+ * Only tasks that are due run in a slice.
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef SCHEDULER_INC
+#define SCHEDULER_INC
+
+/*Defined constants*/
+#define SCHED_SLICE_MS  10U                             /*time slice length in ms*/
+#define SCHED_MAX_TASKS 8U                              /*max number of entries in a task table, see PROF_ID_SLICE*/
+
+/*Task table entry. period and offset are in ms and should be multiples of SCHED_SLICE_MS. period must not be 0.
+ * priority 0 is the highest, due tasks are run highest priority first. Equal priorities run in table order*/
+typedef struct{
+    void (*task)(void);
+    INT16U period;
+    INT16U offset;
+    INT8U priority;
+}SCHED_TASK_T;
+
+/* SchedInit - takes a pointer to a const task table and the number of entries, returns nothing.
+ * Must be called before SchedDispatch() or SchedRun(). Entries past SCHED_MAX_TASKS are ignored.
+ * Each task is first released at its offset.
+ * */
+void SchedInit(const SCHED_TASK_T *table, INT8U num_tasks);
+
+/* SchedDispatch - takes the current millisecond count and returns nothing. Runs every task that is due at ms
+ * in priority order and schedules its next release. Each task is profiled with its table index as the profile
+ * ID. A task that missed releases runs only one time and its next release is moved to the first one after ms.
+ * The only hardware it reads is the DWT cycle counter through ProfileStart(). With PROF_CYCCNT defined to a fake
+ * clock for Profile.c it can be driven from a simulated millisecond counter.
+ * */
+void SchedDispatch(INT32U ms);
+
+/* SchedRun - no parameters and never returns. The time slice super loop. Waits for each SCHED_SLICE_MS slice
+ * with SysTickWaitEvent() then dispatches the due tasks.
+ * */
+void SchedRun(void);
+
+#endif
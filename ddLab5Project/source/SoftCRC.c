@@ -0,0 +1,126 @@
+/* SoftCRC.c
+ * Table driven software CRCs for the two CRC0 profiles. Used when the CRC module is busy with another block and
+ * on the host to precompute reference values. Both profiles transpose bits on write and read, so they are
+ * reflected CRCs and the state is shifted right. The tables are generated by tools/SoftCRCGen.py.
+ * Slice-by-8 reads two aligned words per loop and does eight table lookups, slice-by-4 one word and four.
+ * Words are loaded with the native byte order so this is only correct on little endian machines.
+ *
+ * Dominic Danis
+ * */
+
+#include "SoftCRC.h"
+
+/*Generated tables in SoftCRCTables.c, table k is the CRC of a byte followed by k zero bytes*/
+extern const INT32U softCRC16Table[SOFT_CRC_SLICES][256];
+extern const INT32U softCRC32Table[SOFT_CRC_SLICES][256];
+
+/*Private function prototypes*/
+static INT32U softCRCByte(const INT32U (*table)[256], INT32U crc, INT8U byte);
+
+/* SoftCRCInit - takes a CRC context and a profile, returns nothing.
+ * */
+void SoftCRCInit(SOFT_CRC_T *ctx, SOFT_CRC_PROFILE profile){
+    if(profile == SOFT_CRC32){
+        ctx->table = softCRC32Table;
+        ctx->crc = 0xFFFFFFFFU;
+        ctx->xorout = 0xFFFFFFFFU;
+    }
+    else{
+        ctx->table = softCRC16Table;
+        ctx->crc = 0x0000U;
+        ctx->xorout = 0xFFFFU;
+    }
+}
+
+/* SoftCRCUpdate - takes a CRC context, a pointer to the data and the number of bytes, returns nothing.
+ * Bytes are done one at a time up to a word boundary, then eight bytes per loop, then the remaining bytes.
+ * */
+void SoftCRCUpdate(SOFT_CRC_T *ctx, const INT8U *data, INT32U len){
+    const INT32U (*t)[256] = ctx->table;
+    INT32U crc = ctx->crc;
+    const INT32U *wptr;
+    INT32U lo;
+    INT32U hi;
+    while((len > 0) && (((INT32U)(uintptr_t)data & 0x3U) != 0)){
+        crc = softCRCByte(t, crc, *data);
+        data++;
+        len--;
+    }
+    wptr = (const INT32U *)(const void *)data;
+    while(len >= 8){
+        lo = crc ^ wptr[0];
+        hi = wptr[1];
+        crc = t[7][lo & 0xFFU] ^ t[6][(lo >> 8) & 0xFFU] ^ t[5][(lo >> 16) & 0xFFU] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFFU] ^ t[2][(hi >> 8) & 0xFFU] ^ t[1][(hi >> 16) & 0xFFU] ^ t[0][hi >> 24];
+        wptr += 2;
+        len -= 8;
+    }
+    data = (const INT8U *)wptr;
+    while(len > 0){
+        crc = softCRCByte(t, crc, *data);
+        data++;
+        len--;
+    }
+    ctx->crc = crc;
+}
+
+/* SoftCRCUpdate4 - takes a CRC context, a pointer to the data and the number of bytes, returns nothing.
+ * */
+void SoftCRCUpdate4(SOFT_CRC_T *ctx, const INT8U *data, INT32U len){
+    const INT32U (*t)[256] = ctx->table;
+    INT32U crc = ctx->crc;
+    const INT32U *wptr;
+    INT32U lo;
+    while((len > 0) && (((INT32U)(uintptr_t)data & 0x3U) != 0)){
+        crc = softCRCByte(t, crc, *data);
+        data++;
+        len--;
+    }
+    wptr = (const INT32U *)(const void *)data;
+    while(len >= 4){
+        lo = crc ^ *wptr;
+        crc = t[3][lo & 0xFFU] ^ t[2][(lo >> 8) & 0xFFU] ^ t[1][(lo >> 16) & 0xFFU] ^ t[0][lo >> 24];
+        wptr++;
+        len -= 4;
+    }
+    data = (const INT8U *)wptr;
+    while(len > 0){
+        crc = softCRCByte(t, crc, *data);
+        data++;
+        len--;
+    }
+    ctx->crc = crc;
+}
+
+/* SoftCRCUpdate1 - takes a CRC context, a pointer to the data and the number of bytes, returns nothing.
+ * */
+void SoftCRCUpdate1(SOFT_CRC_T *ctx, const INT8U *data, INT32U len){
+    INT32U crc = ctx->crc;
+    while(len > 0){
+        crc = softCRCByte(ctx->table, crc, *data);
+        data++;
+        len--;
+    }
+    ctx->crc = crc;
+}
+
+/* SoftCRCResult - takes a CRC context, returns the CRC of all the data so far.
+ * */
+INT32U SoftCRCResult(const SOFT_CRC_T *ctx){
+    return ctx->crc ^ ctx->xorout;
+}
+
+/* SoftCRCCompute - takes a profile, a pointer to the data and the number of bytes, returns the CRC of the data.
+ * */
+INT32U SoftCRCCompute(SOFT_CRC_PROFILE profile, const INT8U *data, INT32U len){
+    SOFT_CRC_T ctx;
+    SoftCRCInit(&ctx, profile);
+    SoftCRCUpdate(&ctx, data, len);
+    return SoftCRCResult(&ctx);
+}
+
+/* softCRCByte - takes a table set, the CRC state and a byte, returns the new state.
+ * */
+static INT32U softCRCByte(const INT32U (*table)[256], INT32U crc, INT8U byte){
+    return (crc >> 8) ^ table[0][(crc ^ byte) & 0xFFU];
+}
@@ -0,0 +1,52 @@
+/* SoftCRC.h - Header file for SoftCRC.c - table driven software CRCs that match the CRC0 profiles in
+ * MemoryTools bit for bit.
+ *
+ * Dominic Danis
+ * */
+#ifndef SOFTCRC_INC
+#define SOFTCRC_INC
+
+#include "MCUType.h"
+
+/*Defined constants*/
+#define SOFT_CRC_SLICES 8U                              /*tables in SoftCRCTables.c*/
+
+/*Profiles, in the same order as MEM_CRC_PROFILE
+ * SOFT_CRC16 - poly 0x8005, seed 0x0000, reflected in and out, result complemented (CRC-16/ARC ^ 0xFFFF)
+ * SOFT_CRC32 - poly 0x04C11DB7, seed 0xFFFFFFFF, reflected in and out, result complemented (zlib CRC-32)*/
+typedef enum{SOFT_CRC16, SOFT_CRC32}SOFT_CRC_PROFILE;
+
+/*CRC in progress*/
+typedef struct{
+    const INT32U (*table)[256];
+    INT32U crc;
+    INT32U xorout;
+}SOFT_CRC_T;
+
+/* SoftCRCInit - takes a CRC context and a profile, returns nothing. Starts a new CRC.
+ * */
+void SoftCRCInit(SOFT_CRC_T *ctx, SOFT_CRC_PROFILE profile);
+
+/* SoftCRCUpdate - takes a CRC context, a pointer to the data and the number of bytes, returns nothing.
+ * Adds the data to the CRC with slice-by-8. Can be called any number of times with any alignment.
+ * */
+void SoftCRCUpdate(SOFT_CRC_T *ctx, const INT8U *data, INT32U len);
+
+/* SoftCRCUpdate4 - same as SoftCRCUpdate() with slice-by-4. Uses half the table cache footprint.
+ * */
+void SoftCRCUpdate4(SOFT_CRC_T *ctx, const INT8U *data, INT32U len);
+
+/* SoftCRCUpdate1 - same as SoftCRCUpdate() one byte at a time. The reference for the sliced versions.
+ * */
+void SoftCRCUpdate1(SOFT_CRC_T *ctx, const INT8U *data, INT32U len);
+
+/* SoftCRCResult - takes a CRC context, returns the CRC of all the data so far. The CRC16 is in the low 16 bits.
+ * Does not change the CRC in progress.
+ * */
+INT32U SoftCRCResult(const SOFT_CRC_T *ctx);
+
+/* SoftCRCCompute - takes a profile, a pointer to the data and the number of bytes, returns the CRC of the data.
+ * */
+INT32U SoftCRCCompute(SOFT_CRC_PROFILE profile, const INT8U *data, INT32U len);
+
+#endif
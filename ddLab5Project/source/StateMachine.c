@@ -0,0 +1,76 @@
+/* StateMachine.c
+ * Table driven state machine dispatcher. The cell for an event is table[state * num_events + event], so every
+ * dispatch costs the same no matter how many states there are. Side effects live in short action functions that
+ * are shared between cells, so adding a state is a new table row and its entry and exit lists.
+ *
+ * Dominic Danis
+ * */
+
+#include "StateMachine.h"
+
+/*Private function prototypes*/
+static void smRun(const SM_ACTION *actions, void *ctx);
+
+/* SmInit - takes a machine, its description, the first state and a context, returns nothing.
+ * */
+void SmInit(SM_T *sm, const SM_DEF_T *def, INT8U state, void *ctx){
+    sm->def = def;
+    sm->ctx = ctx;
+    sm->state = state;
+    sm->transitions = 0;
+    sm->ignored = 0;
+    sm->dispatching = 1;
+    smRun(def->states[state].entry, ctx);
+    sm->dispatching = 0;
+}
+
+/* SmDispatch - takes a machine and an event, returns 1 if it was handled.
+ * */
+INT8U SmDispatch(SM_T *sm, INT8U event){
+    const SM_DEF_T *def = sm->def;
+    const SM_TRANS_T *cell;
+    INT8U handled = 0;
+    if((event < def->num_events) && (sm->dispatching == 0)){
+        cell = &def->table[(sm->state * def->num_events) + event];
+        if((cell->next != SM_IGNORE) && ((cell->guard == 0) || (cell->guard(sm->ctx) != 0))){
+            handled = 1;
+            sm->dispatching = 1;
+            if(cell->next == SM_STAY){
+                smRun(cell->actions, sm->ctx);
+            }
+            else{
+                smRun(def->states[sm->state].exit, sm->ctx);
+                smRun(cell->actions, sm->ctx);
+                sm->state = cell->next;
+                sm->transitions++;
+                smRun(def->states[sm->state].entry, sm->ctx);
+            }
+            sm->dispatching = 0;
+        }
+        else{}
+    }
+    else{}
+    if(handled == 0){
+        sm->ignored++;
+    }
+    else{}
+    return handled;
+}
+
+/* SmGetState - takes a machine, returns its state.
+ * */
+INT8U SmGetState(const SM_T *sm){
+    return sm->state;
+}
+
+/* smRun - private. Takes a 0 terminated action list, or 0, and the context. Returns nothing.
+ * */
+static void smRun(const SM_ACTION *actions, void *ctx){
+    if(actions != 0){
+        while(*actions != 0){
+            (*actions)(ctx);
+            actions++;
+        }
+    }
+    else{}
+}
@@ -0,0 +1,67 @@
+/* StateMachine.h - Header file for StateMachine.c - a table driven state machine dispatcher.
+ * A machine is described by const tables: a transition cell for every state and event pair, and entry and exit
+ * action lists for every state. Dispatching an event is one table lookup.
+ *
+ * Dominic Danis
+ * */
+#ifndef STATE_MACHINE_INC
+#define STATE_MACHINE_INC
+
+#include "MCUType.h"
+
+/*Special next states in a transition cell*/
+#define SM_IGNORE   0xFFU                               /*event is ignored in this state*/
+#define SM_STAY     0xFEU                               /*internal transition, actions run without exit or entry*/
+
+/*Guards and actions get the context passed to SmInit(). A guard returns 0 to block the transition*/
+typedef INT8U (*SM_GUARD)(void *ctx);
+typedef void (*SM_ACTION)(void *ctx);
+
+/*Transition cell. guard can be 0 for none. actions is a 0 terminated list, or 0 for none*/
+typedef struct{
+    SM_GUARD guard;
+    const SM_ACTION *actions;
+    INT8U next;                                         /*next state, SM_STAY or SM_IGNORE*/
+}SM_TRANS_T;
+
+/*Per state action lists, 0 terminated, or 0 for none*/
+typedef struct{
+    const SM_ACTION *entry;
+    const SM_ACTION *exit;
+}SM_STATE_T;
+
+/*Machine description. table has num_states rows of num_events cells*/
+typedef struct{
+    const SM_TRANS_T *table;
+    const SM_STATE_T *states;
+    INT8U num_states;
+    INT8U num_events;
+}SM_DEF_T;
+
+/*Running machine. Only changed through the StateMachine functions*/
+typedef struct{
+    const SM_DEF_T *def;
+    void *ctx;
+    INT8U state;
+    INT8U dispatching;                                  /*1 while actions run, see SmDispatch()*/
+    INT32U transitions;                                 /*state changes since SmInit()*/
+    INT32U ignored;                                     /*events ignored or blocked by a guard*/
+}SM_T;
+
+/* SmInit - takes a machine, its description, the first state and the context for guards and actions. Returns
+ * nothing. Runs the entry actions of the first state.
+ * */
+void SmInit(SM_T *sm, const SM_DEF_T *def, INT8U state, void *ctx);
+
+/* SmDispatch - takes a machine and an event, returns 1 if the event was handled or 0 if it was ignored.
+ * For a state change the exit actions of the old state run, then the transition actions, then the entry actions
+ * of the new state. Events out of range are ignored. Actions must not call SmDispatch() on the same machine,
+ * such an event is ignored.
+ * */
+INT8U SmDispatch(SM_T *sm, INT8U event);
+
+/* SmGetState - takes a machine, returns its current state.
+ * */
+INT8U SmGetState(const SM_T *sm);
+
+#endif
@@ -0,0 +1,212 @@
+/* Timer.c
+ * Hierarchical timing wheel. Level 0 has a slot for each of the next TMR_SLOTS ticks, level 1 a slot for each
+ * of the next TMR_SLOTS level 0 turns and level 2 the same for level 1. A timer goes in the lowest level that
+ * reaches its expiry. When a level 0 turn ends the next level 1 slot is moved down to level 0, and the same for
+ * level 2, so each timer is moved at most twice. Expiry ticks are 32-bit and only differences are compared,
+ * so the tick count wraps freely.
+ *
+ * Each slot is a circular list with a sentinel link, so a timer can be unlinked without knowing its slot.
+ *
+ * Dominic Danis
+ * */
+
+#include "MCUType.h"
+#include "Timer.h"
+#include "SysTickDelay.h"
+
+#define TMR_SLOT_MASK   (TMR_SLOTS - 1U)
+
+/*Private variables*/
+static TMR_LINK_T tmrSlots[TMR_LEVELS][TMR_SLOTS];
+static INT32U tmrNow;                                   /*last tick processed*/
+static INT32U tmrLastms;                                /*ms count of tmrNow*/
+static INT32U tmrExpiries;
+
+/*Private function prototypes*/
+static void tmrAdd(TMR_T *tmr);
+static void tmrUnlink(TMR_LINK_T *link);
+static void tmrCascade(INT8U level, INT32U slot);
+static INT32U tmrTicks(INT32U ms);
+
+/* TimerInit - takes the current ms count, returns nothing.
+ * */
+void TimerInit(INT32U ms){
+    INT8U level;
+    INT8U slot;
+    for(level = 0; level < TMR_LEVELS; level++){
+        for(slot = 0; slot < TMR_SLOTS; slot++){
+            tmrSlots[level][slot].next = &tmrSlots[level][slot];
+            tmrSlots[level][slot].prev = &tmrSlots[level][slot];
+        }
+    }
+    tmrNow = ms / TMR_TICK_MS;
+    tmrLastms = ms;
+    tmrExpiries = 0;
+}
+
+/* TimerSetup - takes a timer, a callback and its argument, returns nothing.
+ * */
+void TimerSetup(TMR_T *tmr, TMR_CALLBACK callback, void *arg){
+    tmr->link.next = 0;
+    tmr->link.prev = 0;
+    tmr->expires = 0;
+    tmr->period = 0;
+    tmr->callback = callback;
+    tmr->arg = arg;
+    tmr->fired = 0;
+}
+
+/* TimerStart - takes a timer, a delay and a period in ms, returns nothing.
+ * */
+void TimerStart(TMR_T *tmr, INT32U delay_ms, INT32U period_ms){
+    TimerStop(tmr);
+    if(period_ms == 0){
+        tmr->period = 0;
+    }
+    else{
+        tmr->period = tmrTicks(period_ms);
+    }
+    tmr->expires = tmrNow + tmrTicks(delay_ms);
+    tmrAdd(tmr);
+}
+
+/* TimerStop - takes a timer, returns nothing.
+ * */
+void TimerStop(TMR_T *tmr){
+    if(tmr->link.next != 0){
+        tmrUnlink(&tmr->link);
+    }
+    else{}
+}
+
+/* TimerActive - takes a timer, returns 1 if it is running.
+ * */
+INT8U TimerActive(const TMR_T *tmr){
+    return (INT8U)(tmr->link.next != 0);
+}
+
+/* TimerFired - takes a timer, returns and clears its expiry count.
+ * */
+INT8U TimerFired(TMR_T *tmr){
+    INT8U fired = tmr->fired;
+    tmr->fired = 0;
+    return fired;
+}
+
+/* TimerRun - takes the current ms count, returns nothing.
+ * Each tick the higher levels are cascaded first so a timer moved down for this tick is run with it. The due
+ * slot is moved to a local list before any callback runs, so a timer a callback starts for the next turn is not
+ * run again in this tick.
+ * */
+void TimerRun(INT32U ms){
+    TMR_LINK_T due;
+    TMR_LINK_T *slot;
+    TMR_T *tmr;
+    while((ms - tmrLastms) >= TMR_TICK_MS){
+        tmrLastms += TMR_TICK_MS;
+        tmrNow++;
+        if((tmrNow & TMR_SLOT_MASK) == 0){
+            if(((tmrNow >> TMR_SLOT_BITS) & TMR_SLOT_MASK) == 0){
+                tmrCascade(2U, (tmrNow >> (2U * TMR_SLOT_BITS)) & TMR_SLOT_MASK);
+            }
+            else{}
+            tmrCascade(1U, (tmrNow >> TMR_SLOT_BITS) & TMR_SLOT_MASK);
+        }
+        else{}
+        slot = &tmrSlots[0][tmrNow & TMR_SLOT_MASK];
+        if(slot->next != slot){
+            due.next = slot->next;                      /*move the whole slot to due*/
+            due.prev = slot->prev;
+            due.next->prev = &due;
+            due.prev->next = &due;
+            slot->next = slot;
+            slot->prev = slot;
+            while(due.next != &due){
+                tmr = (TMR_T *)(void *)due.next;
+                tmrUnlink(&tmr->link);
+                if(tmr->period != 0){
+                    tmr->expires += tmr->period;        /*no drift, relative to the expiry*/
+                    tmrAdd(tmr);
+                }
+                else{}
+                tmrExpiries++;
+                if(tmr->callback != 0){
+                    tmr->callback(tmr->arg);
+                }
+                else if(tmr->fired < 0xFFU){
+                    tmr->fired++;
+                }
+                else{}
+            }
+        }
+        else{}
+    }
+}
+
+/* TimerTask - no parameters and returns nothing.
+ * */
+void TimerTask(void){
+    TimerRun(SysTickGetmsCount());
+}
+
+/* TimerGetExpiries - no parameters, returns the expiry count.
+ * */
+INT32U TimerGetExpiries(void){
+    return tmrExpiries;
+}
+
+/* tmrAdd - private. Takes a stopped timer with expires set no more than TMR_MAX_TICKS ahead, returns nothing.
+ * Links it at the end of the slot for its expiry in the lowest level that reaches it.
+ * */
+static void tmrAdd(TMR_T *tmr){
+    INT32U delta = tmr->expires - tmrNow;
+    TMR_LINK_T *slot;
+    if(delta < TMR_SLOTS){                              /*0 when a cascade moves a timer due this tick*/
+        slot = &tmrSlots[0][tmr->expires & TMR_SLOT_MASK];
+    }
+    else if(delta < (TMR_SLOTS * TMR_SLOTS)){
+        slot = &tmrSlots[1][(tmr->expires >> TMR_SLOT_BITS) & TMR_SLOT_MASK];
+    }
+    else{
+        slot = &tmrSlots[2][(tmr->expires >> (2U * TMR_SLOT_BITS)) & TMR_SLOT_MASK];
+    }
+    tmr->link.next = slot;
+    tmr->link.prev = slot->prev;
+    slot->prev->next = &tmr->link;
+    slot->prev = &tmr->link;
+}
+
+/* tmrUnlink - private. Takes a linked timer, returns nothing. Unlinks it and marks it stopped.
+ * */
+static void tmrUnlink(TMR_LINK_T *link){
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->next = 0;
+    link->prev = 0;
+}
+
+/* tmrCascade - private. Takes a level and slot, returns nothing. Moves the timers in it to lower levels.
+ * */
+static void tmrCascade(INT8U level, INT32U slot){
+    TMR_LINK_T *head = &tmrSlots[level][slot];
+    TMR_T *tmr;
+    while(head->next != head){
+        tmr = (TMR_T *)(void *)head->next;
+        tmrUnlink(&tmr->link);
+        tmrAdd(tmr);
+    }
+}
+
+/* tmrTicks - private. Takes a time in ms, returns it in ticks rounded up, from 1 to TMR_MAX_TICKS.
+ * */
+static INT32U tmrTicks(INT32U ms){
+    INT32U ticks = (ms / TMR_TICK_MS) + (((ms % TMR_TICK_MS) != 0) ? 1U : 0U);
+    if(ticks == 0){
+        ticks = 1U;
+    }
+    else if(ticks > TMR_MAX_TICKS){
+        ticks = TMR_MAX_TICKS;
+    }
+    else{}
+    return ticks;
+}
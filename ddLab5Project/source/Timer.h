@@ -0,0 +1,81 @@
+/* Timer.h - Header file for Timer.c - software timers on a hierarchical timing wheel.
+ * Timers are owned by the caller and linked into the wheel while they run, so starting, stopping and expiring a
+ * timer are all constant time however many are running. A timer either calls a callback or counts expiries for
+ * TimerFired(). Resolution is one TMR_TICK_MS tick.
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#ifndef TIMER_INC
+#define TIMER_INC
+
+/*Defined constants*/
+#ifndef TMR_TICK_MS
+#define TMR_TICK_MS     10U                             /*one scheduler slice*/
+#endif
+#define TMR_SLOT_BITS   6U
+#define TMR_SLOTS       (1U << TMR_SLOT_BITS)           /*slots per level*/
+#define TMR_LEVELS      3U
+#define TMR_MAX_TICKS   ((1UL << (TMR_SLOT_BITS * TMR_LEVELS)) - 1UL)  /*longer delays are cut to this, 43 min*/
+
+typedef void (*TMR_CALLBACK)(void *arg);
+
+/*List link, a timer is on a list only while it runs*/
+typedef struct TMR_LINK{
+    struct TMR_LINK *next;
+    struct TMR_LINK *prev;
+}TMR_LINK_T;
+
+/*A timer. Only changed through the Timer functions*/
+typedef struct{
+    TMR_LINK_T link;                                    /*must be first*/
+    INT32U expires;                                     /*tick it runs out on*/
+    INT32U period;                                      /*ticks, 0 for one shot*/
+    TMR_CALLBACK callback;                              /*0 to only count expiries*/
+    void *arg;
+    INT8U fired;                                        /*expiries not yet read by TimerFired()*/
+}TMR_T;
+
+/* TimerInit - takes the current ms count, returns nothing. Empties the wheel. Timers that were running must not
+ * be used again without TimerSetup().
+ * */
+void TimerInit(INT32U ms);
+
+/* TimerSetup - takes a timer, a callback, or 0, and the argument for it. Returns nothing. Leaves the timer
+ * stopped. Must be called once before the timer is started.
+ * */
+void TimerSetup(TMR_T *tmr, TMR_CALLBACK callback, void *arg);
+
+/* TimerStart - takes a timer, the delay and the period in ms, returns nothing. A period of 0 is a one shot.
+ * Times are rounded up to whole ticks, at least one. A running timer is restarted.
+ * */
+void TimerStart(TMR_T *tmr, INT32U delay_ms, INT32U period_ms);
+
+/* TimerStop - takes a timer, returns nothing. Does nothing if it is not running.
+ * */
+void TimerStop(TMR_T *tmr);
+
+/* TimerActive - takes a timer, returns 1 if it is running.
+ * */
+INT8U TimerActive(const TMR_T *tmr);
+
+/* TimerFired - takes a timer, returns the number of expiries since the last call and clears it.
+ * */
+INT8U TimerFired(TMR_T *tmr);
+
+/* TimerRun - takes the current ms count, returns nothing. Advances the wheel one tick at a time up to ms and
+ * expires the timers that are due, earlier ticks first. Callbacks can start and stop any timer. Does not touch
+ * any hardware so it can be driven from a simulated millisecond counter.
+ * */
+void TimerRun(INT32U ms);
+
+/* TimerTask - no parameters and returns nothing. Runs TimerRun() with the SysTick ms count. Is meant to be used
+ * in a timeslice scheduler every TMR_TICK_MS.
+ * */
+void TimerTask(void);
+
+/* TimerGetExpiries - no parameters, returns the number of timer expiries since TimerInit().
+ * */
+INT32U TimerGetExpiries(void);
+
+#endif
@@ -0,0 +1,22 @@
+/* AlarmSim.h - Header file for the eDMA, DMAMUX and DAC0 mocks in AlarmWaveTest.c.
+ * AlarmWave.c is built unmodified with this header and CoreSim.h forced in. The macros below put its registers
+ * in mock structures and stub out the clock gates and the PIT. The test is linked at a fixed address below 4GB
+ * so the 32-bit TCD addresses are real host pointers.
+ *
+ * Dominic Danis
+ * */
+#ifndef ALARM_SIM_INC
+#define ALARM_SIM_INC
+
+/*AlarmWave.c hooks*/
+#define ALARM_DMA           (&AlarmSimDma)
+#define ALARM_DMAMUX        (&AlarmSimDmamux)
+#define ALARM_DAC           (&AlarmSimDac)
+#define ALARM_CLK_INIT()    ((void)0)
+#define ALARM_PIT_INIT()    ((void)0)
+
+extern DMA_Type AlarmSimDma;
+extern DMAMUX_Type AlarmSimDmamux;
+extern DAC_Type AlarmSimDac;
+
+#endif
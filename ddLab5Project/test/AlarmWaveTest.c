@@ -0,0 +1,272 @@
+/* AlarmWaveTest.c
+ * Host test of the DMA setup in source/AlarmWave.c. The test replays eDMA channel 0 as the hardware would run it
+ * on each PIT trigger: one 16-bit read at SADDR written to DADDR, SADDR stepped by SOFF, CITER counted down, the
+ * half and major loop interrupts raised through CoreSim, and at the end of the major loop SADDR rewound by SLAST
+ * and CITER reloaded from BITER. The DAC0 samples that come out are checked against the sine table for the
+ * looping sine and against a second DDS engine for tones and sweeps, which also checks that the interrupt always
+ * refills the half that is not playing.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "MCUType.h"
+#include "AlarmWave.h"
+#include "DDS.h"
+#include "Profile.h"
+#include "CoreSim.h"
+#include "AlarmSim.h"
+#include "TestUtil.h"
+
+#define OUT_LEN     (2U*DDS_BLOCK_LEN*120U)             /*DAC samples kept*/
+#define SINE_LEN    64U
+#define REQ_NONE    0xFFU                               /*SERQ and CERQ value while not written*/
+
+void DMA0_DMA16_IRQHandler(void);
+
+DMA_Type AlarmSimDma;
+DMAMUX_Type AlarmSimDmamux;
+DAC_Type AlarmSimDac;
+
+static INT8U dmaReq;                                    /*channel 0 request enabled*/
+static INT16U dmaOut[OUT_LEN];                          /*DAC0 after each trigger*/
+static INT32U dmaOutLen;
+static INT32U dmaIrqs;                                  /*half and major loop interrupts raised*/
+static INT32U dmaIrqsOff;                               /*raised while the NVIC had the interrupt disabled*/
+static INT32U dmaProfiles;                              /*PROF_ID_DMA0 samples, one per ISR run*/
+static INT16U sineTable[SINE_LEN];                      /*the table as played by the DMA*/
+
+static DDS_T ref;                                       /*reference engine*/
+static INT16U refOut[OUT_LEN];
+static INT32U refLen;
+
+/*Profile.c stubs*/
+INT32U ProfileStart(void){
+    return 0;
+}
+void ProfileStop(INT8U id, INT32U start){
+    (void)start;
+    if(id == PROF_ID_DMA0){
+        dmaProfiles++;
+    }else{}
+}
+
+/* dacValue - no parameters, returns the value in DAC0 DAT0.
+ * */
+static INT16U dacValue(void){
+    return *(volatile INT16U *)&AlarmSimDac.DAT[0].DATL;
+}
+
+/* dmaSync - no parameters and returns nothing. Called after each AlarmWave call to pick up request enable and
+ * disable writes. A set after a clear in the same call leaves the request enabled.
+ * */
+static void dmaSync(void){
+    if(AlarmSimDma.SERQ != REQ_NONE){
+        CHECK(AlarmSimDma.SERQ == 0U);
+        dmaReq = 1U;
+    }else if(AlarmSimDma.CERQ != REQ_NONE){
+        CHECK(AlarmSimDma.CERQ == 0U);
+        dmaReq = 0;
+    }else{}
+    AlarmSimDma.SERQ = REQ_NONE;
+    AlarmSimDma.CERQ = REQ_NONE;
+}
+
+/* dmaIrq - no parameters and returns nothing. Raises the channel 0 interrupt.
+ * */
+static void dmaIrq(void){
+    dmaIrqs++;
+    if(CoreSimIrqEnabled(DMA0_DMA16_IRQn) == 0){
+        dmaIrqsOff++;
+    }else{}
+    CoreSimPend(DMA0_DMA16_IRQHandler);
+}
+
+/* dmaTrigger - takes a number of PIT triggers and returns nothing. Runs one minor loop per trigger while the
+ * request is enabled and logs DAC0 after each trigger.
+ * */
+static void dmaTrigger(INT32U n){
+    volatile INT16U *src;
+    volatile INT16U *dst;
+    INT16U citer;
+    INT16U biter;
+    while(n != 0){
+        if(dmaReq != 0){
+            src = (volatile INT16U *)(uintptr_t)AlarmSimDma.TCD[0].SADDR;
+            dst = (volatile INT16U *)(uintptr_t)AlarmSimDma.TCD[0].DADDR;
+            *dst = *src;
+            AlarmSimDma.TCD[0].SADDR += (INT32U)(INT32S)(INT16S)AlarmSimDma.TCD[0].SOFF;
+            AlarmSimDma.TCD[0].DADDR += (INT32U)(INT32S)(INT16S)AlarmSimDma.TCD[0].DOFF;
+            citer = (INT16U)((AlarmSimDma.TCD[0].CITER_ELINKNO & DMA_CITER_ELINKNO_CITER_MASK) - 1U);
+            biter = (INT16U)(AlarmSimDma.TCD[0].BITER_ELINKNO & DMA_BITER_ELINKNO_BITER_MASK);
+            if(citer == 0){                                 /*end of the major loop*/
+                AlarmSimDma.TCD[0].SADDR += AlarmSimDma.TCD[0].SLAST;
+                AlarmSimDma.TCD[0].DADDR += AlarmSimDma.TCD[0].DLAST_SGA;
+                AlarmSimDma.TCD[0].CITER_ELINKNO = biter;
+                if((AlarmSimDma.TCD[0].CSR & DMA_CSR_INTMAJOR_MASK) != 0){
+                    dmaIrq();
+                }else{}
+            }else{
+                AlarmSimDma.TCD[0].CITER_ELINKNO = citer;
+                if(((AlarmSimDma.TCD[0].CSR & DMA_CSR_INTHALF_MASK) != 0) && (citer == (biter/2U))){
+                    dmaIrq();
+                }else{}
+            }
+        }else{}
+        if(dmaOutLen < OUT_LEN){
+            dmaOut[dmaOutLen] = dacValue();
+            dmaOutLen++;
+        }else{}
+        n--;
+    }
+}
+
+/* refRender - takes a number of blocks and returns nothing. Renders them from the reference engine into refOut.
+ * */
+static void refRender(INT32U blocks){
+    while((blocks != 0) && ((refLen + DDS_BLOCK_LEN) <= OUT_LEN)){
+        DDSRender(&ref, &refOut[refLen], DDS_BLOCK_LEN);
+        refLen += DDS_BLOCK_LEN;
+        blocks--;
+    }
+}
+
+/* sameOut - takes the first output sample to compare and a count, returns 1 if dmaOut matches refOut.
+ * */
+static int sameOut(INT32U from, INT32U n){
+    INT32U i;
+    for(i = 0; i < n; i++){
+        if(dmaOut[from + i] != refOut[i]){
+            printf("  sample %u: DAC %u, expected %u\n", i, dmaOut[from + i], refOut[i]);
+            return 0;
+        }else{}
+    }
+    return 1;
+}
+
+static void testInit(void){
+    CoreSimReset();
+    memset(&AlarmSimDma, 0, sizeof(AlarmSimDma));
+    memset(&AlarmSimDmamux, 0, sizeof(AlarmSimDmamux));
+    memset(&AlarmSimDac, 0, sizeof(AlarmSimDac));
+    AlarmSimDma.SERQ = REQ_NONE;
+    AlarmSimDma.CERQ = REQ_NONE;
+    CHECK((uintptr_t)(INT32U)(uintptr_t)&AlarmSimDac == (uintptr_t)&AlarmSimDac);
+    AlarmWaveInit();
+    dmaSync();
+    CHECK(dmaReq == 0);
+    CHECK(AlarmSimDac.C0 == (DAC_C0_DACTRGSEL(1) | DAC_C0_DACEN(1) | DAC_C0_DACRFS(1)));
+    CHECK(dacValue() == 2047U);
+    CHECK(AlarmSimDmamux.CHCFG[0] == (DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_TRIG(1) | DMAMUX_CHCFG_SOURCE(60)));
+    CHECK(AlarmSimDma.TCD[0].SOFF == 2U);
+    CHECK(AlarmSimDma.TCD[0].ATTR == (DMA_ATTR_SSIZE(1) | DMA_ATTR_DSIZE(1)));
+    CHECK(AlarmSimDma.TCD[0].NBYTES_MLNO == 2U);
+    CHECK(AlarmSimDma.TCD[0].DADDR == (INT32U)(uintptr_t)&AlarmSimDac.DAT[0].DATL);
+    CHECK(AlarmSimDma.TCD[0].DOFF == 0);
+    CHECK(AlarmSimDma.TCD[0].DLAST_SGA == 0);
+    dmaTrigger(10U);                                    /*no request, DC stays*/
+    CHECK((dmaOut[0] == 2047U) && (dmaOut[9] == 2047U));
+}
+
+/* testSine - the table plays from its first entry, rewinds at the end of the major loop with no interrupts,
+ * keeps going when selected again, holds DC when stopped, and restarts from the first entry.
+ * */
+static void testSine(void){
+    INT32U i;
+    int same = 1;
+    dmaOutLen = 0;
+    AlarmWaveSetMode(0);
+    dmaSync();
+    CHECK(dmaReq == 1U);
+    CHECK(AlarmSimDma.TCD[0].SLAST == (INT32U)(-(INT32S)(SINE_LEN*2U)));
+    CHECK(AlarmSimDma.TCD[0].CITER_ELINKNO == SINE_LEN);
+    CHECK(AlarmSimDma.TCD[0].BITER_ELINKNO == SINE_LEN);
+    CHECK(AlarmSimDma.TCD[0].CSR == 0);
+    dmaTrigger(3U*SINE_LEN + 10U);
+    memcpy(sineTable, dmaOut, sizeof(sineTable));
+    CHECK((sineTable[0] == 2047U) && (sineTable[16] == 4095U) && (sineTable[32] == 2047U) && (sineTable[48] == 0));
+    for(i = 0; i < dmaOutLen; i++){
+        if(dmaOut[i] != sineTable[i % SINE_LEN]){
+            same = 0;
+        }else{}
+    }
+    CHECK(same);
+    CHECK(dmaIrqs == 0);
+    AlarmWaveSetMode(0);                                /*already playing, not restarted*/
+    dmaSync();
+    dmaTrigger(1U);
+    CHECK(dmaOut[dmaOutLen - 1U] == sineTable[(dmaOutLen - 1U) % SINE_LEN]);
+    AlarmWaveSetMode(1);
+    dmaSync();
+    CHECK(dmaReq == 0);
+    CHECK(dacValue() == 2047U);
+    dmaOutLen = 0;
+    dmaTrigger(5U);
+    CHECK((dmaOut[0] == 2047U) && (dmaOut[4] == 2047U));
+    AlarmWaveSetMode(0);
+    dmaSync();
+    dmaOutLen = 0;
+    dmaTrigger(3U);
+    CHECK((dmaOut[0] == sineTable[0]) && (dmaOut[1] == sineTable[1]) && (dmaOut[2] == sineTable[2]));
+    AlarmWaveSetMode(1);
+    dmaSync();
+}
+
+/* testSynth - DDS tones and sweeps played from the ping-pong buffer match a reference engine sample for sample,
+ * including a tone change while playing. The reference is kept at the same number of rendered blocks as the
+ * engine in AlarmWave.c, which has rendered none since AlarmWaveInit().
+ * */
+static void testSynth(void){
+    INT32U blocks;
+    DDSInit(&ref, sineTable);
+    refLen = 0;
+    dmaOutLen = 0;
+    dmaIrqs = 0;
+    dmaProfiles = 0;
+    AlarmWaveSetTone(1000U);
+    dmaSync();
+    DDSSetTone(&ref, 1000U);
+    CHECK(dmaReq == 1U);
+    CHECK(CoreSimIrqEnabled(DMA0_DMA16_IRQn) == 1U);
+    CHECK(AlarmSimDma.TCD[0].CSR == (DMA_CSR_INTHALF(1) | DMA_CSR_INTMAJOR(1)));
+    CHECK(AlarmSimDma.TCD[0].SLAST == (INT32U)(-(INT32S)(4U*DDS_BLOCK_LEN)));
+    refRender(2U);
+    dmaTrigger(40U*DDS_BLOCK_LEN);
+    CHECK(dmaIrqs == 40U);
+    CHECK(dmaProfiles == 40U);
+    CHECK(dmaIrqsOff == 0);
+    AlarmWaveSetTone(2500U);                            /*change while playing*/
+    dmaSync();
+    CHECK(AlarmSimDma.SERQ == REQ_NONE);
+    CHECK(CoreSimIrqEnabled(DMA0_DMA16_IRQn) == 1U);
+    refRender(40U);                                     /*2 + 40 blocks rendered by AlarmWave.c so far*/
+    DDSSetTone(&ref, 2500U);
+    dmaTrigger(30U*DDS_BLOCK_LEN);
+    refRender(30U);
+    CHECK(dmaOutLen == (70U*DDS_BLOCK_LEN));
+    CHECK(sameOut(0, dmaOutLen));
+    blocks = 2U + dmaIrqs;
+    AlarmWaveSetMode(1);
+    dmaSync();
+    CHECK(dmaReq == 0);
+    CHECK(CoreSimIrqEnabled(DMA0_DMA16_IRQn) == 0);
+    CHECK(blocks == 72U);                               /*the reference has rendered as many*/
+    refLen = 0;
+    dmaOutLen = 0;
+    dmaIrqs = 0;
+    AlarmWaveSweep(500U, 3000U, 100U, DDS_SWEEP_EXP);
+    dmaSync();
+    DDSSweep(&ref, 500U, 3000U, 100U, DDS_SWEEP_EXP);
+    refRender(2U + 100U);
+    dmaTrigger(100U*DDS_BLOCK_LEN);
+    CHECK(dmaIrqs == 100U);
+    CHECK(sameOut(0, dmaOutLen));
+}
+
+int main(void){
+    testInit();
+    testSine();
+    testSynth();
+    return TestDone("AlarmWaveTest");
+}
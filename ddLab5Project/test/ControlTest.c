@@ -0,0 +1,206 @@
+/* ControlTest.c
+ * Host replay of event sequences through source/Control.c, StateMachine.c and Timer.c. The LED, LCD and
+ * AlarmWave calls are stubs that record what was last shown. Time advances one TMR_TICK_MS slice at a time with
+ * TimerRun() and CTL_EV_TICK is posted every CTL_TICK_MS, as Lab5Main.c does. The state name is written by the
+ * tick after a transition, so row 1 is checked after a tick.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <string.h>
+#include "MCUType.h"
+#include "Control.h"
+#include "Timer.h"
+#include "LCD.h"
+#include "TestUtil.h"
+
+#define SIREN_ON        0U                              /*AlarmWaveSetMode() values*/
+#define SIREN_OFF       1U
+#define TICK_SLICES     (CTL_TICK_MS/TMR_TICK_MS)
+#define MS_SLICES(ms)   ((ms)/TMR_TICK_MS)
+
+static INT32U ms;
+static INT32U slice;
+static INT8U siren;
+static INT16U ledState;
+static INT8U ledPeriod;
+static INT8U lcdRow;
+static char lcdText[2][17];
+
+/*Stubs*/
+INT32U SysTickGetmsCount(void){
+    return ms;
+}
+void LEDSetState(INT16U state){
+    ledState = state;
+}
+void LEDSetPeriod(INT8U period){
+    ledPeriod = period;
+}
+void LEDInOffset(INT8U offset){
+    (void)offset;
+}
+void AlarmWaveSetMode(INT8U mode){
+    siren = mode;
+}
+void LcdDispLineClear(const INT8U line){
+    lcdRow = (INT8U)(line - 1U);
+    lcdText[lcdRow][0] = '\0';
+}
+void LcdDispString(INT8C *const strg){
+    strncat(lcdText[lcdRow], strg, 16U - strlen(lcdText[lcdRow]));
+}
+
+/* run - advances n slices with the sensor flags held, posting CTL_EV_TICK every CTL_TICK_MS.
+ * */
+static void run(INT32U n, INT16U sense){
+    while(n > 0U){
+        ms += TMR_TICK_MS;
+        slice++;
+        TimerRun(ms);
+        if((slice % TICK_SLICES) == 0U){
+            (void)ControlPost(CTL_EV_TICK, sense);
+        }else{}
+        n--;
+    }
+}
+
+/* tick - runs up to and including the next CTL_EV_TICK.
+ * */
+static void tick(INT16U sense){
+    do{
+        run(1U, sense);
+    }while((slice % TICK_SLICES) != 0U);
+}
+
+/* expectState - checks the state and, after a tick, that row 1 shows it.
+ * */
+static void expectState(CTL_STATE state, const char *name){
+    CHECK(ControlGetState() == state);
+    tick(TSI_BOTH_OFF);
+    if(!CHECK(strcmp(lcdText[0], name) == 0)){
+        printf("  row 1 [%s], want [%s]\n", lcdText[0], name);
+    }else{}
+}
+
+static void testArming(void){
+    INT32U start;
+    CHECK(ControlPost(CTL_EV_PIN, CTL_INSTANT_ZONE) == 0U);    /*zone touched, arming refused*/
+    CHECK(ControlGetState() == CTL_DISARMED);
+    CHECK(ControlPost(CTL_EV_PIN, TSI_BOTH_OFF) == 1U);
+    start = slice;
+    CHECK(ControlGetState() == CTL_EXIT_DELAY);
+    CHECK(strcmp(lcdText[0], "DISARMED") == 0);         /*the name waits for the tick*/
+    tick(TSI_BOTH_OFF);
+    CHECK(strcmp(lcdText[0], "EXIT DELAY") == 0);
+    CHECK(ledPeriod == 10U);
+    CHECK(ControlPost(CTL_EV_DOOR, CTL_DOOR_ZONE) == 0U);      /*walking out*/
+    CHECK(ControlPost(CTL_EV_INSTANT, CTL_INSTANT_ZONE) == 0U);
+    run(start + MS_SLICES(CTL_EXIT_DELAY_MS) - 1U - slice, TSI_BOTH_OFF);
+    CHECK(ControlGetState() == CTL_EXIT_DELAY);
+    run(1U, TSI_BOTH_OFF);
+    expectState(CTL_ARMED, "ARMED");
+    CHECK(siren == SIREN_OFF);
+}
+
+static void testEntry(void){
+    /*Disarmed inside the entry delay, the delay is cancelled*/
+    CHECK(ControlPost(CTL_EV_DOOR, CTL_DOOR_ZONE) == 1U);
+    CHECK(ControlGetState() == CTL_ENTRY_DELAY);
+    run(MS_SLICES(CTL_ENTRY_DELAY_MS) - 1U, TSI_BOTH_OFF);
+    CHECK(ControlPost(CTL_EV_PIN, TSI_BOTH_OFF) == 1U);
+    run(MS_SLICES(CTL_ENTRY_DELAY_MS) * 2U, TSI_BOTH_OFF);
+    expectState(CTL_DISARMED, "DISARMED");
+    CHECK(ledState == TSI_BOTH_OFF);
+    CHECK(ledPeriod == 25U);
+    /*Entry delay runs out*/
+    (void)ControlPost(CTL_EV_PIN, TSI_BOTH_OFF);
+    run(MS_SLICES(CTL_EXIT_DELAY_MS), TSI_BOTH_OFF);
+    CHECK(ControlGetState() == CTL_ARMED);
+    (void)ControlPost(CTL_EV_DOOR, CTL_DOOR_ZONE);
+    run(MS_SLICES(CTL_ENTRY_DELAY_MS) - 1U, TSI_BOTH_OFF);
+    CHECK(ControlGetState() == CTL_ENTRY_DELAY);
+    CHECK(siren == SIREN_OFF);
+    run(1U, TSI_BOTH_OFF);
+    CHECK(ControlGetState() == CTL_ALARM);
+    CHECK(siren == SIREN_ON);
+}
+
+/* testSiren - warble every CTL_WARBLE_MS in Control.c, 500ms, then silence after CTL_SIREN_LIMIT_MS with the
+ * state kept.
+ * */
+static void testSiren(void){
+    INT32U i;
+    INT32U on = 0;
+    INT32U changes = 0;
+    INT8U last = siren;
+    for(i = 0; i < MS_SLICES(10000U); i++){
+        run(1U, TSI_BOTH_OFF);
+        on += (siren == SIREN_ON);
+        changes += (siren != last);
+        last = siren;
+    }
+    CHECK(on == (MS_SLICES(10000U) / 2U));
+    CHECK(changes == 20U);
+    run(MS_SLICES(CTL_SIREN_LIMIT_MS - 10000U) - 1U, TSI_BOTH_OFF);
+    CHECK(ControlGetState() == CTL_ALARM);
+    run(1U, TSI_BOTH_OFF);
+    CHECK(siren == SIREN_OFF);
+    run(MS_SLICES(10000U), TSI_BOTH_OFF);
+    CHECK(siren == SIREN_OFF);                          /*the warble is stopped too*/
+    expectState(CTL_ALARM, "ALARM");
+    CHECK(ControlPost(CTL_EV_PIN, TSI_BOTH_OFF) == 1U);
+    expectState(CTL_DISARMED, "DISARMED");
+    CHECK(siren == SIREN_OFF);
+}
+
+static void testInstantTamperTrouble(void){
+    (void)ControlPost(CTL_EV_PIN, TSI_BOTH_OFF);
+    run(MS_SLICES(CTL_EXIT_DELAY_MS), TSI_BOTH_OFF);
+    CHECK(ControlPost(CTL_EV_INSTANT, CTL_INSTANT_ZONE) == 1U);
+    CHECK(ControlGetState() == CTL_ALARM);
+    CHECK(siren == SIREN_ON);
+    CHECK(ledState == CTL_INSTANT_ZONE);                /*LEDs set on entry, before the tick*/
+    CHECK(ControlPost(CTL_EV_TAMPER, TSI_BOTH_OFF) == 0U);
+    (void)ControlPost(CTL_EV_PIN, TSI_BOTH_OFF);
+    CHECK(ControlPost(CTL_EV_TAMPER, TSI_BOTH_OFF) == 1U);
+    expectState(CTL_TAMPER, "TAMPER");
+    CHECK(siren == SIREN_ON);
+    (void)ControlPost(CTL_EV_PIN, TSI_BOTH_OFF);
+    expectState(CTL_DISARMED, "DISARMED");
+
+    ControlTrouble("FLASH FAULT");
+    CHECK(ControlGetState() == CTL_TROUBLE);
+    CHECK(strcmp(lcdText[1], "FLASH FAULT") == 0);
+    expectState(CTL_TROUBLE, "TROUBLE");
+    CHECK(ControlPost(CTL_EV_DOOR, CTL_DOOR_ZONE) == 0U);
+    run(MS_SLICES(60000U), TSI_BOTH_OFF);
+    CHECK(ControlGetState() == CTL_TROUBLE);            /*stays until a PIN*/
+    (void)ControlPost(CTL_EV_PIN, TSI_BOTH_OFF);
+    expectState(CTL_DISARMED, "DISARMED");
+    run(MS_SLICES(60000U), TSI_BOTH_OFF);
+    CHECK(ControlGetState() == CTL_DISARMED);           /*acknowledged*/
+
+    /*A trouble while arming is shown but keeps the exit delay*/
+    (void)ControlPost(CTL_EV_PIN, TSI_BOTH_OFF);
+    ControlTrouble("X");
+    CHECK(ControlGetState() == CTL_EXIT_DELAY);
+    CHECK(strcmp(lcdText[1], "X") == 0);
+    CHECK(ControlPost(CTL_NUM_EVENTS, TSI_BOTH_OFF) == 0U);
+    CHECK(ControlGetState() == CTL_EXIT_DELAY);
+}
+
+int main(void){
+    ms = 0;
+    slice = 0;
+    TimerInit(ms);
+    ControlInit();
+    CHECK(siren == SIREN_OFF);                          /*entry action, the name waits for the first tick*/
+    CHECK(lcdText[0][0] == '\0');
+    expectState(CTL_DISARMED, "DISARMED");
+    testArming();
+    testEntry();
+    testSiren();
+    testInstantTamperTrouble();
+    return TestDone("ControlTest");
+}
@@ -0,0 +1,140 @@
+/* CoreSim.c
+ * Host stand-in for the Cortex-M4 core peripherals and intrinsics, see CoreSim.h. An interrupt handler is made
+ * pending with CoreSimPend() and runs as soon as PRIMASK allows. WFI wakes on a pending handler even with PRIMASK
+ * set, as on the target, and otherwise asks the test to advance its simulated time through the idle hook.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <string.h>
+#include "MCUType.h"
+#include "CoreSim.h"
+
+DWT_Type CoreSimDwt;
+CoreDebug_Type CoreSimCoreDebug;
+SysTick_Type CoreSimSysTick;
+SCB_Type CoreSimScb;
+
+static INT32U csPrimask;
+static void (*csPending[CORE_SIM_MAX_IRQ])(void);
+static INT8U csNumPending;
+static INT8U csRunning;                                 /*1 while the pending handlers are being run*/
+static void (*csIdleHook)(void);
+static INT32U csWfiCount;
+static INT32U csDeadSleeps;
+static INT8U csIrqOn[CORE_SIM_NUM_IRQN];               /*NVIC enables*/
+
+static void csRunPending(void);
+
+void CoreSimReset(void){
+    memset(&CoreSimDwt, 0, sizeof(CoreSimDwt));
+    memset(&CoreSimCoreDebug, 0, sizeof(CoreSimCoreDebug));
+    memset(&CoreSimSysTick, 0, sizeof(CoreSimSysTick));
+    memset(&CoreSimScb, 0, sizeof(CoreSimScb));
+    csPrimask = 0;
+    csNumPending = 0;
+    csRunning = 0;
+    csIdleHook = 0;
+    csWfiCount = 0;
+    csDeadSleeps = 0;
+    memset(csIrqOn, 0, sizeof(csIrqOn));
+}
+
+INT32U CoreSimSysTickConfig(INT32U ticks){
+    CoreSimSysTick.LOAD = ticks - 1U;
+    CoreSimSysTick.VAL = 0;
+    CoreSimSysTick.CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+    return 0;
+}
+
+INT32U CoreSimGetPrimask(void){
+    return csPrimask;
+}
+
+void CoreSimSetPrimask(INT32U primask){
+    csPrimask = primask & 1U;
+    if(csPrimask == 0){
+        csRunPending();
+    }else{}
+}
+
+void CoreSimPend(void (*isr)(void)){
+    INT8U i;
+    for(i = 0; i < csNumPending; i++){
+        if(csPending[i] == isr){
+            return;
+        }else{}
+    }
+    if(csNumPending < CORE_SIM_MAX_IRQ){
+        csPending[csNumPending] = isr;
+        csNumPending++;
+    }else{
+        printf("CoreSim: too many pending handlers\n");
+    }
+    if(csPrimask == 0){
+        csRunPending();
+    }else{}
+}
+
+void CoreSimIrqEnable(IRQn_Type irq, INT8U on){
+    if(((INT32S)irq >= 0) && ((INT32U)irq < CORE_SIM_NUM_IRQN)){
+        csIrqOn[irq] = on;
+    }else{}
+}
+
+INT8U CoreSimIrqEnabled(IRQn_Type irq){
+    INT8U on = 0;
+    if(((INT32S)irq >= 0) && ((INT32U)irq < CORE_SIM_NUM_IRQN)){
+        on = csIrqOn[irq];
+    }else{}
+    return on;
+}
+
+INT8U CoreSimPending(void){
+    return csNumPending;
+}
+
+void CoreSimSetIdleHook(void (*hook)(void)){
+    csIdleHook = hook;
+}
+
+void CoreSimWfi(void){
+    csWfiCount++;
+    if((csNumPending == 0) && (csIdleHook != 0)){
+        csIdleHook();
+    }else{}
+    if(csNumPending == 0){
+        csDeadSleeps++;
+    }else{}
+    if(csPrimask == 0){
+        csRunPending();
+    }else{}
+}
+
+INT32U CoreSimWfiCount(void){
+    return csWfiCount;
+}
+
+INT32U CoreSimDeadSleeps(void){
+    return csDeadSleeps;
+}
+
+/* csRunPending - no parameters and returns nothing. Runs the pending handlers in the order they were pended,
+ * including any pended by a handler. Handlers do not nest.
+ * */
+static void csRunPending(void){
+    void (*isr)(void);
+    INT8U i;
+    if(csRunning == 0){
+        csRunning = 1;
+        while((csNumPending != 0) && (csPrimask == 0)){
+            isr = csPending[0];
+            for(i = 1; i < csNumPending; i++){
+                csPending[i - 1U] = csPending[i];
+            }
+            csNumPending--;
+            isr();
+        }
+        csRunning = 0;
+    }else{}
+}
@@ -0,0 +1,96 @@
+/* CoreSim.h - Header file for CoreSim.c - host stand-in for the Cortex-M4 core peripherals and intrinsics.
+ * Forced in with -include after HostMCUType.h, so the CMSIS inline functions are already defined and only the
+ * module under test sees the macros below. They put DWT, CoreDebug, SysTick and SCB in mock structures and route
+ * PRIMASK, WFI and the NVIC enables to a simulated core with one pending flag per interrupt handler.
+ *
+ * Dominic Danis
+ * */
+#ifndef CORE_SIM_INC
+#define CORE_SIM_INC
+
+/*Core peripheral and intrinsic hooks*/
+#undef DWT
+#define DWT                     (&CoreSimDwt)
+#undef CoreDebug
+#define CoreDebug               (&CoreSimCoreDebug)
+#undef SysTick
+#define SysTick                 (&CoreSimSysTick)
+#undef SCB
+#define SCB                     (&CoreSimScb)
+#define SysTick_Config(ticks)   CoreSimSysTickConfig(ticks)
+#define __get_PRIMASK()         CoreSimGetPrimask()
+#define __set_PRIMASK(v)        CoreSimSetPrimask(v)
+#define __disable_irq()         CoreSimSetPrimask(1U)
+#define __enable_irq()          CoreSimSetPrimask(0U)
+#undef __WFI
+#define __WFI()                 CoreSimWfi()
+#undef NVIC_EnableIRQ
+#define NVIC_EnableIRQ(irq)     CoreSimIrqEnable((irq), 1U)
+#undef NVIC_DisableIRQ
+#define NVIC_DisableIRQ(irq)    CoreSimIrqEnable((irq), 0)
+#undef NVIC_ClearPendingIRQ
+#define NVIC_ClearPendingIRQ(irq) ((void)(irq))
+
+/*Defined constants*/
+#define CORE_SIM_MAX_IRQ    8U                          /*number of distinct handlers that can be pending*/
+#define CORE_SIM_NUM_IRQN   128U                        /*NVIC interrupt numbers kept*/
+
+extern DWT_Type CoreSimDwt;
+extern CoreDebug_Type CoreSimCoreDebug;
+extern SysTick_Type CoreSimSysTick;
+extern SCB_Type CoreSimScb;
+
+/* CoreSimReset - no parameters and returns nothing. Clears the mock registers, PRIMASK, the pending handlers,
+ * the idle hook and the counts.
+ * */
+void CoreSimReset(void);
+
+/* CoreSimSysTickConfig - takes the reload count plus one, returns 0. Loads SysTick as SysTick_Config() does.
+ * */
+INT32U CoreSimSysTickConfig(INT32U ticks);
+
+/* CoreSimGetPrimask - no parameters, returns the simulated PRIMASK.
+ * */
+INT32U CoreSimGetPrimask(void);
+
+/* CoreSimSetPrimask - takes the new PRIMASK and returns nothing. Clearing it runs the pending handlers.
+ * */
+void CoreSimSetPrimask(INT32U primask);
+
+/* CoreSimPend - takes an interrupt handler and returns nothing. Runs it at once if PRIMASK is clear, otherwise
+ * marks it pending until PRIMASK is cleared. A handler already pending is not queued twice.
+ * */
+void CoreSimPend(void (*isr)(void));
+
+/* CoreSimIrqEnable - takes an NVIC interrupt number and 1 to enable or 0 to disable it, returns nothing.
+ * */
+void CoreSimIrqEnable(IRQn_Type irq, INT8U on);
+
+/* CoreSimIrqEnabled - takes an NVIC interrupt number, returns 1 if it is enabled.
+ * */
+INT8U CoreSimIrqEnabled(IRQn_Type irq);
+
+/* CoreSimPending - no parameters, returns the number of pending handlers.
+ * */
+INT8U CoreSimPending(void);
+
+/* CoreSimSetIdleHook - takes the function WFI calls to let simulated time pass and returns nothing. It is called
+ * with nothing pending and must pend an interrupt, as the next event would on the target. 0 removes it.
+ * */
+void CoreSimSetIdleHook(void (*hook)(void));
+
+/* CoreSimWfi - no parameters and returns nothing. WFI returns at once if a handler is pending, otherwise it calls
+ * the idle hook. Pending handlers run before it returns if PRIMASK is clear.
+ * */
+void CoreSimWfi(void);
+
+/* CoreSimWfiCount - no parameters, returns the number of WFI executed since the reset.
+ * */
+INT32U CoreSimWfiCount(void);
+
+/* CoreSimDeadSleeps - no parameters, returns the number of WFI that found nothing to wake them, a core that would
+ * sleep forever on the target.
+ * */
+INT32U CoreSimDeadSleeps(void);
+
+#endif
@@ -0,0 +1,157 @@
+/* CrcSim.c
+ * Host model of the K65 CRC module. CTRL selects a 16 or 32-bit CRC (TCRC), the transpose of writes (TOT) and
+ * reads (TOTR), the complement of reads (FXOR) and seed writes (WAS). A data write is transposed as the
+ * reference manual describes, 01 reverses the bits of each byte, 10 the bits of each byte and the bytes, 11 the
+ * bytes only, then its bits are shifted into the CRC most significant bit first with the GPOLY polynomial. An
+ * 8-bit write shifts in 8 bits and a 32-bit write 32. A read complements the CRC width, then transposes all 32
+ * bits. Seeds are loaded as written, both MemoryTools.c seeds are the same transposed.
+ *
+ * Dominic Danis
+ * */
+#include "MCUType.h"
+#include "CrcSim.h"
+
+CRC_Type CrcSimRegs;
+
+static INT32U crcSimCRC;
+static INT32U crcSimBytes;
+static INT32U crcSimWords;
+static INT32U crcSimErrors;
+
+/* crcSimBitRev8 - takes a byte, returns it with the bit order reversed.
+ * */
+static INT32U crcSimBitRev8(INT32U b){
+    INT32U r = 0;
+    INT8U i;
+    for(i = 0; i < 8U; i++){
+        r = (r << 1) | ((b >> i) & 1U);
+    }
+    return r;
+}
+
+/* crcSimTranspose - takes a value, its size in bytes and a TOT or TOTR setting, returns the transposed value.
+ * */
+static INT32U crcSimTranspose(INT32U v, INT8U nbytes, INT32U type){
+    INT32U r = 0;
+    INT32U b;
+    INT8U i;
+    for(i = 0; i < nbytes; i++){
+        b = (v >> (8U*i)) & 0xFFU;
+        if((type == 1U) || (type == 2U)){
+            b = crcSimBitRev8(b);
+        }else{}
+        if((type == 2U) || (type == 3U)){
+            r |= b << (8U*(nbytes - 1U - i));
+        }
+        else{
+            r |= b << (8U*i);
+        }
+    }
+    return r;
+}
+
+/* crcSimWidthMask - no parameters, returns the mask of the CRC width set by CTRL[TCRC].
+ * */
+static INT32U crcSimWidthMask(void){
+    return ((CrcSimRegs.CTRL & CRC_CTRL_TCRC_MASK) != 0) ? 0xFFFFFFFFU : 0xFFFFU;
+}
+
+/* crcSimShift - takes a data value and its size in bytes, returns nothing. Transposes it and shifts it in.
+ * */
+static void crcSimShift(INT32U v, INT8U nbytes){
+    INT32U mask = crcSimWidthMask();
+    INT32U top = (mask >> 1) + 1U;
+    INT32U poly = CrcSimRegs.GPOLY & mask;
+    INT32U in;
+    INT8U i;
+    v = crcSimTranspose(v, nbytes, (CrcSimRegs.CTRL & CRC_CTRL_TOT_MASK) >> CRC_CTRL_TOT_SHIFT);
+    for(i = 0; i < (8U*nbytes); i++){
+        in = (v >> ((8U*nbytes) - 1U - i)) & 1U;
+        if((((crcSimCRC & top) != 0) ? 1U : 0U) != in){
+            crcSimCRC = ((crcSimCRC << 1) ^ poly) & mask;
+        }
+        else{
+            crcSimCRC = (crcSimCRC << 1) & mask;
+        }
+    }
+}
+
+/* CrcSimReset - no parameters and returns nothing.
+ * */
+void CrcSimReset(void){
+    CrcSimRegs.CTRL = 0;
+    CrcSimRegs.GPOLY = 0x1021U;                         /*reset value*/
+    crcSimCRC = 0xFFFFFFFFU;
+    crcSimBytes = 0;
+    crcSimWords = 0;
+    crcSimErrors = 0;
+}
+
+/* CrcSimWrite8 - takes the byte written and returns nothing.
+ * */
+void CrcSimWrite8(INT8U b){
+    if((CrcSimRegs.CTRL & CRC_CTRL_WAS_MASK) != 0){
+        crcSimErrors++;
+    }
+    else{
+        crcSimShift(b, 1U);
+        crcSimBytes++;
+    }
+}
+
+/* CrcSimWrite16L - takes the half word written and returns nothing.
+ * */
+void CrcSimWrite16L(INT16U h){
+    if((CrcSimRegs.CTRL & CRC_CTRL_WAS_MASK) != 0){
+        crcSimCRC = (crcSimCRC & 0xFFFF0000U) | h;
+    }
+    else{
+        crcSimErrors++;
+    }
+}
+
+/* CrcSimWrite32 - takes the word written and returns nothing.
+ * */
+void CrcSimWrite32(INT32U w){
+    if((CrcSimRegs.CTRL & CRC_CTRL_WAS_MASK) != 0){
+        crcSimCRC = w;
+    }
+    else{
+        crcSimShift(w, 4U);
+        crcSimWords++;
+    }
+}
+
+/* CrcSimRead32 - no parameters, returns the value read from DATA.
+ * */
+INT32U CrcSimRead32(void){
+    INT32U v = crcSimCRC & crcSimWidthMask();
+    if((CrcSimRegs.CTRL & CRC_CTRL_FXOR_MASK) != 0){
+        v ^= crcSimWidthMask();
+    }else{}
+    return crcSimTranspose(v, 4U, (CrcSimRegs.CTRL & CRC_CTRL_TOTR_MASK) >> CRC_CTRL_TOTR_SHIFT);
+}
+
+/* CrcSimRead16H - no parameters, returns the value read from DATAH.
+ * */
+INT16U CrcSimRead16H(void){
+    return (INT16U)(CrcSimRead32() >> 16);
+}
+
+/* CrcSimByteWrites - no parameters, returns the count.
+ * */
+INT32U CrcSimByteWrites(void){
+    return crcSimBytes;
+}
+
+/* CrcSimWordWrites - no parameters, returns the count.
+ * */
+INT32U CrcSimWordWrites(void){
+    return crcSimWords;
+}
+
+/* CrcSimErrors - no parameters, returns the count.
+ * */
+INT32U CrcSimErrors(void){
+    return crcSimErrors;
+}
@@ -0,0 +1,61 @@
+/* CrcSim.h - Header file for CrcSim.c - host model of the K65 CRC module for source/MemoryTools.c.
+ * MemoryTools.c is built unmodified with this header forced in. The macros below send its CRC data register
+ * reads and writes to the model and put CTRL and GPOLY in a mock register block, which the model reads on
+ * every access.
+ *
+ * Dominic Danis
+ * */
+#ifndef CRC_SIM_INC
+#define CRC_SIM_INC
+
+/*MemoryTools.c hooks*/
+#define MEM_CRC             (&CrcSimRegs)
+#define MEM_CRC_CLK_INIT()  ((void)0)
+#define MEM_CRC_WR8(b)      CrcSimWrite8(b)
+#define MEM_CRC_WR16L(h)    CrcSimWrite16L(h)
+#define MEM_CRC_WR32(w)     CrcSimWrite32(w)
+#define MEM_CRC_RD16H()     CrcSimRead16H()
+#define MEM_CRC_RD32()      CrcSimRead32()
+
+extern CRC_Type CrcSimRegs;
+
+/* CrcSimReset - no parameters and returns nothing. Clears the registers, the CRC and the counts.
+ * */
+void CrcSimReset(void);
+
+/* CrcSimWrite8 - takes a byte written to DATALL and returns nothing. Shifts the byte into the CRC. An 8-bit
+ * seed write is counted as an error.
+ * */
+void CrcSimWrite8(INT8U b);
+
+/* CrcSimWrite16L - takes a half word written to DATAL and returns nothing. Only modelled as a seed write, a
+ * 16-bit data write is counted as an error.
+ * */
+void CrcSimWrite16L(INT16U h);
+
+/* CrcSimWrite32 - takes a word written to DATA and returns nothing. Loads the seed if CTRL[WAS] is set, else
+ * shifts the word into the CRC.
+ * */
+void CrcSimWrite32(INT32U w);
+
+/* CrcSimRead32 - no parameters, returns DATA with CTRL[FXOR] and CTRL[TOTR] applied.
+ * */
+INT32U CrcSimRead32(void);
+
+/* CrcSimRead16H - no parameters, returns DATAH, the top half of CrcSimRead32().
+ * */
+INT16U CrcSimRead16H(void);
+
+/* CrcSimByteWrites - no parameters, returns the number of 8-bit data writes since the reset.
+ * */
+INT32U CrcSimByteWrites(void);
+
+/* CrcSimWordWrites - no parameters, returns the number of 32-bit data writes since the reset.
+ * */
+INT32U CrcSimWordWrites(void);
+
+/* CrcSimErrors - no parameters, returns the number of accesses the model does not support since the reset.
+ * */
+INT32U CrcSimErrors(void);
+
+#endif
@@ -0,0 +1,185 @@
+/* DDSTest.c
+ * Host test of source/DDS.c. Tones are checked by counting the rising mid-scale crossings of one second of
+ * output. Linear and exponential sweeps, up and down, are checked block by block from the tuning word: they start
+ * at f0, move the right way every block, end within one block's step of f1 and start over at exactly f0, with the
+ * crossing rate at both ends as a check on the output itself. A sweep from 0Hz and a sweep shorter than one block
+ * must play a steady f0.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <math.h>
+#include "MCUType.h"
+#include "DDS.h"
+#include "TestUtil.h"
+
+#define TABLE_LEN   (1U << DDS_TABLE_BITS)
+#define MID         2048U                               /*a sample at or above is in the upper half*/
+#define MAX_BLOCKS  2000U
+
+static INT16U table[TABLE_LEN];
+static DDS_T dds;
+static INT16U prevSample;
+
+/* tuneHz - takes a tuning word, returns its frequency in Hz.
+ * */
+static FP64 tuneHz(INT32U tuning){
+    return (FP64)tuning*(FP64)DDS_SAMPLE_HZ/4294967296.0;
+}
+
+/* crossings - takes a number of blocks, returns the rising mid-scale crossings in their output.
+ * */
+static INT32U crossings(INT32U blocks){
+    INT16U buf[DDS_BLOCK_LEN];
+    INT32U n = 0;
+    INT32U i;
+    while(blocks != 0){
+        DDSRender(&dds, buf, DDS_BLOCK_LEN);
+        for(i = 0; i < DDS_BLOCK_LEN; i++){
+            if((prevSample < MID) && (buf[i] >= MID)){
+                n++;
+            }else{}
+            prevSample = buf[i];
+        }
+        blocks--;
+    }
+    return n;
+}
+
+/* testTone - one second of a tone has f crossings, give or take one for the start phase.
+ * */
+static void testTone(void){
+    static const INT32U freqs[] = {50U, 440U, 1000U, 2400U, 3000U, 7000U, 9000U, 9599U};
+    INT32U i;
+    INT32U n;
+    INT32U phase;
+    for(i = 0; i < (sizeof(freqs)/sizeof(freqs[0])); i++){
+        DDSInit(&dds, table);
+        DDSSetTone(&dds, freqs[i]);
+        prevSample = table[0];
+        n = crossings(DDS_SAMPLE_HZ/DDS_BLOCK_LEN);
+        if(!CHECK((n + 1U >= freqs[i]) && (n <= freqs[i] + 1U))){
+            printf("  %u Hz tone made %u crossings\n", freqs[i], n);
+        }else{}
+    }
+    CHECK(DDSTuningWord(DDS_SAMPLE_HZ/4U) == 0x40000000U);
+    phase = dds.phase;                                  /*a new tone keeps the phase*/
+    DDSSetTone(&dds, 100U);
+    CHECK(dds.phase == phase);
+}
+
+/* checkSweep - takes the sweep and returns nothing. Follows the tuning word for two sweeps and a block.
+ * */
+static void checkSweep(INT32U f0, INT32U f1, INT32U ms, DDS_SWEEP_T type){
+    INT16U buf[DDS_BLOCK_LEN];
+    INT32U blocks = (INT32U)(((INT64U)ms*DDS_SAMPLE_HZ)/(1000U*DDS_BLOCK_LEN));
+    INT32U tw0 = DDSTuningWord(f0);
+    INT32U tuning[2U*MAX_BLOCKS + 1U];
+    INT32U b;
+    INT32U n;
+    int moves = 1;
+    int repeats = 1;
+    FP64 last;
+    FP64 next;
+    FP64 edge_ms = 20.0;
+    INT32U edge = (INT32U)(edge_ms*DDS_SAMPLE_HZ/1000.0/DDS_BLOCK_LEN);
+    CHECK((blocks > 2U*edge) && (blocks <= MAX_BLOCKS));
+    DDSInit(&dds, table);
+    DDSSweep(&dds, f0, f1, ms, type);
+    for(b = 0; b <= (2U*blocks); b++){
+        tuning[b] = dds.tuning;
+        DDSRender(&dds, buf, DDS_BLOCK_LEN);
+    }
+    CHECK(tuning[0] == tw0);
+    for(b = 1; b < blocks; b++){
+        if(((f1 > f0) && (tuning[b] <= tuning[b - 1U])) || ((f1 < f0) && (tuning[b] >= tuning[b - 1U]))){
+            moves = 0;
+        }else{}
+    }
+    CHECK(moves);
+    last = tuneHz(tuning[blocks - 1U]);                 /*the last block of the sweep*/
+    if(type == DDS_SWEEP_LIN){
+        next = last + (tuneHz(tuning[blocks - 1U]) - tuneHz(tuning[blocks - 2U]));
+    }else{
+        next = last*(tuneHz(tuning[blocks - 1U])/tuneHz(tuning[blocks - 2U]));
+    }
+    if(!CHECK(fabs(next - (FP64)f1) < ((FP64)f1*0.002 + 0.5))){
+        printf("  sweep %u to %u Hz ended at %.2f Hz, one more step is %.2f Hz\n", f0, f1, last, next);
+    }else{}
+    CHECK(tuning[blocks] == tw0);                       /*starts over at exactly f0*/
+    for(b = 0; b <= blocks; b++){
+        if(tuning[b + blocks] != tuning[b]){
+            repeats = 0;
+        }else{}
+    }
+    CHECK(repeats);
+    DDSInit(&dds, table);                               /*crossing rate over the first and last 20ms*/
+    DDSSweep(&dds, f0, f1, ms, type);
+    prevSample = table[0];
+    n = crossings(edge);
+    CHECK(fabs((FP64)n*1000.0/edge_ms - (FP64)f0) <= fabs((FP64)f1 - (FP64)f0)*0.15 + 1000.0/edge_ms);
+    (void)crossings(blocks - 2U*edge);
+    n = crossings(edge);
+    CHECK(fabs((FP64)n*1000.0/edge_ms - (FP64)f1) <= fabs((FP64)f1 - (FP64)f0)*0.15 + 1000.0/edge_ms);
+}
+
+static void testSweep(void){
+    checkSweep(500U, 3000U, 400U, DDS_SWEEP_LIN);
+    checkSweep(500U, 3000U, 400U, DDS_SWEEP_EXP);
+    checkSweep(4000U, 800U, 1000U, DDS_SWEEP_LIN);
+    checkSweep(4000U, 800U, 1000U, DDS_SWEEP_EXP);
+    checkSweep(1000U, 1100U, 2000U, DDS_SWEEP_EXP);
+}
+
+/* checkSteady - takes the sweep, returns nothing. The tuning word must stay at f0 and one second must have f0
+ * crossings.
+ * */
+static void checkSteady(INT32U f0, INT32U f1, INT32U ms, DDS_SWEEP_T type){
+    INT16U buf[DDS_BLOCK_LEN];
+    INT32U tw0 = DDSTuningWord(f0);
+    INT32U b;
+    INT32U n;
+    int steady = 1;
+    DDSInit(&dds, table);
+    DDSSweep(&dds, f0, f1, ms, type);
+    for(b = 0; b < 1000U; b++){
+        if(dds.tuning != tw0){
+            steady = 0;
+        }else{}
+        DDSRender(&dds, buf, DDS_BLOCK_LEN);
+    }
+    CHECK(steady);
+    prevSample = table[0];
+    n = crossings(DDS_SAMPLE_HZ/DDS_BLOCK_LEN);
+    CHECK((n + 1U >= f0) && (n <= f0 + 1U));
+}
+
+static void testSteady(void){
+    INT16U buf[DDS_BLOCK_LEN];
+    INT32U i;
+    int flat = 1;
+    checkSteady(0U, 2000U, 500U, DDS_SWEEP_LIN);        /*from DC, no sweep*/
+    checkSteady(0U, 2000U, 500U, DDS_SWEEP_EXP);
+    checkSteady(1200U, 3000U, 1U, DDS_SWEEP_LIN);       /*1ms is shorter than one 1.67ms block*/
+    checkSteady(1200U, 3000U, 1U, DDS_SWEEP_EXP);
+    DDSInit(&dds, table);
+    DDSSweep(&dds, 0U, 2000U, 500U, DDS_SWEEP_EXP);
+    DDSRender(&dds, buf, DDS_BLOCK_LEN);
+    for(i = 0; i < DDS_BLOCK_LEN; i++){                 /*0Hz holds the first table entry*/
+        if(buf[i] != table[0]){
+            flat = 0;
+        }else{}
+    }
+    CHECK(flat);
+}
+
+int main(void){
+    INT32U i;
+    for(i = 0; i < TABLE_LEN; i++){
+        table[i] = (INT16U)(2047.5 + 2047.5*sin(2.0*M_PI*(FP64)i/(FP64)TABLE_LEN) + 0.5);
+    }
+    testTone();
+    testSweep();
+    testSteady();
+    return TestDone("DDSTest");
+}
@@ -0,0 +1,142 @@
+/* FlashScanTest.c
+ * Host test of source/FlashScan.c on a buffer. ProfileStart() is a fake clock that moves FAKE_TICK cycles per
+ * read. For ranges of several lengths and start alignments and every pair of byte limits and cycle budgets in
+ * the tables, a pass must finish, agree with one MemChkSum() of the range, keep the partial sum equal to a
+ * MemChkSum() of the bytes done so far, check at least one chunk every step and no more than the byte limit
+ * allows, and never go past the end. A flipped byte must fail the pass and count it, and FlashScanTask() must
+ * latch the fault once.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include "MCUType.h"
+#include "FlashScan.h"
+#include "MemoryTools.h"
+#include "TestUtil.h"
+
+#define BUF_LEN     (5U*FLASH_SCAN_CHUNK + 8U)
+#define FAKE_TICK   100U                                /*cycles per ProfileStart() read*/
+
+static INT8U scanBuf[BUF_LEN];
+static INT32U fakeClock;
+
+/*Stubs*/
+INT32U ProfileStart(void){
+    fakeClock += FAKE_TICK;
+    return fakeClock;
+}
+
+/* runPass - takes a context, the step limits and the most steps a pass may take, returns the pass result or
+ * FLASH_SCAN_BUSY if it did not finish. Checks every step as it goes.
+ * */
+static FLASH_SCAN_STATUS runPass(FLASH_SCAN_T *scan, INT32U max_bytes, INT32U budget, INT32U max_steps){
+    FLASH_SCAN_STATUS status = FLASH_SCAN_BUSY;
+    const INT8U *before;
+    INT32U done;
+    INT32U most = (max_bytes > FLASH_SCAN_CHUNK) ? max_bytes : FLASH_SCAN_CHUNK;
+    INT32U steps = 0;
+    int ok = 1;
+    while((status == FLASH_SCAN_BUSY) && (steps < max_steps)){
+        before = scan->next;
+        status = FlashScanStep(scan, max_bytes, budget);
+        steps++;
+        if(status == FLASH_SCAN_BUSY){
+            done = (INT32U)(scan->next - before);
+            ok = ok && (scan->next > before) && (scan->next <= scan->end);
+            ok = ok && ((done >= FLASH_SCAN_CHUNK) && (done <= most));
+            ok = ok && (scan->sum == MemChkSum((INT8U *)scan->start, (INT8U *)scan->next - 1));
+        }
+        else{
+            ok = ok && (scan->next == scan->start) && (scan->sum == 0);
+            ok = ok && ((INT32U)(scan->end - before + 1) <= most);
+        }
+    }
+    if(!CHECK(ok)){
+        printf("  max_bytes %u budget %u\n", max_bytes, budget);
+    }else{}
+    return status;
+}
+
+/* testPassLimits - every range, byte limit and budget finishes a pass that matches MemChkSum().
+ * */
+static void testPassLimits(void){
+    static const INT32U heads[] = {0U, 1U, 3U};
+    static const INT32U lens[] = {1U, 2U, FLASH_SCAN_CHUNK - 1U, FLASH_SCAN_CHUNK, FLASH_SCAN_CHUNK + 1U,
+                                  3U*FLASH_SCAN_CHUNK, 5U*FLASH_SCAN_CHUNK - 3U, 5U*FLASH_SCAN_CHUNK};
+    static const INT32U max_bytes[] = {0U, 1U, FLASH_SCAN_CHUNK - 1U, FLASH_SCAN_CHUNK, FLASH_SCAN_CHUNK + 1U,
+                                       2U*FLASH_SCAN_CHUNK, FLASH_SCAN_SLICE_BYTES, 0xFFFFFFFFU - FLASH_SCAN_CHUNK};
+    static const INT32U budgets[] = {0U, 1U, FAKE_TICK, 3U*FAKE_TICK, 10U*FAKE_TICK, FLASH_SCAN_BUDGET,
+                                     0xFFFFFFFFU};
+    FLASH_SCAN_T scan;
+    const INT8U *start;
+    const INT8U *end;
+    INT16U ref;
+    INT32U h, l, m, b;
+    INT32U bad = 0;
+    for(h = 0; h < (sizeof(heads)/sizeof(heads[0])); h++){
+        for(l = 0; l < (sizeof(lens)/sizeof(lens[0])); l++){
+            start = &scanBuf[heads[h]];
+            end = start + lens[l] - 1U;
+            ref = MemChkSum((INT8U *)start, (INT8U *)end);
+            for(m = 0; m < (sizeof(max_bytes)/sizeof(max_bytes[0])); m++){
+                for(b = 0; b < (sizeof(budgets)/sizeof(budgets[0])); b++){
+                    FlashScanCtxInit(&scan, start, end, ref);
+                    if((runPass(&scan, max_bytes[m], budgets[b], lens[l]) != FLASH_SCAN_PASS) ||
+                       (scan.passes != 1U) || (scan.fails != 0)){
+                        bad++;
+                    }else{}
+                }
+            }
+        }
+    }
+    CHECK(bad == 0);
+}
+
+/* testFlip - a flipped byte at the start, in the middle or at the end fails the next pass only.
+ * */
+static void testFlip(void){
+    static const INT32U at[] = {0U, 1U, FLASH_SCAN_CHUNK - 1U, FLASH_SCAN_CHUNK, 2U*FLASH_SCAN_CHUNK + 7U,
+                                BUF_LEN - 1U};
+    FLASH_SCAN_T scan;
+    INT32U i;
+    FlashScanCtxInit(&scan, scanBuf, &scanBuf[BUF_LEN - 1U], MemChkSum(scanBuf, &scanBuf[BUF_LEN - 1U]));
+    CHECK(runPass(&scan, FLASH_SCAN_SLICE_BYTES, FLASH_SCAN_BUDGET, BUF_LEN) == FLASH_SCAN_PASS);
+    for(i = 0; i < (sizeof(at)/sizeof(at[0])); i++){
+        scanBuf[at[i]] ^= 0x10U;
+        CHECK(runPass(&scan, FLASH_SCAN_SLICE_BYTES, FLASH_SCAN_BUDGET, BUF_LEN) == FLASH_SCAN_FAIL);
+        CHECK(scan.fails == (i + 1U));
+        scanBuf[at[i]] ^= 0x10U;
+        CHECK(runPass(&scan, FLASH_SCAN_SLICE_BYTES, FLASH_SCAN_BUDGET, BUF_LEN) == FLASH_SCAN_PASS);
+        CHECK(scan.fails == (i + 1U));
+    }
+    CHECK(scan.passes == (2U*i + 1U));
+}
+
+/* testTask - FlashScanTask() does nothing before FlashScanInit(), then latches a failed pass until it is read.
+ * */
+static void testTask(void){
+    INT32U n;
+    FlashScanTask();
+    CHECK(FlashScanGetPasses() == 0);
+    CHECK(FlashScanGetFault() == 0);
+    FlashScanInit(scanBuf, &scanBuf[BUF_LEN - 1U], (INT16U)(MemChkSum(scanBuf, &scanBuf[BUF_LEN - 1U]) + 1U));
+    for(n = 0; (n < BUF_LEN) && (FlashScanGetPasses() == 0); n++){
+        FlashScanTask();
+    }
+    CHECK(FlashScanGetPasses() == 1U);
+    CHECK(FlashScanGetFault() == 1U);
+    CHECK(FlashScanGetFault() == 0);
+}
+
+int main(void){
+    INT32U i;
+    srand(12);
+    for(i = 0; i < BUF_LEN; i++){
+        scanBuf[i] = (INT8U)rand();
+    }
+    testPassLimits();
+    testFlip();
+    testTask();
+    return TestDone("FlashScanTest");
+}
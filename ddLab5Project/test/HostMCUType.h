@@ -0,0 +1,29 @@
+/* HostMCUType.h - Stand-in for source/MCUType.h in the host test build. Forced in with -include by the Makefile.
+ * The device header is included for the register types and bit macros, but the WWU types are fixed width so
+ * INT32U wraps at 32 bits on a 64-bit host as it does on the K65. Defining MCU_TYPE_PRESENT turns the real
+ * MCUType.h into a no-op.
+ *
+ * Dominic Danis
+ * */
+#ifndef  MCU_TYPE_PRESENT
+#define  MCU_TYPE_PRESENT
+
+#include <stdint.h>
+#include "MK65F18.h"
+
+typedef char        INT8C;
+typedef uint8_t     INT8U;
+typedef int8_t      INT8S;
+typedef uint16_t    INT16U;
+typedef int16_t     INT16S;
+typedef uint32_t    INT32U;
+typedef int32_t     INT32S;
+typedef uint64_t    INT64U;
+typedef int64_t     INT64S;
+typedef float       FP32;
+typedef double      FP64;
+
+#define FALSE    0
+#define TRUE     1
+
+#endif
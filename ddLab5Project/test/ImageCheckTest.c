@@ -0,0 +1,165 @@
+/* ImageCheckTest.c
+ * Host test of source/ImageCheck.c on synthetic images. Each image is random bytes with a blank CRC record, a
+ * code part and initialized data described by a data section table. ImageVerify() runs against the CRC module
+ * model in CrcSim.c. A blank record must give IMAGE_NOT_STAMPED. The image is then stamped by the post-build
+ * step tools/ImageCRC.py on a .bin of the same bytes, and the stamped CRC must match SoftCRC.c over the image
+ * without the crc word and give IMAGE_PASS. A flipped byte anywhere in the range, the magic word included, or a
+ * changed crc word must give IMAGE_FAIL, and a byte past the end of the range must not matter. One image has the
+ * record in its last 8 bytes so the second CRC piece is empty, and one has a single byte after it.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MCUType.h"
+#include "ImageCheck.h"
+#include "SoftCRC.h"
+#include "CrcSim.h"
+#include "ImageSim.h"
+#include "TestUtil.h"
+
+#define IMAGE_MAX       4096U
+#define IMAGE_CRC_PY    "../tools/ImageCRC.py"
+#define IMAGE_BIN       "build/ImageCheckTest.bin"
+#define IMAGE_AXF       "build/ImageCheckTest.axf"      /*a copy of the .bin, the script stamps both*/
+
+/*Synthetic image layout*/
+typedef struct{
+    INT32U text;                                        /*bytes of code*/
+    INT32U data;                                        /*bytes of initialized data loaded after the code*/
+    INT32U rec;                                         /*offset of the CRC record, word aligned*/
+}IMAGE_LAYOUT_T;
+
+INT8U ImageSimImage[IMAGE_MAX + 4U] __attribute__((aligned(4)));
+INT32U ImageSimTextLen;
+INT32U ImageSimTable[6];
+INT32U ImageSimTableLen;
+volatile IMAGE_CRC_REC_T *ImageSimRec;
+
+/* buildImage - takes a layout, returns the number of bytes in the image. Fills the image with random bytes and
+ * a blank record and sets up the data section table, with a zero length .bss like entry in the code.
+ * */
+static INT32U buildImage(const IMAGE_LAYOUT_T *layout){
+    INT32U len = layout->text + layout->data;
+    INT32U i;
+    for(i = 0; i < sizeof(ImageSimImage); i++){
+        ImageSimImage[i] = (INT8U)rand();
+    }
+    ImageSimTextLen = layout->text;
+    ImageSimTableLen = 0;
+    if(layout->data != 0){
+        ImageSimTable[0] = (INT32U)(uintptr_t)&ImageSimImage[layout->text];
+        ImageSimTable[1] = 0x1FFF0000U;
+        ImageSimTable[2] = layout->data;
+        ImageSimTableLen = 3U;
+    }else{}
+    ImageSimTable[ImageSimTableLen] = (INT32U)(uintptr_t)&ImageSimImage[8];
+    ImageSimTable[ImageSimTableLen + 1U] = 0x1FFF8000U;
+    ImageSimTable[ImageSimTableLen + 2U] = 0;
+    ImageSimTableLen += 3U;
+    ImageSimRec = (volatile IMAGE_CRC_REC_T *)&ImageSimImage[layout->rec];
+    ImageSimRec->magic = IMAGE_CRC_MAGIC;
+    ImageSimRec->crc = IMAGE_CRC_BLANK;
+    return len;
+}
+
+/* stampImage - takes the image length, returns the CRC tools/ImageCRC.py stamped into a .bin of the image, or
+ * IMAGE_CRC_BLANK if it failed. The image itself is not changed.
+ * */
+static INT32U stampImage(INT32U len){
+    static INT8U bin[IMAGE_MAX];
+    const INT8U *rec = (const INT8U *)ImageSimRec;
+    INT32U off = (INT32U)(rec - ImageSimImage);
+    INT32U crc = IMAGE_CRC_BLANK;
+    FILE *f;
+    int ok = 1;
+    f = fopen(IMAGE_BIN, "wb");
+    ok = ok && (f != NULL) && (fwrite(ImageSimImage, 1, len, f) == len);
+    ok = ok && (f != NULL) && (fclose(f) == 0);
+    f = fopen(IMAGE_AXF, "wb");
+    ok = ok && (f != NULL) && (fwrite(ImageSimImage, 1, len, f) == len);
+    ok = ok && (f != NULL) && (fclose(f) == 0);
+    ok = ok && (system("python3 " IMAGE_CRC_PY " " IMAGE_AXF " " IMAGE_BIN " > /dev/null") == 0);
+    f = ok ? fopen(IMAGE_BIN, "rb") : NULL;
+    ok = ok && (f != NULL) && (fread(bin, 1, len, f) == len);
+    if(f != NULL){
+        fclose(f);
+    }else{}
+    if(CHECK(ok)){
+        CHECK(memcmp(bin, ImageSimImage, off + 4U) == 0);
+        CHECK(memcmp(&bin[off + 8U], &ImageSimImage[off + 8U], len - off - 8U) == 0);
+        memcpy(&crc, &bin[off + 4U], sizeof(crc));
+    }else{}
+    return crc;
+}
+
+/* softImageCRC - takes the image length, returns the CRC32 of the image without the crc word.
+ * */
+static INT32U softImageCRC(INT32U len){
+    SOFT_CRC_T ctx;
+    INT32U off = (INT32U)((const INT8U *)ImageSimRec - ImageSimImage);
+    SoftCRCInit(&ctx, SOFT_CRC32);
+    SoftCRCUpdate(&ctx, ImageSimImage, off + 4U);
+    SoftCRCUpdate(&ctx, &ImageSimImage[off + 8U], len - off - 8U);
+    return SoftCRCResult(&ctx);
+}
+
+/* checkImage - takes a layout, returns nothing. Runs the blank, stamped, changed byte and past the end cases.
+ * Bytes in the crc word or past the range are not flipped.
+ * */
+static void checkImage(const IMAGE_LAYOUT_T *layout){
+    IMAGE_RANGE_T range;
+    INT32U len = buildImage(layout);
+    INT32U crc;
+    INT32U at[6];
+    INT32U i;
+    CHECK(ImageVerify(&range) == IMAGE_NOT_STAMPED);
+    CHECK((range.start == ImageSimImage) && (range.end == &ImageSimImage[len - 1U]));
+    crc = stampImage(len);
+    CHECK(crc != IMAGE_CRC_BLANK);
+    if(!CHECK(crc == softImageCRC(len))){
+        printf("  text %u data %u: ImageCRC.py 0x%08X, SoftCRC 0x%08X\n", layout->text, layout->data, crc,
+               softImageCRC(len));
+    }else{}
+    ImageSimRec->crc = crc;
+    CHECK(ImageVerify(&range) == IMAGE_PASS);
+    at[0] = 0;
+    at[1] = layout->rec;                                /*magic*/
+    at[2] = layout->rec - 1U;
+    at[3] = layout->text - 1U;
+    at[4] = layout->text;
+    at[5] = len - 1U;
+    for(i = 0; i < 6U; i++){
+        if((at[i] < len) && ((at[i] < layout->rec + 4U) || (at[i] >= layout->rec + 8U))){
+            ImageSimImage[at[i]] ^= 0x01U;
+            if(!CHECK(ImageVerify(&range) == IMAGE_FAIL)){
+                printf("  text %u data %u: flip at %u passed\n", layout->text, layout->data, at[i]);
+            }else{}
+            ImageSimImage[at[i]] ^= 0x01U;
+        }else{}
+    }
+    ImageSimRec->crc = crc ^ 0x80000000U;
+    CHECK(ImageVerify(&range) == IMAGE_FAIL);
+    ImageSimRec->crc = crc;
+    ImageSimImage[len] ^= 0x01U;
+    CHECK(ImageVerify(&range) == IMAGE_PASS);
+    CHECK(CrcSimErrors() == 0);
+}
+
+int main(void){
+    static const IMAGE_LAYOUT_T layouts[] = {
+        {3000U, 500U, 1000U},                           /*record in the code*/
+        {2047U, 1U, 1024U},                             /*odd lengths*/
+        {1200U, 900U, 1600U},                           /*record in the data*/
+        {2048U, 0U, 2040U},                             /*crc word is the last word*/
+        {2049U, 0U, 2040U}                              /*one byte after the crc word*/
+    };
+    INT32U i;
+    srand(13);
+    CrcSimReset();
+    for(i = 0; i < (sizeof(layouts)/sizeof(layouts[0])); i++){
+        checkImage(&layouts[i]);
+    }
+    return TestDone("ImageCheckTest");
+}
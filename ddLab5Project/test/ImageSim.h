@@ -0,0 +1,24 @@
+/* ImageSim.h - Header file for the synthetic flash image in ImageCheckTest.c.
+ * ImageCheck.c is built unmodified with this header forced in. The macros below take the image start, the end of
+ * the code, the data section table and the CRC record from the test's buffer instead of the linker symbols.
+ *
+ * Dominic Danis
+ * */
+#ifndef IMAGE_SIM_INC
+#define IMAGE_SIM_INC
+#include "ImageCheck.h"
+
+/*ImageCheck.c hooks*/
+#define IMAGE_START             (&ImageSimImage[0])
+#define IMAGE_ETEXT             (&ImageSimImage[ImageSimTextLen])
+#define IMAGE_DATA_TABLE        (&ImageSimTable[0])
+#define IMAGE_DATA_TABLE_END    (&ImageSimTable[ImageSimTableLen])
+#define IMAGE_CRC_REC           (*ImageSimRec)
+
+extern INT8U ImageSimImage[];
+extern INT32U ImageSimTextLen;                          /*bytes of code from the start*/
+extern INT32U ImageSimTable[];                          /*load, exec, length per data section*/
+extern INT32U ImageSimTableLen;                         /*words in use in ImageSimTable*/
+extern volatile IMAGE_CRC_REC_T *ImageSimRec;
+
+#endif
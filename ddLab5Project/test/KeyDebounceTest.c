@@ -0,0 +1,133 @@
+/* KeyDebounceTest.c
+ * Host test of board/KeyDebounce.c against plain reference models. KeyGhosting() is compared over all 65536
+ * matrix samples with a brute force search for three pressed corners of a rectangle. KeyDebounce() is compared
+ * with a separate counter for each key over a long random sample stream, including ambiguous samples.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include "MCUType.h"
+#include "KeyDebounce.h"
+#include "TestUtil.h"
+
+/* refGhost - returns 1 if three corners of any rectangle of keys are down, so the fourth would read down too.
+ * */
+static int refGhost(INT32U raw){
+    INT32U a;
+    INT32U b;
+    INT32U c1;
+    INT32U c2;
+    INT32U n;
+    int ghost = 0;
+    for(a = 0; a < 16U; a++){
+        for(b = 0; b < 16U; b++){
+            if(((a / 4U) != (b / 4U)) && ((a % 4U) != (b % 4U))){
+                c1 = ((b / 4U) * 4U) + (a % 4U);
+                c2 = ((a / 4U) * 4U) + (b % 4U);
+                n = ((raw >> a) & 1U) + ((raw >> b) & 1U) + ((raw >> c1) & 1U) + ((raw >> c2) & 1U);
+                if(n >= 3U){
+                    ghost = 1;
+                }else{}
+            }else{}
+        }
+    }
+    return ghost;
+}
+
+static void testGhosting(void){
+    INT32U raw;
+    INT32U bad = 0;
+    INT32U ghosts = 0;
+    for(raw = 0; raw < 0x10000U; raw++){
+        if((KeyGhosting((INT16U)raw) != 0) != (refGhost(raw) != 0)){
+            if(bad < 5U){
+                printf("  KeyGhosting(0x%04X) is %u\n", (unsigned)raw, KeyGhosting((INT16U)raw));
+            }else{}
+            bad++;
+        }else{}
+        ghosts += (KeyGhosting((INT16U)raw) != 0);
+    }
+    CHECK(bad == 0U);
+    CHECK(KeyGhosting(0x0000U) == 0U);
+    CHECK(KeyGhosting(0x0021U) == 0U);                  /*'1' and '6', diagonal*/
+    CHECK(KeyGhosting(0x0023U) != 0U);                  /*'1', '2' and '6'*/
+    CHECK(KeyGhosting(0x000FU) == 0U);                  /*one row*/
+    CHECK(KeyGhosting(0x1111U) == 0U);                  /*one column*/
+    CHECK((ghosts > 0U) && (ghosts < 0x10000U));
+}
+
+/* testDebounce - per key counter model. A key toggles on the KEY_DB_SAMPLES-th sample in a row that differs
+ * from its state, an equal sample restarts its count, and an ambiguous sample changes nothing.
+ * */
+static void testDebounce(void){
+    KEY_DB_T db;
+    INT32U cnt[16];
+    INT32U state = 0;
+    INT32U raw = 0;
+    INT32U pressed;
+    INT32U released;
+    INT32U bit;
+    INT32U i;
+    INT32U k;
+    INT32U bad = 0;
+    INT32U ghosts = 0;
+    INT32U edges = 0;
+    KeyDebounceInit(&db);
+    for(k = 0; k < 16U; k++){
+        cnt[k] = 0;
+    }
+    srand(20);
+    for(i = 0; i < 2000000U; i++){
+        if((rand() % 5) == 0){
+            raw ^= 1U << (rand() % 16);
+        }else{}
+        if((rand() % 7) == 0){
+            raw &= 0x8421U;                             /*back to a diagonal, never ambiguous*/
+        }else{}
+        (void)KeyDebounce(&db, (INT16U)raw);
+        if(refGhost(raw) != 0){
+            ghosts++;
+            if((db.ghost == 0) || (db.pressed != 0) || (db.released != 0) || (db.state != state)){
+                bad++;
+            }else{}
+        }else{
+            pressed = 0;
+            released = 0;
+            for(k = 0; k < 16U; k++){
+                bit = 1U << k;
+                if(((raw ^ state) & bit) != 0){
+                    cnt[k]++;
+                    if(cnt[k] >= KEY_DB_SAMPLES){
+                        state ^= bit;
+                        cnt[k] = 0;
+                        if((state & bit) != 0){
+                            pressed |= bit;
+                        }else{
+                            released |= bit;
+                        }
+                    }else{}
+                }else{
+                    cnt[k] = 0;
+                }
+            }
+            edges += (pressed != 0) || (released != 0);
+            if((db.ghost != 0) || (db.state != state) || (db.pressed != pressed) || (db.released != released)){
+                if(bad < 5U){
+                    printf("  sample %u raw 0x%04X state 0x%04X want 0x%04X\n", (unsigned)i, (unsigned)raw,
+                           db.state, (unsigned)state);
+                }else{}
+                bad++;
+            }else{}
+        }
+    }
+    CHECK(bad == 0U);
+    CHECK(ghosts > 1000U);                              /*the stream did cover ambiguous samples*/
+    CHECK(edges > 1000U);
+}
+
+int main(void){
+    testGhosting();
+    testDebounce();
+    return TestDone("KeyDebounceTest");
+}
@@ -0,0 +1,170 @@
+/* KeyQueueTest.c
+ * Host test of board/KeyQueue.c. Covers the empty queue, the full queue dropping the newest event and counting
+ * the overflow, and the 8-bit head and tail running past 255 with KEY_QUEUE_LEN 16. A random mix of pushes and
+ * pops is checked against a plain FIFO model. KQ_BARRIER is a compiler barrier in this build.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include "MCUType.h"
+#include "KeyQueue.h"
+#include "TestUtil.h"
+
+#define MODEL_LEN   4096U
+
+static KEY_QUEUE_T queue;
+
+/* mkEvent - takes a sequence number, returns an event built from it.
+ * */
+static KEY_EVENT_T mkEvent(INT32U n){
+    KEY_EVENT_T ev;
+    ev.ms = n;
+    ev.code = (INT8C)('0' + (n % 10U));
+    ev.type = ((n & 1U) != 0) ? KEY_UP : KEY_DOWN;
+    return ev;
+}
+
+/* sameEvent - returns 1 if the event is the one mkEvent() made from n.
+ * */
+static int sameEvent(const KEY_EVENT_T *ev, INT32U n){
+    KEY_EVENT_T want = mkEvent(n);
+    return (ev->ms == want.ms) && (ev->code == want.code) && (ev->type == want.type);
+}
+
+static void testEmpty(void){
+    KEY_EVENT_T ev = mkEvent(77U);
+    KeyQueueInit(&queue);
+    CHECK(KeyQueueCount(&queue) == 0U);
+    CHECK(KeyQueuePeek(&queue, &ev) == 0U);
+    CHECK(KeyQueuePop(&queue, &ev) == 0U);
+    CHECK(KeyQueuePop(&queue, 0) == 0U);
+    CHECK(sameEvent(&ev, 77U));                         /*not written on an empty queue*/
+    CHECK((queue.head == 0U) && (queue.tail == 0U));
+    /*Empty again after one event*/
+    ev = mkEvent(1U);
+    CHECK(KeyQueuePush(&queue, &ev) == 1U);
+    CHECK(KeyQueuePop(&queue, 0) == 1U);
+    CHECK(KeyQueuePeek(&queue, &ev) == 0U);
+    CHECK(KeyQueuePop(&queue, &ev) == 0U);
+    CHECK(KeyQueueCount(&queue) == 0U);
+}
+
+static void testFull(void){
+    KEY_EVENT_T ev;
+    INT32U i;
+    KeyQueueInit(&queue);
+    for(i = 0; i < KEY_QUEUE_LEN; i++){
+        ev = mkEvent(i);
+        CHECK(KeyQueuePush(&queue, &ev) == 1U);
+    }
+    CHECK(KeyQueueCount(&queue) == KEY_QUEUE_LEN);
+    for(i = 0; i < 3U; i++){
+        ev = mkEvent(100U + i);
+        CHECK(KeyQueuePush(&queue, &ev) == 0U);
+    }
+    CHECK(queue.overflows == 3U);
+    CHECK(queue.pushed == KEY_QUEUE_LEN);
+    CHECK(queue.max_depth == KEY_QUEUE_LEN);
+    CHECK(KeyQueueCount(&queue) == KEY_QUEUE_LEN);
+    /*The oldest events are kept in order, the dropped ones never show up*/
+    CHECK(KeyQueuePeek(&queue, &ev) == 1U);
+    CHECK(sameEvent(&ev, 0U));
+    for(i = 0; i < KEY_QUEUE_LEN; i++){
+        CHECK(KeyQueuePop(&queue, &ev) == 1U);
+        CHECK(sameEvent(&ev, i));
+    }
+    CHECK(KeyQueuePop(&queue, &ev) == 0U);
+    /*One slot free takes exactly one more*/
+    for(i = 0; i < KEY_QUEUE_LEN; i++){
+        ev = mkEvent(i);
+        (void)KeyQueuePush(&queue, &ev);
+    }
+    CHECK(KeyQueuePop(&queue, 0) == 1U);
+    ev = mkEvent(200U);
+    CHECK(KeyQueuePush(&queue, &ev) == 1U);
+    CHECK(KeyQueuePush(&queue, &ev) == 0U);
+    CHECK(queue.overflows == 4U);
+}
+
+/* testWrap - runs head and tail past 255 several times at every depth from empty to full.
+ * */
+static void testWrap(void){
+    KEY_EVENT_T ev;
+    INT32U in = 0;
+    INT32U out = 0;
+    INT32U depth;
+    INT32U lap;
+    KeyQueueInit(&queue);
+    for(lap = 0; lap < 40U; lap++){
+        depth = lap % (KEY_QUEUE_LEN + 1U);
+        while((in - out) < depth){
+            ev = mkEvent(in);
+            CHECK(KeyQueuePush(&queue, &ev) == 1U);
+            in++;
+        }
+        while(((in + 1U) & 0xFFU) != 0){                 /*push and pop until head passes 255*/
+            ev = mkEvent(in);
+            if((in - out) < KEY_QUEUE_LEN){
+                CHECK(KeyQueuePush(&queue, &ev) == 1U);
+                in++;
+            }else{}
+            CHECK(KeyQueueCount(&queue) == (INT8U)(in - out));
+            CHECK(KeyQueuePop(&queue, &ev) == 1U);
+            CHECK(sameEvent(&ev, out));
+            out++;
+        }
+        CHECK(queue.head == (INT8U)in);
+        CHECK(queue.tail == (INT8U)out);
+    }
+    CHECK(in > 2000U);
+    CHECK(queue.overflows == 0U);
+}
+
+/* testRandom - random pushes and pops against a plain FIFO.
+ * */
+static void testRandom(void){
+    static INT32U model[MODEL_LEN];
+    KEY_EVENT_T ev;
+    INT32U in = 0;
+    INT32U out = 0;
+    INT32U drops = 0;
+    INT32U i;
+    INT8U ok;
+    KeyQueueInit(&queue);
+    for(i = 0; i < 200000U; i++){
+        if((rand() % 2) == 0){
+            ev = mkEvent(i);
+            ok = KeyQueuePush(&queue, &ev);
+            if((in - out) < KEY_QUEUE_LEN){
+                CHECK(ok == 1U);
+                model[in % MODEL_LEN] = i;
+                in++;
+            }else{
+                CHECK(ok == 0U);
+                drops++;
+            }
+        }else{
+            ok = KeyQueuePop(&queue, &ev);
+            if(in != out){
+                CHECK(ok == 1U);
+                CHECK(sameEvent(&ev, model[out % MODEL_LEN]));
+                out++;
+            }else{
+                CHECK(ok == 0U);
+            }
+        }
+        CHECK(KeyQueueCount(&queue) == (in - out));
+    }
+    CHECK(queue.overflows == drops);
+    CHECK(queue.pushed == in);
+}
+
+int main(void){
+    srand(18);
+    testEmpty();
+    testFull();
+    testWrap();
+    testRandom();
+    return TestDone("KeyQueueTest");
+}
@@ -0,0 +1,20 @@
+/* KeySim.h - Header file for the keypad matrix simulation in KeyTest.c.
+ * Key.c is built unmodified with this header forced in. The macros below put its port C registers in mock
+ * structures and its event timestamps on the simulated millisecond count.
+ *
+ * Dominic Danis
+ * */
+#ifndef KEY_SIM_INC
+#define KEY_SIM_INC
+
+/*Key.c hooks*/
+#define KEY_GPIO        (&KeySimGpio)
+#define KEY_PORT        (&KeySimPort)
+#define KEY_HW_INIT()   ((void)0)
+#define KEY_MS()        KeySimMs
+
+extern GPIO_Type KeySimGpio;
+extern PORT_Type KeySimPort;
+extern INT32U KeySimMs;
+
+#endif
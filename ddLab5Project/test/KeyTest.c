@@ -0,0 +1,265 @@
+/* KeyTest.c
+ * Host test of the idle and scan mode switching in board/Key.c with a simulated 4x4 matrix. A column reads low
+ * while a key on a driven row is down. Pin writes from Key.c settle at once with no interrupt, the same as on
+ * the board where keyArm() drives the rows before it arms the columns. A key press made by the test lowers the
+ * columns with the falling-edge interrupts live, so an armed column sets its ISF bit and PORTC_IRQHandler() runs.
+ * KeyTick() runs every ms and KeyTask() once a frame.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include "MCUType.h"
+#include "KeySim.h"
+#include "Key.h"
+#include "KeyDebounce.h"
+#include "K65TWR_GPIO.h"
+#include "TestUtil.h"
+
+#define COLS_MASK   0x00000078U
+#define ROWS_MASK   0x00000780U
+#define IDLE_SCANS  3U                                  /*KEY_IDLE_SCANS in Key.c*/
+#define FRAMES_MAX  50U
+#define SIM_PDIR    (*(volatile INT32U *)&KeySimGpio.PDIR)    /*read only to Key.c*/
+
+void PORTC_IRQHandler(void);
+
+GPIO_Type KeySimGpio;
+PORT_Type KeySimPort;
+INT32U KeySimMs;
+
+static INT16U simKeys;                                  /*keys held down, bit (row*4)+column*/
+static INT32U simIrqs;
+
+/* simCols - returns the port input for the keys down and the rows driven low.
+ * */
+static INT32U simCols(void){
+    INT32U low = ROWS_MASK & KeySimGpio.PDDR & ~KeySimGpio.PDOR;
+    INT32U cols = 0;
+    INT8U row;
+    for(row = 0; row < 4U; row++){
+        if((low & (0x80U << row)) != 0){
+            cols |= (simKeys >> (row * 4U)) & 0x0FU;
+        }else{}
+    }
+    return ~(cols << 3);
+}
+
+/* simSettle - updates the inputs after Key.c changed the pins. No edge interrupts.
+ * */
+static void simSettle(void){
+    SIM_PDIR = simCols();
+}
+
+/* simPress - the test changes the keys down. Falling edges on armed columns raise the port interrupt.
+ * */
+static void simPress(INT16U keys){
+    INT32U old = KeySimGpio.PDIR;
+    INT32U fell;
+    INT8U pin;
+    simKeys = keys;
+    SIM_PDIR = simCols();
+    fell = old & ~KeySimGpio.PDIR & COLS_MASK;
+    for(pin = 3U; pin < 7U; pin++){
+        if(((fell & (1U << pin)) != 0) &&
+           (((KeySimPort.PCR[pin] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT) == PORT_IRQ_FE)){
+            KeySimPort.ISFR |= 1U << pin;
+        }else{}
+    }
+    if((KeySimPort.ISFR & COLS_MASK) != 0){
+        simIrqs++;
+        PORTC_IRQHandler();
+        KeySimPort.ISFR = 0;                            /*write 1 to clear*/
+    }else{}
+}
+
+/* simTick - one ms, KeyTick() from the SysTick.
+ * */
+static void simTick(void){
+    KeySimMs++;
+    KeyTick();
+    simSettle();
+}
+
+/* simTask - KeyTask() from the scheduler.
+ * */
+static void simTask(void){
+    KeyTask();
+    simSettle();
+    KeySimPort.ISFR = 0;
+}
+
+/* simFrame - a frame of KEY_NUM_ROWS ticks then KeyTask().
+ * */
+static void simFrame(void){
+    INT8U i;
+    for(i = 0; i < 4U; i++){
+        simTick();
+    }
+    simTask();
+}
+
+/* isIdle - returns 1 if all rows are driven and the columns are armed.
+ * */
+static int isIdle(void){
+    INT8U pin;
+    int armed = 1;
+    for(pin = 3U; pin < 7U; pin++){
+        if(((KeySimPort.PCR[pin] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT) != PORT_IRQ_FE){
+            armed = 0;
+        }else{}
+    }
+    return armed && ((KeySimGpio.PDDR & ROWS_MASK) == ROWS_MASK) && ((KeySimGpio.PDOR & ROWS_MASK) == 0);
+}
+
+/* isScanning - returns 1 if one row is driven and the columns are disarmed.
+ * */
+static int isScanning(void){
+    INT8U pin;
+    int off = 1;
+    INT32U rows = KeySimGpio.PDDR & ROWS_MASK;
+    for(pin = 3U; pin < 7U; pin++){
+        if((KeySimPort.PCR[pin] & PORT_PCR_IRQC_MASK) != 0){
+            off = 0;
+        }else{}
+    }
+    return off && (rows != 0) && ((rows & (rows - 1U)) == 0);
+}
+
+/* expectEvent - pops one event and checks it.
+ * */
+static void expectEvent(INT8C code, KEY_EVENT_TYPE type){
+    KEY_EVENT_T ev;
+    CHECK(KeyPop(&ev) == 1U);
+    CHECK(ev.code == code);
+    CHECK(ev.type == type);
+}
+
+/* runUntilEvent - runs frames until an event is queued, returns the frames run.
+ * */
+static INT32U runUntilEvent(void){
+    KEY_EVENT_T ev;
+    INT32U frames = 0;
+    while((KeyPeek(&ev) == 0) && (frames < FRAMES_MAX)){
+        simFrame();
+        frames++;
+    }
+    return frames;
+}
+
+/* runUntilIdle - runs frames until idle, returns the frames run.
+ * */
+static INT32U runUntilIdle(void){
+    INT32U frames = 0;
+    while((isIdle() == 0) && (frames < FRAMES_MAX)){
+        simFrame();
+        frames++;
+    }
+    return frames;
+}
+
+int main(void){
+    INT32U i;
+    INT32U frames;
+    KEY_EVENT_T ev;
+    KEY_STATS_T stats;
+
+    simSettle();
+    KeyInit();
+    simSettle();
+    CHECK(isIdle());
+
+    /*Idle with nothing pressed, KeyTick() leaves the rows alone*/
+    for(i = 0; i < 10U; i++){
+        simFrame();
+        CHECK(isIdle());
+    }
+    CHECK(simIrqs == 0U);
+
+    /*Edge wake: '5' down, the column interrupt wakes the scan and the press is queued with its time*/
+    simPress(1U << 5);
+    CHECK(simIrqs == 1U);
+    simTask();
+    CHECK(isScanning());
+    CHECK((KeySimGpio.PDDR & ROWS_MASK) == 0x80U);      /*first row*/
+    frames = runUntilEvent();
+    CHECK(frames == KEY_DB_SAMPLES);
+    CHECK(KeyPeek(&ev) == 1U);
+    CHECK(ev.ms == KeySimMs);
+    expectEvent('5', KEY_DOWN);
+    CHECK(KeyGetState() == (1U << 5));
+
+    /*Held, keeps scanning*/
+    for(i = 0; i < 20U; i++){
+        simFrame();
+        CHECK(isScanning());
+    }
+    CHECK(KeyPop(&ev) == 0U);
+
+    /*Release: KEY_UP on the KEY_DB_SAMPLES-th released frame, idle on the IDLE_SCANS-th*/
+    simPress(0);
+    CHECK(simIrqs == 1U);
+    frames = runUntilEvent();
+    CHECK(frames == KEY_DB_SAMPLES);
+    expectEvent('5', KEY_UP);
+    CHECK(isScanning() || (IDLE_SCANS == 1U));
+    frames = runUntilIdle();
+    CHECK(frames == (IDLE_SCANS - 1U));
+    CHECK(KeyGetState() == 0U);
+
+    /*A glitch too short to debounce still wakes the scan, then it goes back to idle with no events*/
+    simPress(1U << 14);
+    simPress(0);
+    CHECK(simIrqs == 2U);
+    simTask();
+    CHECK(isScanning());
+    frames = runUntilIdle();
+    CHECK(frames == IDLE_SCANS);
+    CHECK(KeyPop(&ev) == 0U);
+
+    /*Key already down when idle is re-armed. '#' goes down after the last released frame was read and before
+     *KeyTask() re-arms, so its column is already low when the rows are driven and there is no edge.*/
+    simPress(1U << 0);
+    CHECK(simIrqs == 3U);
+    simTask();
+    (void)runUntilEvent();
+    expectEvent('1', KEY_DOWN);
+    simPress(0);
+    (void)runUntilEvent();
+    expectEvent('1', KEY_UP);
+    for(i = 0; i < (IDLE_SCANS - 2U); i++){
+        simFrame();
+    }
+    CHECK(isScanning());
+    for(i = 0; i < 4U; i++){
+        simTick();
+    }
+    simPress(1U << 14);                                 /*row 4 was read on the last tick, row 1 is driven*/
+    CHECK(simIrqs == 3U);
+    simTask();
+    CHECK(isIdle());                                    /*the frame was clear*/
+    CHECK(simIrqs == 3U);
+    CHECK((KeySimGpio.PDIR & COLS_MASK) != COLS_MASK);   /*column low, no edge to come*/
+    simTask();
+    CHECK(isScanning());                                /*KeyTask() saw the low column*/
+    (void)runUntilEvent();
+    expectEvent('#', KEY_DOWN);
+    simPress(0);
+    (void)runUntilEvent();
+    expectEvent('#', KEY_UP);
+    frames = runUntilIdle();
+    CHECK(frames == (IDLE_SCANS - 1U));
+
+    /*Idle mode re-armed cleanly, the next press is an edge again*/
+    simPress(1U << 3);
+    CHECK(simIrqs == 4U);
+    CHECK(KeyGet() == 0);
+    simTask();
+    (void)runUntilEvent();
+    CHECK(KeyGet() == DC1);
+
+    KeyGetStats(&stats);
+    CHECK(stats.events == 7U);
+    CHECK(stats.overflows == 0U);
+    CHECK(stats.ghosts == 0U);
+    return TestDone("KeyTest");
+}
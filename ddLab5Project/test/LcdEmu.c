@@ -0,0 +1,290 @@
+/* LcdEmu.c
+ * Host emulator of an HD44780 compatible LCD on the TWR-K65 LCD port, RS on bit 1, E on bit 2 and DB4-DB7 on bits
+ * 3-6. Every port write from LCD.c is stamped with a virtual time. The write operation timing of the HD44780U
+ * datasheet (VCC 4.5-5.5V) is checked on each edge, and a nibble is latched on each falling edge of E. The
+ * instruction set is run on the latched bytes to rebuild the DDRAM and the address counter. A write that starts
+ * while the last instruction is still executing is a violation, the real controller would drop it.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <string.h>
+#include "MCUType.h"
+#include "LcdEmu.h"
+
+#define EMU_RS_BIT      0x2U
+#define EMU_E_BIT       0x4U
+#define EMU_DB_MASK     0x78U
+#define EMU_DB_SHIFT    3U
+#define EMU_PINS        (EMU_RS_BIT|EMU_E_BIT|EMU_DB_MASK)
+
+/*Write operation timing in ns, HD44780U datasheet*/
+#define EMU_T_CYCE      500U                            /*enable cycle time*/
+#define EMU_T_PWEH      230U                            /*enable pulse width high*/
+#define EMU_T_AS        40U                             /*RS setup to E rise*/
+#define EMU_T_AH        10U                             /*RS hold after E fall*/
+#define EMU_T_DSW       80U                             /*data setup to E fall*/
+#define EMU_T_H         10U                             /*data hold after E fall*/
+/*Execution times in ns, fosc = 270kHz*/
+#define EMU_T_POWER_ON  15000000U                       /*VCC to the first instruction*/
+#define EMU_T_INIT1     4100000U                        /*after the first 8-bit function set*/
+#define EMU_T_INIT2     100000U                         /*after the second*/
+#define EMU_T_EXEC      37000U                          /*most instructions and data writes*/
+#define EMU_T_CLEAR     1520000U                        /*clear display and return home*/
+
+#define EMU_DDRAM_SIZE  0x80U
+#define EMU_LINE_LEN    16U
+
+GPIO_Type LcdEmuGpio;
+
+static INT64U emuTime;                                  /*virtual time in ns*/
+static INT32U emuPins;                                  /*last port value*/
+static INT64U emuRSChange;
+static INT64U emuDBChange;
+static INT64U emuERise;
+static INT64U emuEFall;
+static INT8U emuEdges;                                  /*1 once E has risen and fallen since the reset*/
+static INT64U emuBusyUntil;
+static INT32U emuViolations;
+static INT8U emuInitStep;                               /*8-bit function sets seen, 4 when in 4-bit mode*/
+static INT8U emuNibHi;
+static INT8U emuNibRS;
+static INT8U emuNibPending;
+static INT8C emuDDRAM[EMU_DDRAM_SIZE];
+static INT8U emuAC;
+static INT8U emuInc;                                    /*entry mode I/D*/
+static INT8U emuCtrl;                                   /*display control D, C, B*/
+static INT8U emuLines;                                  /*function set N*/
+static INT8U emuCGRAM;                                  /*1 when data goes to CGRAM*/
+
+static void emuViolation(const char *what);
+static void emuLatch(INT8U rs, INT8U nib);
+static void emuExec(INT8U rs, INT8U byte);
+static void emuStep(INT8S dir);
+
+void LcdEmuReset(void){
+    emuTime = 0;
+    emuPins = 0;
+    LcdEmuGpio.PDOR = 0;
+    LcdEmuGpio.PDDR = 0;
+    emuRSChange = 0;
+    emuDBChange = 0;
+    emuERise = 0;
+    emuEFall = 0;
+    emuEdges = 0;
+    emuBusyUntil = 0;
+    emuViolations = 0;
+    emuInitStep = 0;
+    emuNibPending = 0;
+    memset(emuDDRAM, '?', sizeof(emuDDRAM));            /*contents are unknown until cleared*/
+    emuAC = 0;
+    emuInc = 1;
+    emuCtrl = 0;
+    emuLines = 0;
+    emuCGRAM = 0;
+}
+
+void LcdEmuWrite(INT32U pdor){
+    INT32U changed;
+    emuTime += LCD_EMU_WR_NS;
+    changed = (emuPins ^ pdor) & EMU_PINS;
+    if(((LcdEmuGpio.PDDR & EMU_PINS) != EMU_PINS) && (changed != 0)){
+        emuViolation("LCD pins are not outputs");
+    }else{}
+    if((changed & EMU_RS_BIT) != 0){
+        if((emuPins & EMU_E_BIT) != 0){
+            emuViolation("RS changed while E high");
+        }else if((emuEdges != 0) && ((emuTime - emuEFall) < EMU_T_AH)){
+            emuViolation("tAH, RS hold after E fall");
+        }else{}
+        emuRSChange = emuTime;
+    }else{}
+    if((changed & EMU_DB_MASK) != 0){
+        if((emuEdges != 0) && ((emuPins & EMU_E_BIT) == 0) && ((emuTime - emuEFall) < EMU_T_H)){
+            emuViolation("tH, data hold after E fall");
+        }else{}
+        emuDBChange = emuTime;
+    }else{}
+    if(((changed & EMU_E_BIT) != 0) && ((pdor & EMU_E_BIT) != 0)){            /*E rise*/
+        if((emuTime - emuRSChange) < EMU_T_AS){
+            emuViolation("tAS, RS setup to E rise");
+        }else{}
+        if((emuEdges != 0) && ((emuTime - emuERise) < EMU_T_CYCE)){
+            emuViolation("tcycE, enable cycle");
+        }else{}
+        if(emuTime < emuBusyUntil){
+            emuViolation("execution time, write while busy");
+        }else{}
+        emuERise = emuTime;
+    }else if(((changed & EMU_E_BIT) != 0) && ((pdor & EMU_E_BIT) == 0)){     /*E fall*/
+        if((emuTime - emuERise) < EMU_T_PWEH){
+            emuViolation("PWEH, E pulse width");
+        }else{}
+        if((emuTime - emuDBChange) < EMU_T_DSW){
+            emuViolation("tDSW, data setup to E fall");
+        }else{}
+        emuEFall = emuTime;
+        emuEdges = 1;
+        emuLatch((INT8U)((pdor & EMU_RS_BIT) != 0), (INT8U)((pdor & EMU_DB_MASK) >> EMU_DB_SHIFT));
+    }else{}
+    emuPins = pdor;
+    LcdEmuGpio.PDOR = pdor;
+}
+
+INT32U LcdEmuRead(void){
+    return emuPins;
+}
+
+void LcdEmuHwInit(void){
+    LcdEmuGpio.PDDR |= EMU_PINS;
+}
+
+void LcdEmuDelay(INT32U ns){
+    emuTime += ns;
+}
+
+INT32U LcdEmuCycles(void){
+    return (INT32U)((emuTime * (LCD_EMU_CPU_HZ/1000000U)) / 1000U);
+}
+
+INT32U LcdEmuViolations(void){
+    return emuViolations;
+}
+
+void LcdEmuGetLine(INT8U row, INT8C *line){
+    INT8U i;
+    for(i = 0; i < EMU_LINE_LEN; i++){
+        if((emuCtrl & 0x04U) == 0){                     /*display off*/
+            line[i] = ' ';
+        }else if((row != 0) && (emuLines == 0)){        /*one line mode*/
+            line[i] = ' ';
+        }else{
+            line[i] = emuDDRAM[(row * 0x40U) + i];
+        }
+    }
+    line[EMU_LINE_LEN] = '\0';
+}
+
+INT8U LcdEmuGetCursor(INT8U *row, INT8U *col){
+    *row = (INT8U)(emuAC >> 6);
+    *col = (INT8U)(emuAC & 0x3FU);
+    return emuCtrl;
+}
+
+INT8U LcdEmuIsBusy(void){
+    return (INT8U)(emuTime < emuBusyUntil);
+}
+
+/* emuViolation - prints and counts a violation.
+ * */
+static void emuViolation(const char *what){
+    emuViolations++;
+    printf("LCD VIOLATION %s at %llu ns\n", what, (unsigned long long)emuTime);
+}
+
+/* emuLatch - a nibble latched on the falling edge of E. Before the interface is set to 4 bits the nibble is a
+ * whole 8-bit instruction with DB0-DB3 not connected.
+ * */
+static void emuLatch(INT8U rs, INT8U nib){
+    if(emuInitStep < 3U){
+        if((rs != 0) || (nib != 0x3U)){
+            emuViolation("init, expected 8-bit function set");
+        }else if((emuInitStep == 0) && (emuTime < EMU_T_POWER_ON)){
+            emuViolation("init, power on wait");
+        }else{}
+        if(emuInitStep == 0){
+            emuBusyUntil = emuTime + EMU_T_INIT1;
+        }else if(emuInitStep == 1){
+            emuBusyUntil = emuTime + EMU_T_INIT2;
+        }else{
+            emuBusyUntil = emuTime + EMU_T_EXEC;
+        }
+        emuInitStep++;
+    }else if(emuInitStep == 3U){
+        if((rs != 0) || (nib != 0x2U)){
+            emuViolation("init, expected 4-bit function set");
+        }else{
+            emuInitStep++;
+        }
+        emuBusyUntil = emuTime + EMU_T_EXEC;
+    }else if(emuNibPending == 0){
+        emuNibHi = nib;
+        emuNibRS = rs;
+        emuNibPending = 1;
+    }else{
+        emuNibPending = 0;
+        if(rs != emuNibRS){
+            emuViolation("RS changed between nibbles");
+        }else{}
+        emuExec(rs, (INT8U)((emuNibHi << 4) | nib));
+    }
+}
+
+/* emuExec - runs one 8-bit instruction or data write.
+ * */
+static void emuExec(INT8U rs, INT8U byte){
+    INT64U exec = EMU_T_EXEC;
+    if(rs != 0){
+        if(emuCGRAM == 0){
+            emuDDRAM[emuAC] = (INT8C)byte;
+            emuStep((emuInc != 0) ? 1 : -1);
+        }else{}
+    }else if((byte & 0x80U) != 0){                      /*set DDRAM address*/
+        emuAC = (INT8U)(byte & 0x7FU);
+        emuCGRAM = 0;
+        if(((emuAC & 0x3FU) >= 0x28U) || ((emuLines == 0) && (emuAC > 0x4FU))){
+            emuViolation("DDRAM address out of range");
+        }else{}
+    }else if((byte & 0x40U) != 0){                      /*set CGRAM address*/
+        emuCGRAM = 1;
+    }else if((byte & 0x20U) != 0){                      /*function set*/
+        if((byte & 0x10U) != 0){
+            emuViolation("function set to 8 bits on a 4-bit bus");
+        }else{}
+        emuLines = (INT8U)((byte >> 3) & 1U);
+    }else if((byte & 0x10U) != 0){                      /*cursor or display shift*/
+        if((byte & 0x08U) == 0){
+            emuStep(((byte & 0x04U) != 0) ? 1 : -1);
+        }else{}
+    }else if((byte & 0x08U) != 0){                      /*display control*/
+        emuCtrl = (INT8U)(byte & 0x07U);
+    }else if((byte & 0x04U) != 0){                      /*entry mode set*/
+        emuInc = (INT8U)((byte >> 1) & 1U);
+        if((byte & 0x01U) != 0){
+            emuViolation("display shift on entry is not emulated");
+        }else{}
+    }else if((byte & 0x02U) != 0){                      /*return home*/
+        emuAC = 0;
+        exec = EMU_T_CLEAR;
+    }else if(byte == 0x01U){                            /*clear display*/
+        memset(emuDDRAM, ' ', sizeof(emuDDRAM));
+        emuAC = 0;
+        emuInc = 1;
+        exec = EMU_T_CLEAR;
+    }else{}
+    emuBusyUntil = emuTime + exec;
+}
+
+/* emuStep - moves the address counter one cell. In two line mode line 1 is 0x00-0x27 and line 2 0x40-0x67, each
+ * wraps into the other.
+ * */
+static void emuStep(INT8S dir){
+    if(dir > 0){
+        emuAC++;
+        if((emuLines != 0) && (emuAC == 0x28U)){
+            emuAC = 0x40U;
+        }else if((emuLines != 0) && (emuAC == 0x68U)){
+            emuAC = 0;
+        }else if((emuLines == 0) && (emuAC == 0x50U)){
+            emuAC = 0;
+        }else{}
+    }else{
+        if(emuAC == 0){
+            emuAC = (emuLines != 0) ? 0x67U : 0x4FU;
+        }else if((emuLines != 0) && (emuAC == 0x40U)){
+            emuAC = 0x27U;
+        }else{
+            emuAC--;
+        }
+    }
+}
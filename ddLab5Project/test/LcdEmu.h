@@ -0,0 +1,71 @@
+/* LcdEmu.h - Header file for LcdEmu.c - host HD44780 emulator and bus timing checker for board/LCD.c.
+ * LCD.c is built unmodified with this header forced in. The macros below route its pin writes, delays and cycle
+ * counter to the emulator, which keeps a virtual time in ns.
+ *
+ * Dominic Danis
+ * */
+#ifndef LCD_EMU_INC
+#define LCD_EMU_INC
+
+/*LCD.c hooks*/
+#define LCD_GPIO        (&LcdEmuGpio)
+#define LCD_PORT_WR(v)  LcdEmuWrite(v)
+#define LCD_PORT_RD()   LcdEmuRead()
+#define LCD_PORT_SET(b) LcdEmuWrite(LcdEmuRead() | (INT32U)(b))
+#define LCD_PORT_CLR(b) LcdEmuWrite(LcdEmuRead() & ~(INT32U)(b))
+#define LCD_HW_INIT()   LcdEmuHwInit()
+#define LCD_DLY_NS(ns)  LcdEmuDelay(ns)
+#define LCD_CYCLES()    LcdEmuCycles()
+
+/*Defined constants*/
+#define LCD_EMU_WR_NS   17U                             /*time between two GPIO stores, one 60MHz bus clock*/
+#define LCD_EMU_CPU_HZ  180000000U                      /*rate of LcdEmuCycles()*/
+
+extern GPIO_Type LcdEmuGpio;
+
+/* LcdEmuReset - no parameters and returns nothing. Powers the emulated LCD up at time 0 in 8-bit mode with an
+ * unknown display, clears the violation count.
+ * */
+void LcdEmuReset(void);
+
+/* LcdEmuWrite - takes the new port data output value and returns nothing. Advances the time by LCD_EMU_WR_NS,
+ * then checks the bus timing of any RS, E or DB4-DB7 change and latches a nibble on the falling edge of E.
+ * */
+void LcdEmuWrite(INT32U pdor);
+
+/* LcdEmuRead - no parameters, returns the port data output value.
+ * */
+INT32U LcdEmuRead(void);
+
+/* LcdEmuHwInit - no parameters and returns nothing. Stands in for the pin mux and port direction setup.
+ * */
+void LcdEmuHwInit(void);
+
+/* LcdEmuDelay - takes a time in ns and returns nothing. Advances the virtual time.
+ * */
+void LcdEmuDelay(INT32U ns);
+
+/* LcdEmuCycles - no parameters, returns the virtual time in LCD_EMU_CPU_HZ cycles, wrapping at 32 bits.
+ * */
+INT32U LcdEmuCycles(void);
+
+/* LcdEmuViolations - no parameters, returns the number of timing and protocol violations since the reset.
+ * Each one is also printed with its time.
+ * */
+INT32U LcdEmuViolations(void);
+
+/* LcdEmuGetLine - takes a 0 based row and a buffer of at least 17 chars, returns nothing. Copies the 16 visible
+ * DDRAM cells of the row and terminates the string.
+ * */
+void LcdEmuGetLine(INT8U row, INT8C *line);
+
+/* LcdEmuGetCursor - takes pointers for the 0 based row and column of the address counter, returns the display
+ * control bits, 0x04 display on, 0x02 cursor on, 0x01 blink.
+ * */
+INT8U LcdEmuGetCursor(INT8U *row, INT8U *col);
+
+/* LcdEmuIsBusy - no parameters, returns 1 while the last instruction is still executing.
+ * */
+INT8U LcdEmuIsBusy(void);
+
+#endif
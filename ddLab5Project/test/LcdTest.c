@@ -0,0 +1,163 @@
+/* LcdTest.c
+ * Runs the unmodified board/LCD.c against the LcdEmu.c HD44780 emulator. Checks that the emulator catches bad
+ * bus timing, then that LcdDispInit() and LcdTask() never break the datasheet timing and that the DDRAM and
+ * cursor the emulator rebuilt match what was written. LcdTask() is called at random intervals, many shorter than
+ * the 40us execution time, to exercise its pacing.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MCUType.h"
+#include "LcdEmu.h"
+#include "LCD.h"
+#include "TestUtil.h"
+
+#define TASK_MAX_CYCLES  ((LCD_EMU_CPU_HZ/1000000U)*10U)   /*LcdTask() must take less than 10us*/
+
+uint32_t SystemCoreClock = LCD_EMU_CPU_HZ;
+
+static INT32U maxTaskCycles = 0;
+
+/* pump - calls LcdTask() calls times with random gaps of 0-60us, and a whole 10ms slice one time in 16.
+ * */
+static void pump(INT32U calls){
+    INT32U start;
+    INT32U used;
+    while(calls > 0U){
+        start = LcdEmuCycles();
+        LcdTask();
+        used = LcdEmuCycles() - start;
+        if(used > maxTaskCycles){
+            maxTaskCycles = used;
+        }else{}
+        if((rand() % 16) == 0){
+            LcdEmuDelay(10000000U);
+        }else{
+            LcdEmuDelay((INT32U)(rand() % 60000));
+        }
+        calls--;
+    }
+}
+
+/* checkLine - takes a 0 based row and the 16 characters it should show.
+ * */
+static void checkLine(INT8U row, const char *want){
+    INT8C line[17];
+    LcdEmuGetLine(row, line);
+    if(!CHECK(strcmp(line, want) == 0)){
+        printf("  row %u is [%s], want [%s]\n", row, line, want);
+    }else{}
+}
+
+/* selfTest - bad bus sequences written straight to the emulator must be flagged.
+ * */
+static void selfTest(void){
+    LcdEmuReset();
+    LcdEmuHwInit();
+    LcdEmuDelay(20000000U);
+    LcdEmuWrite(0x3U << 3);
+    LcdEmuWrite((0x3U << 3) | 0x4U);                    /*E rises 17ns after the data, RS is not changed*/
+    LcdEmuWrite(0x3U << 3);                             /*17ns pulse*/
+    CHECK(LcdEmuViolations() == 2U);                    /*PWEH and tDSW*/
+    LcdEmuDelay(5000000U);
+    LcdEmuWrite((0x3U << 3) | 0x2U);                    /*RS and then E with no setup time*/
+    LcdEmuWrite((0x3U << 3) | 0x6U);
+    LcdEmuDelay(1000U);
+    LcdEmuWrite((0x3U << 3) | 0x2U);
+    CHECK(LcdEmuViolations() == 4U);                    /*tAS, then a data write during the init*/
+    LcdEmuReset();
+    LcdEmuHwInit();
+    LcdEmuDelay(20000000U);
+    LcdEmuWrite(0x3U << 3);
+    LcdEmuDelay(1000U);
+    LcdEmuWrite((0x3U << 3) | 0x4U);
+    LcdEmuDelay(1000U);
+    LcdEmuWrite(0x3U << 3);
+    LcdEmuDelay(1000U);
+    LcdEmuWrite((0x3U << 3) | 0x4U);                    /*second function set 2us later, needs 4.1ms*/
+    CHECK(LcdEmuViolations() == 1U);
+    printf("LcdTest: %u self test violations expected above\n", 5U);
+}
+
+int main(void){
+    INT8U row;
+    INT8U col;
+    INT8U ctrl;
+    INT32U i;
+    INT32U r;
+    INT32U k;
+    char text[2][17];
+    char str[17];
+    srand(17);
+    selfTest();
+
+    LcdEmuReset();
+    LcdDispInit();
+    CHECK(LcdEmuViolations() == 0U);
+    ctrl = LcdEmuGetCursor(&row, &col);
+    CHECK(ctrl == 0x04U);                               /*display on, cursor off*/
+    CHECK((row == 0U) && (col == 0U));
+    checkLine(0, "                ");
+    checkLine(1, "                ");
+
+    LcdDispString("HELLO");
+    LcdCursorMove(LCD_ROW_2, LCD_COL_3);
+    LcdDispString("WORLD 123");
+    LcdDispDecWord(42U, 4U, LCD_DEC_MODE_LZ);
+    pump(400U);
+    checkLine(0, "HELLO           ");
+    checkLine(1, "  WORLD 1230042 ");
+
+    LcdDispLineClear(LCD_ROW_1);
+    LcdDispString("ARMED");
+    LcdCursorMove(LCD_ROW_1, LCD_COL_14);
+    LcdDispString("ABCDE");                             /*D and E are past column 16*/
+    LcdCursorMove(LCD_ROW_2, LCD_COL_1);
+    LcdDispHexWord(0xBEEFU, 4U);
+    LcdBSpace();
+    LcdDispChar('Z');
+    pump(400U);
+    checkLine(0, "ARMED        ABC");
+    checkLine(1, "BEEZRLD 1230042 ");
+
+    LcdCursorMode(1U, 1U);
+    LcdCursorMove(LCD_ROW_1, LCD_COL_5);
+    pump(100U);
+    ctrl = LcdEmuGetCursor(&row, &col);
+    CHECK(ctrl == 0x07U);
+    CHECK((row == 0U) && (col == 4U));
+    LcdCursorMode(0U, 0U);
+    LcdDispClear();
+    pump(400U);
+    CHECK(LcdEmuGetCursor(&row, &col) == 0x04U);
+    checkLine(0, "                ");
+    checkLine(1, "                ");
+
+    /*Random rewrites with only part of the flush between them*/
+    memset(text, ' ', sizeof(text));
+    text[0][16] = '\0';
+    text[1][16] = '\0';
+    for(i = 0; i < 2000U; i++){
+        r = (INT32U)(rand() % 2);
+        k = (INT32U)(rand() % 17);
+        for(col = 0; col < k; col++){
+            str[col] = (char)('A' + (rand() % 26));
+        }
+        str[k] = '\0';
+        LcdDispLineClear((INT8U)(r + 1U));
+        LcdDispString(str);
+        memset(text[r], ' ', 16);
+        memcpy(text[r], str, k);
+        pump((INT32U)(rand() % 20));
+    }
+    pump(2000U);
+    checkLine(0, text[0]);
+    checkLine(1, text[1]);
+
+    CHECK(LcdEmuViolations() == 0U);
+    CHECK(maxTaskCycles < TASK_MAX_CYCLES);
+    printf("LcdTest: longest LcdTask() %u cycles\n", (unsigned)maxTaskCycles);
+    return TestDone("LcdTest");
+}
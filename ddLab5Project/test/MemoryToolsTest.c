@@ -0,0 +1,164 @@
+/* MemoryToolsTest.c
+ * Host test of source/MemoryTools.c. MemChkSum() is checked against a plain byte by byte sum for every start
+ * alignment and every length from 0 to 67 bytes past the start, so each mix of head bytes, unrolled words, single
+ * words and tail bytes is covered along with the inclusive end byte. The bytes around each range are non-zero so
+ * a byte read outside it changes the sum. A long run of 0xFF checks the truncation to 16 bits.
+ * The CRC functions run against the CRC module model in CrcSim.c and are checked against SoftCRC.c for both
+ * profiles over the same alignments and lengths, in one piece and split at every point. The number of 8 and
+ * 32-bit writes checks that only aligned words are written as words.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MCUType.h"
+#include "MemoryTools.h"
+#include "SoftCRC.h"
+#include "CrcSim.h"
+#include "TestUtil.h"
+
+#define MAX_LEN     67U                                 /*endaddr - startaddr*/
+#define MAX_HEAD    8U                                  /*start offsets, two of each alignment*/
+#define LONG_LEN    70000U                              /*255 times this is well past 2^16*/
+
+static INT32U memBuf[64];                               /*word aligned*/
+static INT8U longBuf[LONG_LEN];
+
+/* refSum - takes the first and last byte, returns the 16-bit sum of the bytes, one at a time.
+ * */
+static INT16U refSum(const INT8U *start, const INT8U *end){
+    INT16U sum = 0;
+    while(start <= end){
+        sum = (INT16U)(sum + *start);
+        start++;
+    }
+    return sum;
+}
+
+/* testChkSumAlign - every start offset and length against refSum().
+ * */
+static void testChkSumAlign(void){
+    INT8U *buf = (INT8U *)memBuf;
+    INT8U *start;
+    INT32U head;
+    INT32U len;
+    INT32U i;
+    INT16U got;
+    INT16U want;
+    INT32U bad = 0;
+    srand(5);
+    for(i = 0; i < sizeof(memBuf); i++){
+        buf[i] = (INT8U)((rand() % 255) + 1);           /*never 0*/
+    }
+    for(head = 0; head < MAX_HEAD; head++){
+        for(len = 0; len <= MAX_LEN; len++){
+            start = &buf[head + 4U];                    /*leaves a guard byte before every start*/
+            got = MemChkSum(start, start + len);
+            want = refSum(start, start + len);
+            if(got != want){
+                if(bad < 5U){
+                    printf("  start %u end +%u: 0x%04X, byte sum 0x%04X\n", head + 4U, len, got, want);
+                }else{}
+                bad++;
+            }else{}
+        }
+    }
+    CHECK(bad == 0);
+}
+
+/* testChkSumWrap - a long run of 0xFF from each alignment, the sum wraps many times.
+ * */
+static void testChkSumWrap(void){
+    INT32U head;
+    memset(longBuf, 0xFF, sizeof(longBuf));
+    for(head = 0; head < 4U; head++){
+        CHECK(MemChkSum(&longBuf[head], &longBuf[LONG_LEN - 1U]) == refSum(&longBuf[head], &longBuf[LONG_LEN - 1U]));
+    }
+    CHECK(MemChkSum(&longBuf[0], &longBuf[LONG_LEN - 1U]) == (INT16U)(LONG_LEN*0xFFU));
+    CHECK(MemChkSum(&longBuf[7], &longBuf[7]) == 0xFFU);
+}
+
+/* testCRCCheck - the "123456789" check values, CRC-16/ARC complemented and the zlib CRC-32.
+ * */
+static void testCRCCheck(void){
+    static const INT8U check[] = "123456789";
+    CrcSimReset();
+    MemCRCInit(MEM_CRC32);
+    MemCRCUpdate(check, &check[8]);
+    CHECK(MemCRCResult() == 0xCBF43926U);
+    MemCRCInit(MEM_CRC16);
+    MemCRCUpdate(check, &check[8]);
+    CHECK(MemCRCResult() == (0xBB3DU ^ 0xFFFFU));
+    MemCRCConfig();
+    CHECK(MemCRCGet((INT8U *)check, (INT8U *)&check[8]) == (0xBB3DU ^ 0xFFFFU));
+    CHECK(CrcSimErrors() == 0);
+}
+
+/* testCRCAlign - takes a profile, every start offset and length against SoftCRCCompute(), in one piece and in
+ * two.
+ * */
+static void testCRCAlign(MEM_CRC_PROFILE profile){
+    INT8U *buf = (INT8U *)memBuf;
+    INT8U *start;
+    INT32U head;
+    INT32U len;
+    INT32U split;
+    INT32U want;
+    INT32U bad = 0;
+    INT32U bad_split = 0;
+    for(head = 0; head < MAX_HEAD; head++){
+        for(len = 0; len <= MAX_LEN; len++){
+            start = &buf[head + 4U];
+            want = SoftCRCCompute((profile == MEM_CRC32) ? SOFT_CRC32 : SOFT_CRC16, start, len + 1U);
+            MemCRCInit(profile);
+            MemCRCUpdate(start, start + len);
+            if(MemCRCResult() != want){
+                if(bad < 5U){
+                    printf("  profile %u start %u end +%u: 0x%08X, SoftCRC 0x%08X\n", profile, head + 4U, len,
+                           MemCRCResult(), want);
+                }else{}
+                bad++;
+            }else{}
+            for(split = 1; split <= len; split++){
+                MemCRCInit(profile);
+                MemCRCUpdate(start, start + split - 1U);
+                MemCRCUpdate(start + split, start + len);
+                if(MemCRCResult() != want){
+                    bad_split++;
+                }else{}
+            }
+        }
+    }
+    CHECK(bad == 0);
+    CHECK(bad_split == 0);
+    CHECK(CrcSimErrors() == 0);
+}
+
+/* testCRCWrites - a range of 3 head bytes, 15 words and 3 tail bytes plus the end byte is written as 7 bytes
+ * and 15 words, a single byte as 1 byte.
+ * */
+static void testCRCWrites(void){
+    INT8U *buf = (INT8U *)memBuf;
+    CrcSimReset();
+    MemCRCInit(MEM_CRC32);
+    MemCRCUpdate(&buf[1], &buf[67]);
+    CHECK(CrcSimByteWrites() == 7U);
+    CHECK(CrcSimWordWrites() == 15U);
+    CrcSimReset();
+    MemCRCInit(MEM_CRC16);
+    MemCRCUpdate(&buf[5], &buf[5]);
+    CHECK(CrcSimByteWrites() == 1U);
+    CHECK(CrcSimWordWrites() == 0);
+}
+
+int main(void){
+    testChkSumAlign();
+    testChkSumWrap();
+    testCRCCheck();
+    CrcSimReset();
+    testCRCAlign(MEM_CRC16);
+    testCRCAlign(MEM_CRC32);
+    testCRCWrites();
+    return TestDone("MemoryToolsTest");
+}
@@ -0,0 +1,124 @@
+/* PinTest.c
+ * Host test of source/Pin.c. Entry, clear, digit timeout, the doubling lockout across the 32-bit ms wrap, the
+ * lockout cap and over-length entries. The code table is the Lab5Main.c table plus an 8 digit code made with
+ * tools/PinHash.py 3:12345678.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include "MCUType.h"
+#include "Pin.h"
+#include "TestUtil.h"
+
+#define KEY_GAP_MS  300U
+
+static const PIN_CODE_T testCodes[] = {
+    {{0x3A9369E6U, 0x04E2A882U}, {0xAC6AAC3DU, 0x21239EA5U}, 1U, 0U},                /*1234*/
+    {{0x4E57479DU, 0x76870155U}, {0x649282FAU, 0xFCB1EF56U}, 1U, PIN_FLAG_DURESS},  /*4321*/
+    {{0xB864FF19U, 0x85BA131FU}, {0x4541DCA6U, 0x930713BAU}, 2U, 0U},                /*246810*/
+    {{0x03CAF174U, 0x4A59F8DEU}, {0x3313549EU, 0xDB116444U}, 3U, 0U}                 /*12345678*/
+};
+
+static PIN_T pin;
+static INT32U ms;
+
+/* type - enters keys KEY_GAP_MS apart, returns the result of the last one.
+ * */
+static PIN_RESULT type(const char *keys){
+    PIN_RESULT result = PIN_IDLE;
+    while(*keys != '\0'){
+        result = PinKey(&pin, *keys, ms);
+        keys++;
+        ms += KEY_GAP_MS;
+    }
+    return result;
+}
+
+static void testEntry(void){
+    PinInit(&pin, testCodes, (INT8U)(sizeof(testCodes)/sizeof(testCodes[0])));
+    ms = 1000U;
+    CHECK(type("1234#") == PIN_OK);
+    CHECK(PinGetUser(&pin) == 1U);
+    CHECK(type("4321#") == PIN_DURESS);
+    CHECK(type("246810#") == PIN_OK);
+    CHECK(PinGetUser(&pin) == 2U);
+    CHECK(type("12345678#") == PIN_OK);
+    CHECK(PinGetUser(&pin) == 3U);
+    CHECK(type("12*1234#") == PIN_OK);
+    CHECK(type("123") == PIN_ENTRY);
+    CHECK(PinGetLength(&pin) == 3U);
+    CHECK(type("*") == PIN_IDLE);
+    CHECK(PinGetLength(&pin) == 0U);
+    CHECK(type("#") == PIN_IDLE);                       /*nothing to check*/
+    CHECK(type("123#") == PIN_BAD);                     /*short*/
+    CHECK(type("12345#") == PIN_BAD);
+    CHECK(type("1234#") == PIN_OK);                     /*clears the failures*/
+    CHECK(type("12") == PIN_ENTRY);
+    ms += PIN_DIGIT_TIMEOUT;
+    CHECK(PinPoll(&pin, ms) == PIN_TIMEOUT);
+    CHECK(PinPoll(&pin, ms) == PIN_IDLE);
+    CHECK(type("34#") == PIN_BAD);                      /*the old digits are gone*/
+}
+
+/* testOverflow - digits past PIN_MAX_DIGITS make the entry fail even when the first 8 are a code.
+ * */
+static void testOverflow(void){
+    PinInit(&pin, testCodes, (INT8U)(sizeof(testCodes)/sizeof(testCodes[0])));
+    ms = 1000U;
+    CHECK(type("123456789") == PIN_ENTRY);
+    CHECK(PinGetLength(&pin) == PIN_MAX_DIGITS);
+    CHECK(type("#") == PIN_BAD);
+    CHECK(type("1234567890#") == PIN_BAD);
+    CHECK(type("123456780000#") == PIN_LOCKED);         /*third failure*/
+    CHECK(PinGetLockouts(&pin) == 1U);
+    ms += PIN_LOCK_MS;
+    CHECK(type("12345678#") == PIN_OK);                 /*the same code at the right length*/
+    CHECK(type("123456789*12345678#") == PIN_OK);       /*clear drops the overflow*/
+    CHECK(type("123456789") == PIN_ENTRY);
+    ms += PIN_DIGIT_TIMEOUT;
+    CHECK(PinPoll(&pin, ms) == PIN_TIMEOUT);            /*so does the timeout*/
+    CHECK(type("1234#") == PIN_OK);
+}
+
+/* testLockout - lockouts double from PIN_LOCK_MS, work across the ms wrap and stop at PIN_LOCK_MAX_SHIFT.
+ * */
+static void testLockout(void){
+    INT32U i;
+    PinInit(&pin, testCodes, (INT8U)(sizeof(testCodes)/sizeof(testCodes[0])));
+    ms = 1000U;
+    CHECK(type("0000#") == PIN_BAD);
+    CHECK(type("0000#") == PIN_BAD);
+    CHECK(type("0000#") == PIN_LOCKED);
+    CHECK(type("1234#") == PIN_LOCKED);                 /*ignored*/
+    ms += PIN_LOCK_MS;
+    CHECK(PinPoll(&pin, ms) == PIN_IDLE);
+    CHECK(type("0000#") == PIN_LOCKED);                 /*fourth failure, twice as long*/
+    ms += PIN_LOCK_MS;
+    CHECK(type("1234#") == PIN_LOCKED);
+    ms += PIN_LOCK_MS;
+    CHECK(type("1234#") == PIN_OK);
+    CHECK(PinGetLockouts(&pin) == 2U);
+
+    ms = 0xFFFFF000U;                                   /*lockout across the wrap*/
+    CHECK(type("9#") == PIN_BAD);
+    CHECK(type("9#") == PIN_BAD);
+    CHECK(type("9999#") == PIN_LOCKED);
+    ms += PIN_LOCK_MS - 10000U;
+    CHECK(PinPoll(&pin, ms) == PIN_LOCKED);
+    ms += 10000U;
+    CHECK(PinPoll(&pin, ms) == PIN_IDLE);
+
+    for(i = 0; i < 20U; i++){
+        CHECK(type("5555#") == PIN_LOCKED);
+        CHECK((pin.lock_until - ms) <= (PIN_LOCK_MS << PIN_LOCK_MAX_SHIFT));
+        ms = pin.lock_until;
+    }
+    CHECK(PinGetLockouts(&pin) == 23U);
+}
+
+int main(void){
+    testEntry();
+    testOverflow();
+    testLockout();
+    return TestDone("PinTest");
+}
@@ -0,0 +1,174 @@
+/* ProfileTest.c
+ * Host test of source/Profile.c with PROF_CYCCNT on the CoreSim DWT cycle counter as a fake clock. Checks the
+ * count, min, max, sum and average of a known set of samples, the log2 histogram bins at their edges and the top
+ * bin clamp, a measurement across the 32-bit counter wrap, that IDs are independent and out of range IDs are
+ * ignored, that ProfileInit() resets everything, and that ProfileGetStats() leaves PRIMASK as it found it.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include "MCUType.h"
+#include "Profile.h"
+#include "BasicIO.h"
+#include "CoreSim.h"
+#include "TestUtil.h"
+
+/*ProfileDump() is not tested, BasicIO is stubbed out*/
+void BIOWrite(INT8C c){ (void)c; }
+void BIOPutStrg(const INT8C *const strg){ (void)strg; }
+void BIOOutDecWord(INT32U binword, INT8U field, BIO_OUTDEC_MODE mode){ (void)binword; (void)field; (void)mode; }
+void BIOOutCRLF(void){}
+
+/* measure - takes a profile ID, the clock at the start and the length in cycles, returns nothing. Runs a
+ * ProfileStart()/ProfileStop() pair on the fake clock.
+ * */
+static void measure(INT8U id, INT32U at, INT32U cycles){
+    INT32U start;
+    CoreSimDwt.CYCCNT = at;
+    start = ProfileStart();
+    CHECK(start == at);
+    CoreSimDwt.CYCCNT = at + cycles;
+    ProfileStop(id, start);
+}
+
+/* isEmpty - takes the statistics, returns 1 if they are the ones of an ID with no samples.
+ * */
+static int isEmpty(const PROF_STATS_T *stats){
+    INT8U bin;
+    int empty = (stats->count == 0) && (stats->min == 0xFFFFFFFFU) && (stats->max == 0) && (stats->sum == 0);
+    for(bin = 0; bin < PROF_NUM_BINS; bin++){
+        if(stats->hist[bin] != 0){
+            empty = 0;
+        }else{}
+    }
+    return empty;
+}
+
+static void testInit(void){
+    PROF_STATS_T stats;
+    INT8U id;
+    CoreSimReset();
+    CoreSimDwt.CYCCNT = 12345U;
+    ProfileInit();
+    CHECK((CoreSimCoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) != 0);
+    CHECK((CoreSimDwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0);
+    CHECK(CoreSimDwt.CYCCNT == 0);
+    for(id = 0; id < PROF_NUM_IDS; id++){
+        ProfileGetStats(id, &stats);
+        CHECK(isEmpty(&stats));
+    }
+}
+
+static void testStats(void){
+    PROF_STATS_T stats;
+    ProfileInit();
+    measure(3U, 1000U, 100U);
+    measure(3U, 5000U, 50U);
+    measure(3U, 7U, 300U);
+    measure(3U, 900U, 0U);
+    ProfileGetStats(3U, &stats);
+    CHECK(stats.count == 4U);
+    CHECK(stats.min == 0U);
+    CHECK(stats.max == 300U);
+    CHECK(stats.sum == 450U);
+    CHECK((stats.sum/stats.count) == 112U);
+    CHECK(stats.hist[0] == 1U);                         /*0*/
+    CHECK(stats.hist[6] == 1U);                         /*50 is 6 bits*/
+    CHECK(stats.hist[7] == 1U);                         /*100*/
+    CHECK(stats.hist[9] == 1U);                         /*300*/
+    ProfileGetStats(2U, &stats);                        /*other IDs untouched*/
+    CHECK(isEmpty(&stats));
+    ProfileGetStats(4U, &stats);
+    CHECK(isEmpty(&stats));
+}
+
+static void testWrap(void){
+    PROF_STATS_T stats;
+    ProfileInit();
+    measure(PROF_ID_TSI0, 0xFFFFFF00U, 0x200U);         /*stop reads 0x100*/
+    ProfileGetStats(PROF_ID_TSI0, &stats);
+    CHECK((stats.count == 1U) && (stats.min == 0x200U) && (stats.max == 0x200U));
+    CHECK(stats.hist[10] == 1U);
+}
+
+static void testBins(void){
+    PROF_STATS_T stats;
+    INT8U i;
+    ProfileInit();
+    ProfileRecord(PROF_ID_SLICE, 1U);
+    ProfileRecord(PROF_ID_SLICE, 2U);
+    ProfileRecord(PROF_ID_SLICE, 3U);
+    ProfileRecord(PROF_ID_SLICE, 4U);
+    ProfileRecord(PROF_ID_SLICE, 0x3FFFFFFFU);
+    ProfileRecord(PROF_ID_SLICE, 0x40000000U);
+    ProfileRecord(PROF_ID_SLICE, 0x80000000U);          /*32 bits, clamped to the top bin*/
+    ProfileRecord(PROF_ID_SLICE, 0xFFFFFFFFU);
+    ProfileGetStats(PROF_ID_SLICE, &stats);
+    CHECK(stats.hist[1] == 1U);
+    CHECK(stats.hist[2] == 2U);
+    CHECK(stats.hist[3] == 1U);
+    CHECK(stats.hist[30] == 1U);
+    CHECK(stats.hist[31] == 3U);
+    CHECK(stats.count == 8U);
+    CHECK(stats.min == 1U);
+    CHECK(stats.max == 0xFFFFFFFFU);
+    for(i = 0; i < 4U; i++){                            /*the sum must not wrap at 32 bits*/
+        ProfileRecord(PROF_ID_TOUCH, 0xFFFFFFFFU);
+    }
+    ProfileGetStats(PROF_ID_TOUCH, &stats);
+    CHECK(stats.sum == (4ULL*0xFFFFFFFFULL));
+    CHECK((stats.sum/stats.count) == 0xFFFFFFFFU);
+}
+
+static void testBadId(void){
+    PROF_STATS_T stats;
+    INT8U id;
+    ProfileInit();
+    ProfileRecord(PROF_NUM_IDS, 10U);
+    ProfileRecord(0xFFU, 10U);
+    measure(PROF_NUM_IDS, 0U, 10U);
+    for(id = 0; id < PROF_NUM_IDS; id++){
+        ProfileGetStats(id, &stats);
+        CHECK(isEmpty(&stats));
+    }
+    stats.count = 99U;
+    stats.hist[5] = 7U;
+    ProfileGetStats(PROF_NUM_IDS, &stats);              /*cleared, not left as it was*/
+    CHECK(isEmpty(&stats));
+}
+
+static void testReset(void){
+    PROF_STATS_T stats;
+    measure(0U, 0U, 40U);
+    measure(PROF_ID_DMA0, 0U, 40U);
+    ProfileInit();
+    ProfileGetStats(0U, &stats);
+    CHECK(isEmpty(&stats));
+    ProfileGetStats(PROF_ID_DMA0, &stats);
+    CHECK(isEmpty(&stats));
+    measure(0U, 0U, 70U);                               /*min and max start over*/
+    ProfileGetStats(0U, &stats);
+    CHECK((stats.count == 1U) && (stats.min == 70U) && (stats.max == 70U) && (stats.sum == 70U));
+}
+
+static void testPrimask(void){
+    PROF_STATS_T stats;
+    CoreSimSetPrimask(0U);
+    ProfileGetStats(0U, &stats);
+    CHECK(CoreSimGetPrimask() == 0U);
+    CoreSimSetPrimask(1U);
+    ProfileGetStats(0U, &stats);
+    CHECK(CoreSimGetPrimask() == 1U);
+    CoreSimSetPrimask(0U);
+}
+
+int main(void){
+    testInit();
+    testStats();
+    testWrap();
+    testBins();
+    testBadId();
+    testReset();
+    testPrimask();
+    return TestDone("ProfileTest");
+}
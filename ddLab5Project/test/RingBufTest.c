@@ -0,0 +1,238 @@
+/* RingBufTest.c
+ * Host test of board/RingBuf.c. Covers the empty and full buffer with the byte and block calls, the drop count
+ * for a full Put() and a partly fitting Write(), the data and the 16-bit indexes wrapping past the end of the
+ * storage and past 65535, and the largest size, 32768. A stress run has a producer and a consumer thread on one
+ * buffer with a random mix of byte and block calls. Every byte must arrive once and in order, and the drop
+ * count must equal the failed writes the producer saw. RB_BARRIER is a full fence in this build.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "MCUType.h"
+#include "RingBuf.h"
+#include "TestUtil.h"
+
+#define SMALL_SIZE      16U
+#define MAX_SIZE        32768U
+#define STRESS_SIZE     64U
+#define STRESS_BYTES    10000000U
+#define STRESS_BLOCK    40U                             /*longest block, more than half the buffer*/
+
+static RING_BUF_T ring;
+static INT8U smallBuf[SMALL_SIZE];
+static INT8U bigBuf[MAX_SIZE];
+static INT8U stressBuf[STRESS_SIZE];
+static INT32U stressDrops;                              /*failed bytes the producer saw*/
+static INT32U stressBad;                                /*bytes the consumer got out of order*/
+
+/* testEmptyFull - empty and full with the byte and block calls, and the drop count.
+ * */
+static void testEmptyFull(void){
+    INT8U data[SMALL_SIZE + 4U];
+    INT8U byte = 0xA5U;
+    INT32U i;
+    RingBufInit(&ring, smallBuf, SMALL_SIZE);
+    CHECK(RingBufCount(&ring) == 0);
+    CHECK(RingBufSpace(&ring) == SMALL_SIZE);
+    CHECK(RingBufGet(&ring, &byte) == 0);
+    CHECK(byte == 0xA5U);                               /*not written when empty*/
+    CHECK(RingBufRead(&ring, data, 4U) == 0);
+    for(i = 0; i < SMALL_SIZE; i++){
+        CHECK(RingBufPut(&ring, (INT8U)i) == 1U);
+    }
+    CHECK(RingBufCount(&ring) == SMALL_SIZE);
+    CHECK(RingBufSpace(&ring) == 0);
+    CHECK(RingBufPut(&ring, 0xEEU) == 0);
+    CHECK(ring.dropped == 1U);
+    CHECK(RingBufWrite(&ring, data, 3U) == 0);
+    CHECK(ring.dropped == 4U);
+    CHECK(RingBufRead(&ring, data, (INT16U)sizeof(data)) == SMALL_SIZE);
+    for(i = 0; i < SMALL_SIZE; i++){
+        CHECK(data[i] == (INT8U)i);
+    }
+    CHECK(RingBufCount(&ring) == 0);
+    for(i = 0; i < sizeof(data); i++){
+        data[i] = (INT8U)(0x40U + i);
+    }
+    CHECK(RingBufWrite(&ring, data, 10U) == 10U);
+    CHECK(RingBufWrite(&ring, &data[10], 10U) == 6U);   /*4 do not fit*/
+    CHECK(ring.dropped == 8U);
+    CHECK(RingBufSpace(&ring) == 0);
+    for(i = 0; i < SMALL_SIZE; i++){
+        CHECK((RingBufGet(&ring, &byte) == 1U) && (byte == (INT8U)(0x40U + i)));
+    }
+    CHECK(RingBufGet(&ring, &byte) == 0);
+    CHECK(ring.dropped == 8U);                          /*only the producer counts*/
+}
+
+/* testWrap - blocks that wrap the storage, with the indexes started just below 65536.
+ * */
+static void testWrap(void){
+    INT8U data[SMALL_SIZE];
+    INT8U out[SMALL_SIZE];
+    INT32U next_in = 0;
+    INT32U next_out = 0;
+    INT32U round;
+    INT32U len;
+    INT32U i;
+    INT32U bad = 0;
+    RingBufInit(&ring, smallBuf, SMALL_SIZE);
+    ring.head = 0xFFF3U;                                /*empty, 13 bytes below the wrap*/
+    ring.tail = 0xFFF3U;
+    for(round = 0; round < 200U; round++){
+        len = (round % 11U) + 1U;
+        if(len > RingBufSpace(&ring)){
+            len = RingBufSpace(&ring);
+        }else{}
+        for(i = 0; i < len; i++){
+            data[i] = (INT8U)(next_in + i);
+        }
+        if(RingBufWrite(&ring, data, (INT16U)len) != len){
+            bad++;
+        }else{}
+        next_in += len;
+        if(RingBufCount(&ring) != (INT16U)(next_in - next_out)){
+            bad++;
+        }else{}
+        len = RingBufRead(&ring, out, (INT16U)((round % 7U) + 6U));
+        for(i = 0; i < len; i++){
+            if(out[i] != (INT8U)(next_out + i)){
+                bad++;
+            }else{}
+        }
+        next_out += len;
+    }
+    while(RingBufGet(&ring, &out[0]) != 0){
+        if(out[0] != (INT8U)next_out){
+            bad++;
+        }else{}
+        next_out++;
+    }
+    CHECK(bad == 0);
+    CHECK(next_in == next_out);
+    CHECK(ring.head < 0xFFF3U);                         /*the indexes went past 65535*/
+    CHECK(ring.dropped == 0);
+}
+
+/* testMaxSize - the largest buffer fills to 32768 bytes with the count still right.
+ * */
+static void testMaxSize(void){
+    INT32U i;
+    INT8U byte;
+    INT32U bad = 0;
+    RingBufInit(&ring, bigBuf, (INT16U)MAX_SIZE);
+    ring.head = 0xC000U;
+    ring.tail = 0xC000U;
+    for(i = 0; i < MAX_SIZE; i++){
+        if(RingBufPut(&ring, (INT8U)(i*7U)) != 1U){
+            bad++;
+        }else{}
+    }
+    CHECK(RingBufCount(&ring) == MAX_SIZE);
+    CHECK(RingBufSpace(&ring) == 0);
+    CHECK(RingBufPut(&ring, 0) == 0);
+    CHECK(ring.dropped == 1U);
+    for(i = 0; i < MAX_SIZE; i++){
+        if((RingBufGet(&ring, &byte) != 1U) || (byte != (INT8U)(i*7U))){
+            bad++;
+        }else{}
+    }
+    CHECK(bad == 0);
+    CHECK(RingBufCount(&ring) == 0);
+}
+
+/* stressProducer - thread. Sends STRESS_BYTES numbered bytes, retrying the ones that do not fit.
+ * */
+static void *stressProducer(void *arg){
+    INT8U data[STRESS_BLOCK];
+    INT32U seed = 1U;
+    INT32U sent = 0;
+    INT32U len;
+    INT32U n;
+    INT32U i;
+    (void)arg;
+    while(sent < STRESS_BYTES){
+        seed = seed*1103515245U + 12345U;
+        if(((seed >> 16) & 1U) != 0){
+            len = ((seed >> 17) % STRESS_BLOCK) + 1U;
+            if(len > (STRESS_BYTES - sent)){
+                len = STRESS_BYTES - sent;
+            }else{}
+            for(i = 0; i < len; i++){
+                data[i] = (INT8U)(sent + i);
+            }
+            n = RingBufWrite(&ring, data, (INT16U)len);
+            stressDrops += len - n;
+            sent += n;
+        }
+        else{
+            n = RingBufPut(&ring, (INT8U)sent);
+            stressDrops += 1U - n;
+            sent += n;
+        }
+        if(n == 0){
+            sched_yield();
+        }else{}
+    }
+    return NULL;
+}
+
+/* stressConsumer - thread. Receives STRESS_BYTES bytes and counts the ones out of order.
+ * */
+static void *stressConsumer(void *arg){
+    INT8U data[STRESS_BLOCK];
+    INT32U seed = 2U;
+    INT32U got = 0;
+    INT32U n;
+    INT32U i;
+    (void)arg;
+    while(got < STRESS_BYTES){
+        seed = seed*1103515245U + 12345U;
+        if(((seed >> 16) & 1U) != 0){
+            n = RingBufRead(&ring, data, (INT16U)(((seed >> 17) % STRESS_BLOCK) + 1U));
+        }
+        else{
+            n = RingBufGet(&ring, data);
+        }
+        for(i = 0; i < n; i++){
+            if(data[i] != (INT8U)(got + i)){
+                stressBad++;
+            }else{}
+        }
+        got += n;
+        if(n == 0){
+            sched_yield();
+        }else{}
+    }
+    return NULL;
+}
+
+/* testStress - a producer and a consumer thread at the same time.
+ * */
+static void testStress(void){
+    pthread_t prod;
+    pthread_t cons;
+    RingBufInit(&ring, stressBuf, STRESS_SIZE);
+    stressDrops = 0;
+    stressBad = 0;
+    CHECK(pthread_create(&cons, NULL, stressConsumer, NULL) == 0);
+    CHECK(pthread_create(&prod, NULL, stressProducer, NULL) == 0);
+    pthread_join(prod, NULL);
+    pthread_join(cons, NULL);
+    CHECK(stressBad == 0);
+    CHECK(RingBufCount(&ring) == 0);
+    CHECK(ring.dropped == stressDrops);
+    CHECK(stressDrops != 0);                            /*the buffer did fill*/
+}
+
+int main(void){
+    testEmptyFull();
+    testWrap();
+    testMaxSize();
+    testStress();
+    return TestDone("RingBufTest");
+}
@@ -0,0 +1,211 @@
+/* SchedulerTest.c
+ * Host test of source/Scheduler.c driven by a fake ms count. Checks the priority order of the tasks due in one
+ * slice with ties in table order, the first release at the offset and then every period, the catch-up rule that
+ * runs a task only once for several missed releases, the ms count wrap, and that entries past SCHED_MAX_TASKS
+ * are ignored. Profile.c is replaced by stubs that record the profile IDs.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <string.h>
+#include "MCUType.h"
+#include "Scheduler.h"
+#include "Profile.h"
+#include "TestUtil.h"
+
+#define LOG_LEN     64U
+
+static INT8U runLog[LOG_LEN];                          /*task numbers in the order they ran*/
+static INT8U runLen;
+static INT8U profLog[LOG_LEN];                         /*profile IDs in the order they were stopped*/
+static INT8U profLen;
+static INT32U runCount[SCHED_MAX_TASKS + 1U];
+
+/*Stubs*/
+INT32U ProfileStart(void){
+    return 0;
+}
+void ProfileStop(INT8U id, INT32U start){
+    (void)start;
+    if(profLen < LOG_LEN){
+        profLog[profLen] = id;
+        profLen++;
+    }else{}
+}
+void SysTickWaitEvent(const INT32U period){
+    (void)period;
+}
+INT32U SysTickGetmsCount(void){
+    return 0;
+}
+
+/* logRun - takes a task number, returns nothing.
+ * */
+static void logRun(INT8U n){
+    if(runLen < LOG_LEN){
+        runLog[runLen] = n;
+        runLen++;
+    }else{}
+    runCount[n]++;
+}
+static void task0(void){ logRun(0U); }
+static void task1(void){ logRun(1U); }
+static void task2(void){ logRun(2U); }
+static void task3(void){ logRun(3U); }
+static void task4(void){ logRun(4U); }
+static void task5(void){ logRun(5U); }
+static void task6(void){ logRun(6U); }
+static void task7(void){ logRun(7U); }
+static void task8(void){ logRun(8U); }
+
+/* clearLog - empties the run and profile logs.
+ * */
+static void clearLog(void){
+    runLen = 0;
+    profLen = 0;
+    memset(runCount, 0, sizeof(runCount));
+}
+
+/* expectRun - takes the expected task numbers as a string of digits, checks the run log and empties it.
+ * */
+static void expectRun(const char *want){
+    char got[LOG_LEN + 1U];
+    INT8U i;
+    for(i = 0; i < runLen; i++){
+        got[i] = (char)('0' + runLog[i]);
+    }
+    got[runLen] = '\0';
+    if(!CHECK(strcmp(got, want) == 0)){
+        printf("  ran [%s], want [%s]\n", got, want);
+    }else{}
+    runLen = 0;
+    profLen = 0;
+}
+
+/* testOrder - tasks due together run by priority, equal priorities in table order, profiled by table index.
+ * */
+static void testOrder(void){
+    static const SCHED_TASK_T table[] = {
+        {task0, 10U, 0U, 2U},
+        {task1, 10U, 0U, 0U},
+        {task2, 10U, 0U, 2U},
+        {task3, 10U, 0U, 1U},
+        {task4, 10U, 0U, 0U}
+    };
+    SchedInit(table, (INT8U)(sizeof(table)/sizeof(table[0])));
+    clearLog();
+    SchedDispatch(0U);
+    CHECK(profLen == 5U);
+    CHECK((profLog[0] == 1U) && (profLog[1] == 4U) && (profLog[2] == 3U) && (profLog[3] == 0U) && (profLog[4] == 2U));
+    expectRun("14302");
+    SchedDispatch(5U);                                  /*nothing due between slices*/
+    expectRun("");
+    SchedDispatch(10U);
+    expectRun("14302");
+}
+
+/* testRelease - first release at the offset, then every period.
+ * */
+static void testRelease(void){
+    static const SCHED_TASK_T table[] = {
+        {task0, 10U, 0U, 0U},
+        {task1, 20U, 10U, 0U},
+        {task2, 100U, 30U, 0U},
+        {task3, 50U, 0U, 1U}
+    };
+    INT32U ms;
+    SchedInit(table, (INT8U)(sizeof(table)/sizeof(table[0])));
+    clearLog();
+    SchedDispatch(0U);
+    expectRun("03");
+    SchedDispatch(10U);
+    expectRun("01");
+    SchedDispatch(20U);
+    expectRun("0");
+    SchedDispatch(30U);
+    expectRun("012");
+    SchedDispatch(40U);
+    expectRun("0");
+    SchedDispatch(50U);
+    expectRun("013");
+    clearLog();
+    for(ms = 60U; ms < 100060U; ms += SCHED_SLICE_MS){
+        SchedDispatch(ms);
+    }
+    CHECK(runCount[0] == 10000U);
+    CHECK(runCount[1] == 5000U);
+    CHECK(runCount[2] == 1000U);
+    CHECK(runCount[3] == 2000U);
+}
+
+/* testCatchUp - a task that missed releases runs once and its next release is the first one after ms.
+ * */
+static void testCatchUp(void){
+    static const SCHED_TASK_T table[] = {
+        {task0, 10U, 0U, 0U},
+        {task1, 30U, 10U, 0U}
+    };
+    SchedInit(table, (INT8U)(sizeof(table)/sizeof(table[0])));
+    clearLog();
+    SchedDispatch(0U);
+    expectRun("0");
+    SchedDispatch(95U);                                 /*missed 10-90 for task0 and 10, 40 and 70 for task1*/
+    expectRun("01");
+    SchedDispatch(99U);                                 /*next releases are 100 and 100*/
+    expectRun("");
+    SchedDispatch(100U);
+    expectRun("01");
+    SchedDispatch(110U);
+    expectRun("0");
+    SchedDispatch(130U);                                /*late on time: task1 due 130, task0 missed 120*/
+    expectRun("01");
+    SchedDispatch(140U);
+    expectRun("0");
+    SchedDispatch(160U);
+    expectRun("01");
+}
+
+/* testWrap - releases keep their period across the 32-bit ms wrap.
+ * */
+static void testWrap(void){
+    static const SCHED_TASK_T table[] = {
+        {task0, 10U, 0U, 0U},
+        {task1, 40U, 20U, 1U}
+    };
+    INT32U ms = 0xFFFFFF00U;
+    INT32U i;
+    SchedInit(table, (INT8U)(sizeof(table)/sizeof(table[0])));
+    SchedDispatch(0x7FFFFF00U);                         /*walk the releases up to the wrap in two catch-ups*/
+    SchedDispatch(ms);
+    clearLog();
+    for(i = 0; i < 1000U; i++){
+        ms += SCHED_SLICE_MS;
+        SchedDispatch(ms);
+    }
+    CHECK(ms < 0x10000U);                               /*the count wrapped*/
+    CHECK(runCount[0] == 1000U);
+    CHECK(runCount[1] == 250U);
+}
+
+/* testMaxTasks - entries past SCHED_MAX_TASKS never run.
+ * */
+static void testMaxTasks(void){
+    static const SCHED_TASK_T table[] = {
+        {task0, 10U, 0U, 0U}, {task1, 10U, 0U, 0U}, {task2, 10U, 0U, 0U}, {task3, 10U, 0U, 0U},
+        {task4, 10U, 0U, 0U}, {task5, 10U, 0U, 0U}, {task6, 10U, 0U, 0U}, {task7, 10U, 0U, 0U},
+        {task8, 10U, 0U, 0U}
+    };
+    SchedInit(table, (INT8U)(sizeof(table)/sizeof(table[0])));
+    clearLog();
+    SchedDispatch(0U);
+    expectRun("01234567");
+}
+
+int main(void){
+    testOrder();
+    testRelease();
+    testCatchUp();
+    testWrap();
+    testMaxTasks();
+    return TestDone("SchedulerTest");
+}
@@ -0,0 +1,137 @@
+/* SoftCRCTest.c
+ * Host test of source/SoftCRC.c. The byte, slice-by-4 and slice-by-8 updates are checked against published check
+ * values for both profiles, CRC-16/0x8005 (CRC-16/ARC complemented) and the zlib CRC-32, and against a bit at a
+ * time reference over random data. The data is also fed in pieces of mixed lengths from every start alignment,
+ * switching update functions between pieces, which must give the same CRC as one call.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MCUType.h"
+#include "SoftCRC.h"
+#include "TestUtil.h"
+
+#define DATA_LEN    300U
+#define NUM_UPDATES 3U
+
+/*A check value, the CRC of str*/
+typedef struct{
+    const char *str;
+    INT32U crc16;
+    INT32U crc32;
+}CHECK_VAL_T;
+
+typedef void (*UPDATE_FN)(SOFT_CRC_T *ctx, const INT8U *data, INT32U len);
+
+static const UPDATE_FN updateFns[NUM_UPDATES] = {SoftCRCUpdate1, SoftCRCUpdate4, SoftCRCUpdate};
+static INT8U crcData[DATA_LEN + 8U] __attribute__((aligned(8)));
+
+/* bitCRC - takes a profile, the data and its length, returns the CRC worked out one bit at a time.
+ * */
+static INT32U bitCRC(SOFT_CRC_PROFILE profile, const INT8U *data, INT32U len){
+    INT32U poly = (profile == SOFT_CRC32) ? 0xEDB88320U : 0xA001U;     /*reflected 0x04C11DB7 and 0x8005*/
+    INT32U crc = (profile == SOFT_CRC32) ? 0xFFFFFFFFU : 0U;
+    INT32U xorout = (profile == SOFT_CRC32) ? 0xFFFFFFFFU : 0xFFFFU;
+    INT8U bit;
+    while(len > 0){
+        crc ^= *data;
+        for(bit = 0; bit < 8U; bit++){
+            crc = ((crc & 1U) != 0) ? ((crc >> 1) ^ poly) : (crc >> 1);
+        }
+        data++;
+        len--;
+    }
+    return crc ^ xorout;
+}
+
+/* testCheckValues - the published check values with every update function.
+ * */
+static void testCheckValues(void){
+    static const CHECK_VAL_T vals[] = {
+        {"", 0xFFFFU, 0x00000000U},
+        {"a", 0x173EU, 0xE8B7BE43U},
+        {"123456789", 0x44C2U, 0xCBF43926U},
+        {"The quick brown fox jumps over the lazy dog", 0x0320U, 0x414FA339U}
+    };
+    SOFT_CRC_T ctx;
+    INT32U len;
+    INT32U i;
+    INT32U f;
+    for(i = 0; i < (sizeof(vals)/sizeof(vals[0])); i++){
+        len = (INT32U)strlen(vals[i].str);
+        for(f = 0; f < NUM_UPDATES; f++){
+            SoftCRCInit(&ctx, SOFT_CRC16);
+            updateFns[f](&ctx, (const INT8U *)vals[i].str, len);
+            CHECK(SoftCRCResult(&ctx) == vals[i].crc16);
+            SoftCRCInit(&ctx, SOFT_CRC32);
+            updateFns[f](&ctx, (const INT8U *)vals[i].str, len);
+            CHECK(SoftCRCResult(&ctx) == vals[i].crc32);
+        }
+        CHECK(SoftCRCCompute(SOFT_CRC16, (const INT8U *)vals[i].str, len) == vals[i].crc16);
+        CHECK(SoftCRCCompute(SOFT_CRC32, (const INT8U *)vals[i].str, len) == vals[i].crc32);
+        CHECK(bitCRC(SOFT_CRC16, (const INT8U *)vals[i].str, len) == vals[i].crc16);
+        CHECK(bitCRC(SOFT_CRC32, (const INT8U *)vals[i].str, len) == vals[i].crc32);
+    }
+}
+
+/* testPieces - takes a profile. Every start alignment and length, in one call and in pieces, against bitCRC().
+ * */
+static void testPieces(SOFT_CRC_PROFILE profile){
+    static const INT32U pieces[] = {1U, 3U, 8U, 2U, 13U, 4U, 7U, 16U, 5U, 9U, 31U, 6U};
+    SOFT_CRC_T ctx;
+    const INT8U *data;
+    INT32U head;
+    INT32U len;
+    INT32U want;
+    INT32U done;
+    INT32U n;
+    INT32U p;
+    INT32U f;
+    INT32U bad = 0;
+    for(head = 0; head < 8U; head++){
+        data = &crcData[head];
+        for(len = 0; len <= DATA_LEN; len += (len < 40U) ? 1U : 37U){
+            want = bitCRC(profile, data, len);
+            for(f = 0; f < NUM_UPDATES; f++){
+                SoftCRCInit(&ctx, profile);
+                updateFns[f](&ctx, data, len);
+                if(SoftCRCResult(&ctx) != want){
+                    bad++;
+                }else{}
+                SoftCRCInit(&ctx, profile);
+                done = 0;
+                p = f;
+                while(done < len){
+                    n = pieces[p % (sizeof(pieces)/sizeof(pieces[0]))];
+                    if(n > (len - done)){
+                        n = len - done;
+                    }else{}
+                    updateFns[p % NUM_UPDATES](&ctx, &data[done], n);
+                    done += n;
+                    p++;
+                }
+                if(SoftCRCResult(&ctx) != want){
+                    if(bad < 5U){
+                        printf("  profile %u head %u len %u pieces from %u\n", profile, head, len, f);
+                    }else{}
+                    bad++;
+                }else{}
+            }
+        }
+    }
+    CHECK(bad == 0);
+}
+
+int main(void){
+    INT32U i;
+    srand(14);
+    for(i = 0; i < sizeof(crcData); i++){
+        crcData[i] = (INT8U)rand();
+    }
+    testCheckValues();
+    testPieces(SOFT_CRC16);
+    testPieces(SOFT_CRC32);
+    return TestDone("SoftCRCTest");
+}
@@ -0,0 +1,29 @@
+/* SysTickSim.h - Header file for the simulated millisecond tick in SysTickTest.c.
+ * SysTickDelay.c is built unmodified with this header and CoreSim.h forced in. The macros below put its ms count,
+ * cycle stamp and idle instruction on the simulated time, which raises the tick as a CoreSim interrupt every 1ms.
+ *
+ * Dominic Danis
+ * */
+#ifndef SYS_TICK_SIM_INC
+#define SYS_TICK_SIM_INC
+
+/*SysTickDelay.c hooks*/
+#define ST_MS_COUNT()   SysTickSimReadMs()
+#define ST_CYCLES()     SysTickSimCycles()
+#define ST_IDLE()       SysTickSimIdle()
+
+/* SysTickSimReadMs - no parameters, returns the simulated ms count. The test can arm a tick to land right after
+ * a chosen read, between the check and whatever the code does next.
+ * */
+INT32U SysTickSimReadMs(void);
+
+/* SysTickSimCycles - no parameters, returns the simulated time in core clock cycles, wrapping at 32 bits.
+ * */
+INT32U SysTickSimCycles(void);
+
+/* SysTickSimIdle - no parameters and returns nothing. Records the PRIMASK and the ms count at each idle entry,
+ * then executes the simulated WFI.
+ * */
+void SysTickSimIdle(void);
+
+#endif
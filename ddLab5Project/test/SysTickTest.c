@@ -0,0 +1,363 @@
+/* SysTickTest.c
+ * Host test of the SysTickWaitEvent() slice timing in device/SysTickDelay.c. Time is simulated in 180MHz core
+ * cycles and a tick interrupt is raised through CoreSim at every 1ms boundary, so the ms count only moves when
+ * PRIMASK lets the tick run, as on the target. WFI lets time pass to the next tick. Covers the absolute deadline
+ * grid under varying task load, an overrun shorter than a period, the dropped and counted slices of a longer
+ * one, and the windowed jitter histogram. With ST_IDLE stubbed it also checks the idle time accounting behind
+ * the CPU load, and that a tick landing after any deadline check can not be slept through because PRIMASK is set
+ * at every idle entry. SysTickGetCycleStamp() is checked against the ms count and SysTick VAL, across its wrap.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <string.h>
+#include "MCUType.h"
+#include "SysTickDelay.h"
+#include "CoreSim.h"
+#include "SysTickSim.h"
+#include "TestUtil.h"
+
+#define SIM_CLK_PER_MS  180000U
+#define SIM_PERIOD      10U                             /*slice length in ms, as SCHED_SLICE_MS*/
+#define SIM_WINDOW      100U                            /*slices per jitter window, ST_JITTER_WINDOW*/
+
+void SysTick_Handler(void);
+
+static INT64U simCycle;                                 /*simulated time in core cycles*/
+static volatile INT32U simMs;                           /*ms count the tick interrupt advances*/
+static INT32U simReads;                                 /*ST_MS_COUNT() reads since the tick was armed*/
+static INT32U simTickAt;                                /*read the armed tick lands after, 0 for none*/
+static INT32U simDeadline;                              /*ms count the waiting slice is released at*/
+static INT32U simIdles;                                 /*idle entries*/
+static INT32U simIdleUnmasked;                          /*idle entries with PRIMASK clear*/
+static INT32U simLostWakeups;                           /*idle entries after the deadline tick already ran*/
+
+static void simRun(INT64U cycles);
+
+/*SysTickSim.h hooks*/
+INT32U SysTickSimReadMs(void){
+    INT32U ms = simMs;
+    simReads++;
+    if(simReads == simTickAt){                          /*the armed tick lands right after this read*/
+        simTickAt = 0;
+        simRun(1U);
+    }else{}
+    return ms;
+}
+INT32U SysTickSimCycles(void){
+    return (INT32U)simCycle;
+}
+void SysTickSimIdle(void){
+    simIdles++;
+    if(CoreSimGetPrimask() == 0){
+        simIdleUnmasked++;
+    }else{}
+    if((CoreSimPending() == 0) && ((INT32S)(simMs - simDeadline) >= 0)){
+        simLostWakeups++;                               /*WFI would sleep to the tick after the deadline*/
+    }else{}
+    CoreSimWfi();
+}
+
+/* simTick - the simulated SysTick interrupt. Advances the injected ms count and runs the real handler so the
+ * module's own count and tick hook stay in step.
+ * */
+static void simTick(void){
+    simMs++;
+    SysTick_Handler();
+}
+
+/* simRun - takes a number of cycles and returns nothing. Lets time pass, raising the tick at each 1ms boundary.
+ * */
+static void simRun(INT64U cycles){
+    INT64U next;
+    INT64U step;
+    while(cycles != 0){
+        next = ((simCycle/SIM_CLK_PER_MS) + 1U)*SIM_CLK_PER_MS;
+        step = next - simCycle;
+        if(step > cycles){
+            step = cycles;
+        }else{}
+        simCycle += step;
+        cycles -= step;
+        if(simCycle == next){
+            CoreSimPend(simTick);
+        }else{}
+    }
+}
+
+/* simIdle - the WFI idle hook. Sleeps to the next tick.
+ * */
+static void simIdle(void){
+    simRun(SIM_CLK_PER_MS - (simCycle % SIM_CLK_PER_MS));
+}
+
+/* simStart - no parameters and returns nothing. Restarts the simulated time and SysTickDelay and takes the first
+ * SysTickWaitEvent() call, which only sets up the slice grid.
+ * */
+static void simStart(void){
+    CoreSimReset();
+    CoreSimSetIdleHook(simIdle);
+    simCycle = 0;
+    simMs = 0;
+    simTickAt = 0;
+    simDeadline = 0;
+    simIdles = 0;
+    simIdleUnmasked = 0;
+    simLostWakeups = 0;
+    SysTickDlyInit();
+    SysTickWaitEvent(SIM_PERIOD);
+}
+
+/* slice - takes the work of the slice in cycles, returns the ms count when SysTickWaitEvent() released the next one.
+ * */
+static INT32U slice(INT64U work){
+    simRun(work);
+    SysTickWaitEvent(SIM_PERIOD);
+    return simMs;
+}
+
+/* sameHist - takes a histogram, returns 1 if it matches SysTickGetJitterHist().
+ * */
+static int sameHist(const INT32U *want){
+    INT32U hist[ST_JITTER_BINS];
+    SysTickGetJitterHist(hist);
+    return memcmp(hist, want, sizeof(hist)) == 0;
+}
+
+static void testInit(void){
+    simStart();
+    CHECK(CoreSimSysTick.LOAD == (SIM_CLK_PER_MS - 1U));
+    CHECK((CoreSimSysTick.CTRL & SysTick_CTRL_ENABLE_Msk) != 0);
+    CHECK((CoreSimScb.SCR & SCB_SCR_SLEEPDEEP_Msk) == 0);
+    CHECK(SysTickGetSliceCount() == 1U);
+    CHECK(SysTickGetOverrunCount() == 0);
+    CHECK(SysTickGetSkipCount() == 0);
+}
+
+/* testGrid - the release time stays on the absolute grid whatever the load, with no drift.
+ * */
+static void testGrid(void){
+    INT32U k;
+    INT32U ms;
+    int on_grid = 1;
+    simStart();
+    for(k = 1; k <= 2000U; k++){
+        ms = slice((INT64U)((k*37U) % 10U)*SIM_CLK_PER_MS/SIM_PERIOD*9U/10U + (k*7919U) % 1000U);
+        if((ms != (k*SIM_PERIOD)) || (simCycle != ((INT64U)ms*SIM_CLK_PER_MS))){
+            on_grid = 0;
+        }else{}
+    }
+    CHECK(on_grid);
+    CHECK(SysTickGetmsCount() == (2000U*SIM_PERIOD));
+    CHECK(SysTickGetSliceCount() == 2001U);
+    CHECK(SysTickGetOverrunCount() == 0);
+    CHECK(SysTickGetSkipCount() == 0);
+    CHECK(CoreSimDeadSleeps() == 0);
+}
+
+/* testOverrun - a slice overrun by less than a period is released at once and the grid is kept.
+ * */
+static void testOverrun(void){
+    simStart();
+    CHECK(slice(3U*SIM_CLK_PER_MS) == 10U);
+    CHECK(slice(12U*SIM_CLK_PER_MS) == 22U);            /*deadline 20, released at once 2ms late*/
+    CHECK(SysTickGetOverrunCount() == 1U);
+    CHECK(SysTickGetOverrunms() == 22U);
+    CHECK(SysTickGetSkipCount() == 0);
+    CHECK(slice(1U*SIM_CLK_PER_MS) == 30U);             /*the short slice after it ends on the grid*/
+    CHECK(slice(9U*SIM_CLK_PER_MS) == 40U);
+    CHECK(SysTickGetOverrunCount() == 1U);
+}
+
+/* testSkip - an overrun of more than a period drops the missed slices, counts them and keeps the grid.
+ * */
+static void testSkip(void){
+    simStart();
+    CHECK(slice(2U*SIM_CLK_PER_MS) == 10U);
+    CHECK(slice(35U*SIM_CLK_PER_MS) == 45U);            /*deadline 20, 30 and 40 missed, released at once*/
+    CHECK(SysTickGetOverrunCount() == 1U);
+    CHECK(SysTickGetOverrunms() == 45U);
+    CHECK(SysTickGetSkipCount() == 2U);
+    CHECK(slice(1U*SIM_CLK_PER_MS) == 50U);
+    CHECK(slice(30U*SIM_CLK_PER_MS) == 80U);            /*deadline 60, late by exactly two periods*/
+    CHECK(SysTickGetOverrunCount() == 2U);
+    CHECK(SysTickGetSkipCount() == 4U);
+    CHECK(slice(0U) == 90U);
+}
+
+/* testJitter - the histogram bins the lateness of each release by ms, is only published when a window of
+ * SIM_WINDOW slices is complete and starts the next window empty.
+ * */
+static void testJitter(void){
+    static const INT8U late_at[][2] = {                 /*slice in the window, ms late*/
+        {3U, 1U}, {10U, 3U}, {11U, 3U}, {20U, 6U}, {30U, 7U}, {40U, 9U}, {50U, 2U}, {98U, 1U}
+    };
+    INT32U want[ST_JITTER_BINS];
+    INT32U none[ST_JITTER_BINS];
+    INT32U late = 0;
+    INT32U i;
+    INT32U j;
+    INT32U target;
+    memset(want, 0, sizeof(want));
+    memset(none, 0, sizeof(none));
+    simStart();
+    for(i = 0; i < SIM_WINDOW; i++){
+        target = 0;
+        for(j = 0; j < (sizeof(late_at)/sizeof(late_at[0])); j++){
+            if(late_at[j][0] == i){
+                target = late_at[j][1];
+            }else{}
+        }
+        if(i == 60U){                                   /*three periods and 5ms late, two slices dropped*/
+            target = 25U;
+            want[5]++;
+        }else if(target < (ST_JITTER_BINS - 1U)){
+            want[target]++;
+        }else{
+            want[ST_JITTER_BINS - 1U]++;
+        }
+        if(target == 0){                                /*finish early, released on time*/
+            simRun((INT64U)(SIM_PERIOD - late)*SIM_CLK_PER_MS/2U);
+        }else{
+            simRun((INT64U)(SIM_PERIOD - late + target)*SIM_CLK_PER_MS);
+        }
+        SysTickWaitEvent(SIM_PERIOD);
+        late = (target >= SIM_PERIOD) ? (target % SIM_PERIOD) : target;
+        if(i == (SIM_WINDOW - 2U)){
+            CHECK(sameHist(none));                      /*window not complete yet*/
+        }else{}
+    }
+    CHECK(sameHist(want));
+    CHECK(want[0] == 91U);
+    CHECK(SysTickGetOverrunCount() == 9U);
+    CHECK(SysTickGetSkipCount() == 2U);
+    for(i = 0; i < SIM_WINDOW; i++){
+        slice(SIM_CLK_PER_MS);
+    }
+    memset(want, 0, sizeof(want));
+    want[0] = SIM_WINDOW;
+    CHECK(sameHist(want));
+    simStart();                                         /*a restart clears the histogram*/
+    CHECK(sameHist(none));
+}
+
+/* testLoad - the CPU load of each window is the time not spent waiting, in 0.1% units. It is only updated when a
+ * window completes and stays right across the 32-bit cycle stamp wrap.
+ * */
+static void testLoad(void){
+    static const INT16U loads[] = {0U, 300U, 755U, 999U, 1000U, 1U, 500U};
+    INT32U w;
+    INT32U i;
+    int same = 1;
+    simStart();
+    for(w = 0; w < (sizeof(loads)/sizeof(loads[0])); w++){
+        for(i = 0; i < SIM_WINDOW; i++){
+            slice((INT64U)loads[w]*SIM_PERIOD*SIM_CLK_PER_MS/1000U);
+            if((i == (SIM_WINDOW - 2U)) && (w != 0)){
+                CHECK(SysTickGetCPULoad() == loads[w - 1U]);
+            }else{}
+        }
+        CHECK(SysTickGetCPULoad() == loads[w]);
+    }
+    for(i = 0; i < (SIM_WINDOW/2U); i++){               /*mixed window, half at 20% and half at 60%*/
+        slice(2U*SIM_CLK_PER_MS);
+    }
+    for(i = 0; i < (SIM_WINDOW/2U); i++){
+        slice(6U*SIM_CLK_PER_MS);
+    }
+    CHECK(SysTickGetCPULoad() == 400U);
+    for(w = 0; w < 30U; w++){                           /*30s, the cycle stamp wraps after 23.8s*/
+        for(i = 0; i < SIM_WINDOW; i++){
+            slice((INT64U)SIM_PERIOD*SIM_CLK_PER_MS*35U/100U);
+        }
+        if(SysTickGetCPULoad() != 350U){
+            same = 0;
+        }else{}
+    }
+    CHECK(same);
+    CHECK(simCycle > 0x100000000ULL);
+    CHECK(simIdleUnmasked == 0);
+    CHECK(CoreSimDeadSleeps() == 0);
+}
+
+/* testLostWakeup - the deadline tick lands right after each ST_MS_COUNT() read of a slice that starts one cycle
+ * before it. Whether the tick runs at once or stays pending behind PRIMASK, the slice is released at the deadline
+ * and never goes to sleep with the tick already taken.
+ * */
+static void testLostWakeup(void){
+    INT32U at;
+    INT32U ms;
+    simStart();
+    for(at = 1U; at <= 8U; at++){
+        simDeadline += SIM_PERIOD;
+        simRun(((INT64U)simDeadline*SIM_CLK_PER_MS) - simCycle - 1U);
+        simReads = 0;
+        simTickAt = at;
+        SysTickWaitEvent(SIM_PERIOD);
+        ms = simMs;
+        if(!CHECK(ms == simDeadline)){
+            printf("  tick after read %u released at %u ms, deadline %u ms\n", at, ms, simDeadline);
+        }else{}
+        CHECK(CoreSimGetPrimask() == 0);
+        CHECK(CoreSimPending() == 0);
+    }
+    CHECK(simIdles != 0);
+    CHECK(simIdleUnmasked == 0);
+    CHECK(simLostWakeups == 0);
+    CHECK(CoreSimDeadSleeps() == 0);
+    CHECK(SysTickGetOverrunCount() == 0);
+}
+
+/* testCycleStamp - SysTickGetCycleStamp() is the ms count in cycles plus the cycles SysTick has counted down, and
+ * differences stay right across the 32-bit wrap after ~23.8s.
+ * */
+static void testCycleStamp(void){
+    INT32U before;
+    INT32U ms;
+    simStart();
+    CoreSimSysTick.VAL = SIM_CLK_PER_MS - 1U;           /*just reloaded*/
+    CHECK(SysTickGetCycleStamp() == 0);
+    simRun(3U*SIM_CLK_PER_MS);
+    CoreSimSysTick.VAL = SIM_CLK_PER_MS - 1U - 500U;
+    CHECK(SysTickGetCycleStamp() == ((3U*SIM_CLK_PER_MS) + 500U));
+    ms = (INT32U)((0x100000000ULL/SIM_CLK_PER_MS) - 1U);    /*last whole ms before the wrap*/
+    simRun((INT64U)(ms - 3U)*SIM_CLK_PER_MS);
+    CoreSimSysTick.VAL = 1000U;
+    before = SysTickGetCycleStamp();
+    CHECK(before == (ms*SIM_CLK_PER_MS) + (SIM_CLK_PER_MS - 1U - 1000U));
+    simRun(2U*SIM_CLK_PER_MS);
+    CoreSimSysTick.VAL = SIM_CLK_PER_MS - 1U - 7U;
+    CHECK(SysTickGetCycleStamp() < before);             /*wrapped*/
+    CHECK((SysTickGetCycleStamp() - before) == ((2U*SIM_CLK_PER_MS) - (SIM_CLK_PER_MS - 1U - 1000U) + 7U));
+}
+
+/* testCycleStampPending - in an ISR that preempts the tick, a pending tick with VAL just reloaded is counted and
+ * one with VAL about to reload, read before the reload, is not.
+ * */
+static void testCycleStampPending(void){
+    INT32U before;
+    simStart();
+    simRun(5U*SIM_CLK_PER_MS);
+    CoreSimSysTick.VAL = 3U;
+    before = SysTickGetCycleStamp();
+    CHECK(before == ((6U*SIM_CLK_PER_MS) - 4U));
+    CoreSimSysTick.VAL = SIM_CLK_PER_MS - 1U - 10U;     /*reloaded, the ms count not incremented yet*/
+    CoreSimScb.ICSR = SCB_ICSR_PENDSTSET_Msk;
+    CHECK((SysTickGetCycleStamp() - before) == 14U);
+    CoreSimSysTick.VAL = 2U;                            /*pended as VAL was read*/
+    CHECK(SysTickGetCycleStamp() == ((6U*SIM_CLK_PER_MS) - 3U));
+    CoreSimScb.ICSR = 0;
+}
+
+int main(void){
+    testInit();
+    testGrid();
+    testOverrun();
+    testSkip();
+    testJitter();
+    testLoad();
+    testLostWakeup();
+    testCycleStamp();
+    testCycleStampPending();
+    return TestDone("SysTickTest");
+}
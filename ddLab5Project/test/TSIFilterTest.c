@@ -0,0 +1,215 @@
+/* TSIFilterTest.c
+ * Trace driven host test of board/TSIFilter.c. Each trace is a list of raw count segments played through
+ * TSIFiltUpdate() with the pad thresholds from K65TWR_TSI.c. Checks the count filter step response, the baseline
+ * following a slow drift without a false touch, the touch and release debounce and hysteresis, the baseline held
+ * while touched, and the baseline frozen while the filtered count sits between the release and touch levels.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include "MCUType.h"
+#include "TSIFilter.h"
+#include "TestUtil.h"
+
+#define BASE        0x1000U                             /*untouched count*/
+#define TOUCH_OFS   0x0400U                             /*E1_TOUCH_OFFSET*/
+#define RELEASE_OFS 0x0300U                             /*E1_RELEASE_OFFSET*/
+#define ONE         (1U << TSI_FILT_FRAC)               /*one count in filtered and baseline units*/
+
+/*A trace segment, count is played for samples scans. A count of 0 ramps from the last count to ramp_to*/
+typedef struct{
+    INT16U count;
+    INT16U samples;
+    INT16U ramp_to;
+}SEG_T;
+
+/*What a trace did*/
+typedef struct{
+    INT32U touches;                                     /*released to touched changes*/
+    INT32U releases;
+    INT32U touched_samples;
+    INT32U first_touch;                                 /*sample number of the first touch, 0 for none*/
+    INT32U base_min;
+    INT32U base_max;
+}TRACE_T;
+
+static const TSI_FILT_CFG_T cfg = {TOUCH_OFS, RELEASE_OFS, 2U, 2U};
+static TSI_FILT_T ch;
+
+/* runTrace - takes the segments and their number, returns what happened in *res. The channel is not reset so
+ * traces can be chained.
+ * */
+static void runTrace(const SEG_T *segs, INT8U num, TRACE_T *res){
+    INT8U s;
+    INT32U i;
+    INT32U n = 0;
+    INT32U count;
+    INT16U last = ch.raw;
+    INT8U was = ch.touched;
+    INT8U now;
+    res->touches = 0;
+    res->releases = 0;
+    res->touched_samples = 0;
+    res->first_touch = 0;
+    res->base_min = ch.baseline;
+    res->base_max = ch.baseline;
+    for(s = 0; s < num; s++){
+        for(i = 0; i < segs[s].samples; i++){
+            if(segs[s].count == 0){
+                count = last + (INT32U)(((INT32S)segs[s].ramp_to - (INT32S)last)*(INT32S)(i + 1U)/(INT32S)segs[s].samples);
+            }else{
+                count = segs[s].count;
+            }
+            n++;
+            now = TSIFiltUpdate(&ch, &cfg, (INT16U)count);
+            CHECK(now == ch.touched);
+            if((now != 0) && (was == 0)){
+                res->touches++;
+                if(res->first_touch == 0){
+                    res->first_touch = n;
+                }else{}
+            }else if((now == 0) && (was != 0)){
+                res->releases++;
+            }else{}
+            if(now != 0){
+                res->touched_samples++;
+            }else{}
+            if(ch.baseline < res->base_min){
+                res->base_min = ch.baseline;
+            }else{}
+            if(ch.baseline > res->base_max){
+                res->base_max = ch.baseline;
+            }else{}
+            was = now;
+        }
+        last = (segs[s].count == 0) ? segs[s].ramp_to : segs[s].count;
+    }
+}
+
+/* testStep - the count filter moves a quarter of the way each sample, does not overshoot and settles.
+ * */
+static void testStep(void){
+    INT32U last;
+    INT32U i;
+    int monotonic = 1;
+    TSIFiltInit(&ch, BASE);
+    CHECK((ch.raw == BASE) && (ch.filtered == (BASE*ONE)) && (ch.baseline == (BASE*ONE)) && (ch.touched == 0));
+    (void)TSIFiltUpdate(&ch, &cfg, BASE + 0x200U);
+    CHECK(ch.raw == (BASE + 0x200U));
+    CHECK(ch.filtered == ((BASE + 0x80U)*ONE));
+    (void)TSIFiltUpdate(&ch, &cfg, BASE + 0x200U);
+    CHECK(ch.filtered == ((BASE + 0xE0U)*ONE));
+    last = ch.filtered;
+    for(i = 0; i < 60U; i++){
+        (void)TSIFiltUpdate(&ch, &cfg, BASE + 0x200U);
+        if((ch.filtered < last) || (ch.filtered > ((BASE + 0x200U)*ONE))){
+            monotonic = 0;
+        }else{}
+        last = ch.filtered;
+    }
+    CHECK(monotonic);
+    CHECK(ch.filtered > ((BASE + 0x200U - 1U)*ONE));
+    TSIFiltInit(&ch, BASE);                             /*and down*/
+    (void)TSIFiltUpdate(&ch, &cfg, BASE - 0x200U);
+    CHECK(ch.filtered == ((BASE - 0x80U)*ONE));
+}
+
+/* testDrift - a slow drift up and back down is followed by the baseline and never reads as a touch.
+ * */
+static void testDrift(void){
+    static const SEG_T drift[] = {
+        {0, 2000U, BASE + 2000U},                       /*1 count per sample*/
+        {BASE + 2000U, 2000U, 0},
+        {0, 4000U, BASE - 1000U}
+    };
+    TRACE_T res;
+    TSIFiltInit(&ch, BASE);
+    runTrace(drift, 3U, &res);
+    CHECK(res.touches == 0);
+    CHECK(res.touched_samples == 0);
+    CHECK(res.base_max > ((BASE + 1900U)*ONE));
+    CHECK((ch.baseline >> TSI_FILT_FRAC) < (BASE - 1000U + 200U));
+    CHECK((ch.baseline >> TSI_FILT_FRAC) >= (BASE - 1000U));
+}
+
+/* testHysteresis - a touch needs two filtered samples past the touch level, holds between the two levels and
+ * releases after two below the release level. The baseline does not move while touched.
+ * */
+static void testHysteresis(void){
+    static const SEG_T spike[] = {                      /*filtered over the touch level for one sample only*/
+        {BASE + 5000U, 1U, 0}, {BASE, 40U, 0}
+    };
+    static const SEG_T press[] = {
+        {BASE + 2000U, 50U, 0},                         /*touch*/
+        {BASE + 900U, 500U, 0}                          /*between the levels, held*/
+    };
+    static const SEG_T hold[] = {
+        {BASE + 2000U, 5000U, 0}                        /*long press*/
+    };
+    static const SEG_T regain[] = {
+        {BASE + 2000U, 20U, 0}
+    };
+    static const SEG_T release[] = {
+        {BASE + 100U, 40U, 0}
+    };
+    TRACE_T res;
+    INT32U base;
+    TSIFiltInit(&ch, BASE);
+    runTrace(spike, 2U, &res);
+    CHECK(res.touches == 0);
+    runTrace(press, 2U, &res);
+    CHECK(res.touches == 1U);
+    CHECK(res.first_touch == 4U);                       /*filtered passes the level on sample 3, debounced on 4*/
+    CHECK(res.releases == 0);
+    CHECK(res.touched_samples == (550U - 3U));
+    base = ch.baseline;
+    runTrace(hold, 1U, &res);
+    CHECK(res.touched_samples == 5000U);
+    CHECK((res.base_min == base) && (res.base_max == base));
+    (void)TSIFiltUpdate(&ch, &cfg, BASE - 3200U);      /*one sample under the release level*/
+    CHECK(ch.filtered < (base + RELEASE_OFS*ONE));
+    CHECK(ch.touched == 1U);
+    runTrace(regain, 1U, &res);
+    CHECK(res.releases == 0);
+    CHECK(ch.touched == 1U);
+    runTrace(release, 1U, &res);
+    CHECK(res.releases == 1U);
+    CHECK(ch.touched == 0);
+    CHECK(res.touched_samples == 4U);                   /*below the release level on sample 4, debounced on 5*/
+    CHECK(ch.baseline > base);                          /*tracking again once released and quiet*/
+}
+
+/* testFrozen - a filtered count that settles between the release and touch levels without a touch freezes the
+ * baseline, so it is neither tracked nor a touch for as long as it stays. It resumes once the count drops.
+ * */
+static void testFrozen(void){
+    static const SEG_T stuck[] = {
+        {BASE + 900U, 20000U, 0}
+    };
+    static const SEG_T drop[] = {
+        {BASE + 600U, 2000U, 0}
+    };
+    TRACE_T res;
+    INT32U base;
+    TSIFiltInit(&ch, BASE);
+    runTrace(stuck, 1U, &res);
+    base = ch.baseline;
+    CHECK(res.touches == 0);
+    CHECK(ch.filtered > (base + RELEASE_OFS*ONE));
+    CHECK(ch.filtered < (base + TOUCH_OFS*ONE));
+    CHECK((res.base_max - res.base_min) < (RELEASE_OFS*ONE/4U));    /*tracked only until the level was reached*/
+    runTrace(stuck, 1U, &res);
+    CHECK((res.base_min == base) && (res.base_max == base));
+    CHECK(res.touches == 0);
+    runTrace(drop, 1U, &res);
+    CHECK(res.touches == 0);
+    CHECK((ch.baseline >> TSI_FILT_FRAC) > (BASE + 500U));
+}
+
+int main(void){
+    testStep();
+    testDrift();
+    testHysteresis();
+    testFrozen();
+    return TestDone("TSIFilterTest");
+}
@@ -0,0 +1,26 @@
+/* TestUtil.c
+ * Checks and the pass/fail summary shared by the host tests.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include "TestUtil.h"
+
+static unsigned long testChecks = 0;
+static unsigned long testFails = 0;
+
+int TestCheck(int ok, const char *file, int line, const char *expr){
+    testChecks++;
+    if(!ok){
+        testFails++;
+        if(testFails <= 20U){
+            printf("%s:%d: FAIL %s\n", file, line, expr);
+        }else{}
+    }else{}
+    return ok;
+}
+
+int TestDone(const char *name){
+    printf("%s: %lu checks, %lu failed\n", name, testChecks, testFails);
+    return (testFails != 0U) ? 1 : 0;
+}
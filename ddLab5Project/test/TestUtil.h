@@ -0,0 +1,20 @@
+/* TestUtil.h - Header file for TestUtil.c - checks and the pass/fail summary shared by the host tests.
+ *
+ * Dominic Danis
+ * */
+#ifndef TEST_UTIL_INC
+#define TEST_UTIL_INC
+
+/*Checks a condition, prints the file, line and expression if it is false*/
+#define CHECK(cond) TestCheck((cond) != 0, __FILE__, __LINE__, #cond)
+
+/* TestCheck - takes the result, file, line and expression text, returns the result.
+ * */
+int TestCheck(int ok, const char *file, int line, const char *expr);
+
+/* TestDone - takes the test name, returns 0 if every check passed and 1 if not, for main() to return.
+ * Prints the summary.
+ * */
+int TestDone(const char *name);
+
+#endif
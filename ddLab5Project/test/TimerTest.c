@@ -0,0 +1,191 @@
+/* TimerTest.c
+ * Host test of source/Timer.c. Checks that timers due on the same tick run in start order and that a late
+ * TimerRun() catches up earlier ticks first. A random model run then starts, restarts and stops timers, some
+ * from inside callbacks, with delays across every wheel level and checks that each expiry lands on exactly the
+ * tick it is due. The model run is repeated with the 32-bit ms count wrapping in the middle.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include "MCUType.h"
+#include "Timer.h"
+#include "TestUtil.h"
+
+#define NUM_TMRS    600U
+#define LOG_LEN     64U
+
+INT32U SysTickGetmsCount(void){
+    return 0;
+}
+
+static TMR_T tmrs[NUM_TMRS];
+static INT32U due[NUM_TMRS];                            /*tick each running timer is due on*/
+static INT32U period[NUM_TMRS];                         /*ticks, 0 for one shot*/
+static INT8U running[NUM_TMRS];
+static INT32U tick;                                     /*tick being processed*/
+static INT32U fires;
+static INT32U bad;
+static INT32U order[LOG_LEN];
+static INT32U orderLen;
+
+/* ticksFor - the ms to ticks rounding of TimerStart().
+ * */
+static INT32U ticksFor(INT32U ms){
+    INT32U t = (ms + TMR_TICK_MS - 1U) / TMR_TICK_MS;
+    if(t == 0){
+        t = 1U;
+    }else if(t > TMR_MAX_TICKS){
+        t = TMR_MAX_TICKS;
+    }else{}
+    return t;
+}
+
+/* logFire - callback that logs its argument.
+ * */
+static void logFire(void *arg){
+    if(orderLen < LOG_LEN){
+        order[orderLen] = (INT32U)(size_t)arg;
+        orderLen++;
+    }else{}
+}
+
+/* testOrder - same tick start order, catch-up order and the counting timers.
+ * */
+static void testOrder(void){
+    TMR_T t[8];
+    TMR_T counter;
+    INT32U i;
+    TimerInit(1000U);
+    orderLen = 0;
+    for(i = 0; i < 8U; i++){
+        TimerSetup(&t[i], logFire, (void *)(size_t)i);
+    }
+    TimerStart(&t[3], 50U, 0);                          /*due together, in start order*/
+    TimerStart(&t[1], 50U, 0);
+    TimerStart(&t[2], 41U, 0);                          /*rounded up to the same tick*/
+    TimerRun(1040U);
+    CHECK(orderLen == 0U);
+    TimerRun(1050U);
+    CHECK(orderLen == 3U);
+    CHECK((order[0] == 3U) && (order[1] == 1U) && (order[2] == 2U));
+
+    orderLen = 0;                                       /*one late TimerRun(), earlier ticks first*/
+    TimerStart(&t[0], 5000U, 0);
+    TimerStart(&t[4], 700U, 0);                         /*level 1*/
+    TimerStart(&t[5], 30U, 0);
+    TimerStart(&t[6], 100000U, 0);                      /*level 2*/
+    TimerStart(&t[7], 640U, 0);
+    TimerRun(1050U + 200000U);
+    CHECK(orderLen == 5U);
+    CHECK((order[0] == 5U) && (order[1] == 7U) && (order[2] == 4U) && (order[3] == 0U) && (order[4] == 6U));
+
+    TimerSetup(&counter, 0, 0);                         /*no callback, counted for TimerFired()*/
+    TimerStart(&counter, 10U, 30U);
+    CHECK(TimerActive(&counter) == 1U);
+    TimerRun(1050U + 200000U + 100U);                   /*ticks 1, 4, 7 and 10*/
+    CHECK(TimerFired(&counter) == 4U);
+    CHECK(TimerFired(&counter) == 0U);
+    TimerStop(&counter);
+    CHECK(TimerActive(&counter) == 0U);
+    TimerStop(&counter);
+    TimerRun(1050U + 200000U + 1000U);
+    CHECK(TimerFired(&counter) == 0U);
+}
+
+/* modelStart - starts timer i in the wheel and in the model.
+ * */
+static void modelStart(INT32U i){
+    INT32U delay;
+    INT32U per = 0;
+    switch(rand() % 4){
+    case 0:
+        delay = (INT32U)(rand() % 700);                 /*level 0, and 0 ms*/
+        break;
+    case 1:
+        delay = (INT32U)(rand() % 41000);               /*level 1*/
+        break;
+    case 2:
+        delay = (INT32U)(rand() % 2700000);             /*level 2*/
+        break;
+    default:
+        delay = (INT32U)(rand() % 3000000);             /*to past TMR_MAX_TICKS*/
+        break;
+    }
+    if((rand() % 3) == 0){
+        per = 1U + (INT32U)(rand() % 20000);
+    }else{}
+    TimerStart(&tmrs[i], delay, per);
+    due[i] = tick + ticksFor(delay);
+    period[i] = (per != 0) ? ticksFor(per) : 0;
+    running[i] = 1;
+}
+
+/* modelFire - callback. Checks the tick, moves the model on and sometimes stops or restarts another timer.
+ * */
+static void modelFire(void *arg){
+    INT32U i = (INT32U)(size_t)arg;
+    INT32U j;
+    fires++;
+    if((running[i] == 0) || (due[i] != tick)){
+        if(bad < 10U){
+            printf("  timer %u ran on tick %u, due %u\n", (unsigned)i, (unsigned)tick, (unsigned)due[i]);
+        }else{}
+        bad++;
+    }else{}
+    if(period[i] != 0){
+        due[i] += period[i];
+    }else{
+        running[i] = 0;
+    }
+    if((rand() % 20) == 0){
+        j = (INT32U)(rand() % NUM_TMRS);
+        TimerStop(&tmrs[j]);
+        running[j] = 0;
+    }else if((rand() % 20) == 0){
+        modelStart((INT32U)(rand() % NUM_TMRS));
+    }else{}
+}
+
+/* testModel - takes the starting ms count and the ticks to run, returns nothing.
+ * */
+static void testModel(INT32U ms, INT32U ticks){
+    INT32U i;
+    INT32U missed = 0;
+    TimerInit(ms);
+    tick = ms / TMR_TICK_MS;
+    fires = 0;
+    bad = 0;
+    for(i = 0; i < NUM_TMRS; i++){
+        TimerSetup(&tmrs[i], modelFire, (void *)(size_t)i);
+        running[i] = 0;
+        modelStart(i);
+    }
+    while(ticks > 0U){
+        if((rand() % 100) == 0){
+            modelStart((INT32U)(rand() % NUM_TMRS));    /*between ticks*/
+        }else{}
+        tick++;
+        ms += TMR_TICK_MS;
+        TimerRun(ms + (INT32U)(rand() % TMR_TICK_MS));  /*the scheduler runs it a little late*/
+        ticks--;
+    }
+    for(i = 0; i < NUM_TMRS; i++){
+        if((running[i] != 0) && ((INT32S)(due[i] - tick) <= 0)){
+            missed++;
+        }else{}
+        CHECK(TimerActive(&tmrs[i]) == running[i]);
+    }
+    CHECK(bad == 0U);
+    CHECK(missed == 0U);
+    CHECK(fires > 10000U);
+}
+
+int main(void){
+    srand(24);
+    testOrder();
+    testModel(0, 600000U);
+    testModel(0xFFFFFFFFU - 3000000U, 600000U);         /*ms count wraps after 300000 ticks*/
+    CHECK(TimerGetExpiries() > 0U);
+    return TestDone("TimerTest");
+}
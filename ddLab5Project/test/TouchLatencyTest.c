@@ -0,0 +1,328 @@
+/* TouchLatencyTest.c
+ * Host scenario test of the touch to siren reaction time, the certification metric. Lab5Main.c is built with
+ * its main() renamed and runs its own task table through Scheduler.c with Control.c, StateMachine.c, Timer.c and
+ * Pin.c. The board modules are stubs. Time is simulated in us: slices start up to 800us late and each TSI scan
+ * round takes 0.5-4ms, so a touch is accepted at a random point in a slice. The test arms the system, touches
+ * the instant or the door zone and fails if the siren, or the entry delay LEDs for the door zone, react more than
+ * TOUCH_MAX_MS after TSI0 accepted the touch. lab5PostZone() must measure the same and count nothing late.
+ * The SysTick cycle stamp runs with the simulated time but CYCCNT, as on the target, stops while the core sleeps
+ * between the ISR and the slices and only moves SIM_RUN_CYCLES for each, so a latency taken from CYCCNT fails.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define main lab5_main
+#include "Lab5Main.c"
+#undef main
+#include "TestUtil.h"
+
+#define SIM_MHZ         180U                            /*simulated core clock*/
+#define SIM_RUN_CYCLES  2000U                           /*CYCCNT counted for each ISR and slice*/
+#define SLICE_JIT_US    800U
+#define TSI_ROUND_US    500U                            /*plus up to TSI_JIT_US*/
+#define TSI_JIT_US      3500U
+#define TSI_DEBOUNCE    2U                              /*rounds that must see a touch*/
+#define RUNS            2000U
+#define SIREN_ON        0U
+
+uint32_t SystemCoreClock = SIM_MHZ*1000000U;
+
+static INT64U nowUs;                                    /*simulated us, 64-bit as a run is hours long*/
+static INT32U simCyccnt;                                /*stops in WFI, only counts while the core runs*/
+static INT64U nextSlice;
+static INT32U sliceJit;
+/*TSI model*/
+static INT16U touch;
+static INT16U tsiFlags;
+static INT32U tsiStamp;
+static INT8U tsiDb[16];
+static INT8U tsiBusy;
+static INT64U tsiRoundEnd;
+static INT64U acceptUs;
+/*Outputs*/
+static INT8U siren;
+static INT64U sirenUs;
+static INT64U ledUs;
+static INT8U lcdRow;
+static char lcdRow1[17];
+static const INT8C *keys = "";
+/*PROF_ID_TOUCH*/
+static INT32U touchCount;
+static INT32U touchMax;
+static INT32U touchLast;
+
+static INT32U simCycles(void){
+    return (INT32U)(nowUs*SIM_MHZ);                     /*wraps like the SysTick cycle stamp*/
+}
+
+/*Stubs used by the scenario*/
+INT32U SysTickGetmsCount(void){
+    return (INT32U)(nowUs/1000U);
+}
+INT32U SysTickGetCycleStamp(void){
+    return simCycles();
+}
+INT32U ProfileStart(void){
+    return simCyccnt;
+}
+void ProfileRecord(INT8U id, INT32U cycles){
+    if(id == PROF_ID_TOUCH){
+        touchCount++;
+        touchLast = cycles;
+        if(cycles > touchMax){
+            touchMax = cycles;
+        }else{}
+    }else{}
+}
+void ProfileStop(INT8U id, INT32U start){
+    ProfileRecord(id, simCyccnt - start);
+}
+void ProfileGetStats(INT8U id, PROF_STATS_T *stats){
+    memset(stats, 0, sizeof(*stats));
+    if(id == PROF_ID_TOUCH){
+        stats->count = touchCount;
+        stats->max = touchMax;
+    }else{}
+}
+INT8C KeyGet(void){
+    INT8C key = '\0';
+    if(*keys != '\0'){
+        key = *keys;
+        keys++;
+    }else{}
+    return key;
+}
+void KeyTask(void){}
+void LEDTask(void){}
+void LcdTask(void){}
+void FlashScanTask(void){}
+INT8U FlashScanGetFault(void){
+    return 0;
+}
+INT8C BIORead(void){
+    return '\0';
+}
+void AlarmWaveSetMode(INT8U mode){
+    if((mode == SIREN_ON) && (siren != SIREN_ON)){
+        sirenUs = nowUs;
+    }else{}
+    siren = mode;
+}
+void LEDSetState(INT16U state){
+    (void)state;
+}
+void LEDSetPeriod(INT8U period){
+    if((period == 0) && (ledUs == 0)){                  /*entry action, the first LED change of a state*/
+        ledUs = nowUs;
+    }else{}
+}
+void LEDInOffset(INT8U offset){
+    (void)offset;
+}
+void LcdDispLineClear(const INT8U line){
+    lcdRow = line;
+    if(line == LCD_ROW_1){
+        lcdRow1[0] = '\0';
+    }else{}
+}
+void LcdDispString(INT8C *const strg){
+    if(lcdRow == LCD_ROW_1){
+        strncat(lcdRow1, strg, 16U - strlen(lcdRow1));
+    }else{}
+}
+
+/* TSITask - starts a scan round of both zone channels if one is not running.
+ * */
+void TSITask(void){
+    if(tsiBusy == 0){
+        tsiBusy = 1;
+        tsiRoundEnd = nowUs + TSI_ROUND_US + (INT32U)(rand() % TSI_JIT_US);
+    }else{}
+}
+
+/* tsiRoundDone - the TSI0 ISR at the end of a round. A touch is accepted on the TSI_DEBOUNCE-th round that sees
+ * it and stamped with the SysTick cycle stamp, as TSIGetSensorFlagsStamped() reports it.
+ * */
+static void tsiRoundDone(void){
+    INT8U ch;
+    tsiBusy = 0;
+    for(ch = 11U; ch <= 12U; ch++){
+        if((touch & (1U << ch)) != 0){
+            if(tsiDb[ch] < TSI_DEBOUNCE){
+                tsiDb[ch]++;
+            }else{}
+            if(tsiDb[ch] >= TSI_DEBOUNCE){
+                if(tsiFlags == 0){
+                    tsiStamp = simCycles();
+                    if(acceptUs == 0){
+                        acceptUs = nowUs;
+                    }else{}
+                }else{}
+                tsiFlags |= (INT16U)(1U << ch);
+            }else{}
+        }else{
+            tsiDb[ch] = 0;
+        }
+    }
+}
+
+INT16U TSIGetSensorFlagsStamped(INT32U *stamp){
+    INT16U flags = tsiFlags;
+    *stamp = tsiStamp;
+    tsiFlags = 0;
+    return flags;
+}
+
+/* runTo - runs the TSI0 ISR and the scheduler slices in time order up to t us.
+ * */
+static void runTo(INT64U t){
+    INT64U start;
+    INT8U done = 0;
+    while(done == 0){
+        start = nextSlice + sliceJit;
+        if((tsiBusy != 0) && (tsiRoundEnd <= start) && (tsiRoundEnd <= t)){
+            nowUs = tsiRoundEnd;
+            simCyccnt += SIM_RUN_CYCLES;
+            tsiRoundDone();
+        }else if(start <= t){
+            nowUs = start;
+            simCyccnt += SIM_RUN_CYCLES;
+            SchedDispatch((INT32U)(nextSlice/1000U));
+            nextSlice += SCHED_SLICE_MS*1000U;
+            sliceJit = (INT32U)(rand() % SLICE_JIT_US);
+        }else{
+            done = 1;
+        }
+    }
+    nowUs = t;
+}
+
+/*Never called by the scenario*/
+static void notCalled(const char *name){
+    printf("TouchLatencyTest: %s() called\n", name);
+    abort();
+}
+void AlarmWaveInit(void){ notCalled("AlarmWaveInit"); }
+INT32U BIOGetRxOverflows(void){ notCalled("BIOGetRxOverflows"); return 0; }
+INT32U BIOGetTxOverflows(void){ notCalled("BIOGetTxOverflows"); return 0; }
+void BIOOpen(INT8U rate){ (void)rate; notCalled("BIOOpen"); }
+void BIOOutCRLF(void){ notCalled("BIOOutCRLF"); }
+void BIOOutDecWord(INT32U binword, INT8U field, BIO_OUTDEC_MODE mode){
+    (void)binword; (void)field; (void)mode; notCalled("BIOOutDecWord");
+}
+void BIOPutStrg(const INT8C *const strg){ (void)strg; notCalled("BIOPutStrg"); }
+void BIOWrite(INT8C c){ (void)c; notCalled("BIOWrite"); }
+INT32U FlashScanGetPasses(void){ notCalled("FlashScanGetPasses"); return 0; }
+void FlashScanInit(const INT8U *start, const INT8U *end, INT16U ref){
+    (void)start; (void)end; (void)ref; notCalled("FlashScanInit");
+}
+void GpioDBugBitsInit(void){ notCalled("GpioDBugBitsInit"); }
+void ImageGetRange(IMAGE_RANGE_T *range){ (void)range; notCalled("ImageGetRange"); }
+IMAGE_STATUS ImageVerify(IMAGE_RANGE_T *range){ (void)range; notCalled("ImageVerify"); return IMAGE_FAIL; }
+void K65TWR_BootClock(void){ notCalled("K65TWR_BootClock"); }
+void KeyGetStats(KEY_STATS_T *stats){ (void)stats; notCalled("KeyGetStats"); }
+void KeyInit(void){ notCalled("KeyInit"); }
+void KeyTick(void){ notCalled("KeyTick"); }
+void LEDInit(void){ notCalled("LEDInit"); }
+void LcdCursorMode(const INT8U on, const INT8U blink){ (void)on; (void)blink; notCalled("LcdCursorMode"); }
+void LcdCursorMove(const INT8U row, const INT8U col){ (void)row; (void)col; notCalled("LcdCursorMove"); }
+void LcdDispInit(void){ notCalled("LcdDispInit"); }
+void MemCRCInit(MEM_CRC_PROFILE profile){ (void)profile; notCalled("MemCRCInit"); }
+INT32U MemCRCResult(void){ notCalled("MemCRCResult"); return 0; }
+void MemCRCUpdate(const INT8U *startaddr, const INT8U *endaddr){
+    (void)startaddr; (void)endaddr; notCalled("MemCRCUpdate");
+}
+INT16U MemChkSum(INT8U *startaddr, INT8U *endaddr){ (void)startaddr; (void)endaddr; notCalled("MemChkSum"); return 0; }
+void ProfileDump(void){ notCalled("ProfileDump"); }
+void ProfileInit(void){ notCalled("ProfileInit"); }
+void SoftCRCInit(SOFT_CRC_T *ctx, SOFT_CRC_PROFILE profile){ (void)ctx; (void)profile; notCalled("SoftCRCInit"); }
+INT32U SoftCRCResult(const SOFT_CRC_T *ctx){ (void)ctx; notCalled("SoftCRCResult"); return 0; }
+void SoftCRCUpdate(SOFT_CRC_T *ctx, const INT8U *data, INT32U len){
+    (void)ctx; (void)data; (void)len; notCalled("SoftCRCUpdate");
+}
+void SoftCRCUpdate1(SOFT_CRC_T *ctx, const INT8U *data, INT32U len){
+    (void)ctx; (void)data; (void)len; notCalled("SoftCRCUpdate1");
+}
+void SoftCRCUpdate4(SOFT_CRC_T *ctx, const INT8U *data, INT32U len){
+    (void)ctx; (void)data; (void)len; notCalled("SoftCRCUpdate4");
+}
+void SysTickDlyInit(void){ notCalled("SysTickDlyInit"); }
+INT16U SysTickGetCPULoad(void){ notCalled("SysTickGetCPULoad"); return 0; }
+INT32U SysTickGetOverrunCount(void){ notCalled("SysTickGetOverrunCount"); return 0; }
+void SysTickSetTickHook(void (*hook)(void)){ (void)hook; notCalled("SysTickSetTickHook"); }
+void SysTickWaitEvent(const INT32U period){ (void)period; notCalled("SysTickWaitEvent"); }
+void TSIInit(void){ notCalled("TSIInit"); }
+
+int main(void){
+    INT32U i;
+    INT64U t0;
+    INT32U lat;
+    INT32U worstSiren = 0;
+    INT32U worstLed = 0;
+    INT16U zone;
+    srand(25);
+    /*The part of main() that does not touch the hardware*/
+    PinInit(&lab5Pin, lab5PinCodes, (INT8U)(sizeof(lab5PinCodes)/sizeof(lab5PinCodes[0])));
+    TimerInit(SysTickGetmsCount());
+    TimerSetup(&lab5TickTmr, 0, 0);
+    TimerStart(&lab5TickTmr, CTL_TICK_MS, CTL_TICK_MS);
+    ControlInit();
+    SchedInit(lab5TaskTable, (INT8U)LAB5_NUM_TASKS);
+    runTo(200000U);
+    CHECK(strcmp(lcdRow1, "DISARMED") == 0);
+
+    for(i = 0; i < RUNS; i++){
+        zone = ((i & 1U) != 0) ? CTL_INSTANT_ZONE : CTL_DOOR_ZONE;
+        keys = "1234#";
+        runTo(nowUs + 200000U);
+        if(!CHECK(ControlGetState() == CTL_EXIT_DELAY)){
+            break;
+        }else{}
+        runTo(nowUs + (CTL_EXIT_DELAY_MS*1000U) + 100000U + (INT32U)(rand() % 20000));
+        if(!CHECK(ControlGetState() == CTL_ARMED)){
+            break;
+        }else{}
+        t0 = nowUs;
+        acceptUs = 0;
+        sirenUs = 0;
+        ledUs = 0;
+        touch = zone;
+        runTo(t0 + 100000U);
+        CHECK(acceptUs != 0U);
+        if(zone == CTL_INSTANT_ZONE){
+            CHECK(ControlGetState() == CTL_ALARM);
+            CHECK(sirenUs != 0U);
+            lat = (INT32U)(sirenUs - acceptUs);
+            if(lat > worstSiren){
+                worstSiren = lat;
+            }else{}
+            CHECK(strcmp(lcdRow1, "ALARM") == 0);
+        }else{
+            CHECK(ControlGetState() == CTL_ENTRY_DELAY);
+            lat = (INT32U)(ledUs - acceptUs);
+            if(lat > worstLed){
+                worstLed = lat;
+            }else{}
+        }
+        if(!CHECK(lat <= (TOUCH_MAX_MS*1000U))){
+            printf("  run %u touch to reaction %u us\n", (unsigned)i, (unsigned)lat);
+        }else{}
+        if(!CHECK(touchLast == (lat*SIM_MHZ))){
+            printf("  run %u measured %u cycles\n", (unsigned)i, (unsigned)touchLast);
+        }else{}
+        touch = 0;
+        keys = "1234#";
+        runTo(nowUs + 200000U);
+        if(!CHECK(ControlGetState() == CTL_DISARMED)){
+            break;
+        }else{}
+    }
+    printf("TouchLatencyTest: touch to siren worst %u us, touch to entry LEDs worst %u us, bound %u us\n",
+           (unsigned)worstSiren, (unsigned)worstLed, (unsigned)(TOUCH_MAX_MS*1000U));
+    CHECK(touchCount == RUNS);
+    CHECK((touchMax/SIM_MHZ) <= (TOUCH_MAX_MS*1000U));
+    CHECK(lab5TouchLate == 0U);
+    return TestDone("TouchLatencyTest");
+}
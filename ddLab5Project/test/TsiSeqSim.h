@@ -0,0 +1,22 @@
+/* TsiSeqSim.h - Header file for the weighted electrode set in TsiSeqTest.c.
+ * Forced into K65TWR_TSI.c after TsiSim.h in place of the two board pads. Four electrodes with weights 3, 1, 2
+ * and 0, so one round scans A B C A C A and never D.
+ *
+ * Dominic Danis
+ * */
+#ifndef TSI_SEQ_SIM_INC
+#define TSI_SEQ_SIM_INC
+
+#define TSEQ_CH_A   12U
+#define TSEQ_CH_B   11U
+#define TSEQ_CH_C   5U
+#define TSEQ_CH_D   9U
+
+/*K65TWR_TSI.c hook*/
+#define TSI_ELECTRODES \
+    {TSEQ_CH_A, 0, 0U, 0x0400U, 0x0300U, 3U}, \
+    {TSEQ_CH_B, 0, 0U, 0x0400U, 0x0300U, 1U}, \
+    {TSEQ_CH_C, 0, 0U, 0x0400U, 0x0300U, 2U}, \
+    {TSEQ_CH_D, 0, 0U, 0x0400U, 0x0300U, 0U}
+
+#endif
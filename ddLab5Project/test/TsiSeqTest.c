@@ -0,0 +1,133 @@
+/* TsiSeqTest.c
+ * Host test of the weighted scan sequence in board/K65TWR_TSI.c. The driver is built with the electrode set in
+ * TsiSeqSim.h and run against the mock TSI0 of TsiSim.h. Checks that every round, including the calibration
+ * round, scans the electrodes in the interleaved order built from their weights, that each electrode is scanned
+ * weight times per round and a weight of 0 never, that each scan result reaches its own channel, and that a
+ * heavier electrode is flagged in fewer rounds.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <string.h>
+#include "MCUType.h"
+#include "K65TWR_TSI.h"
+#include "Profile.h"
+#include "CoreSim.h"
+#include "TsiSim.h"
+#include "TsiSeqSim.h"
+#include "TestUtil.h"
+
+#define PAD_BASE    0x1000U
+#define PAD_TOUCH   0x0800U
+#define ROUND_LEN   6U                                  /*sum of the weights*/
+
+void TSI0_IRQHandler(void);
+
+TSI_Type TsiSimRegs;
+
+static const INT8U seqRound[ROUND_LEN] = {TSEQ_CH_A, TSEQ_CH_B, TSEQ_CH_C, TSEQ_CH_A, TSEQ_CH_C, TSEQ_CH_A};
+static INT16U seqCount[16];
+static INT8U seqLog[2U*ROUND_LEN];
+static INT8U seqLogLen;
+
+/*Profile.c and SysTickDelay.c stubs*/
+INT32U ProfileStart(void){
+    return 0;
+}
+INT32U SysTickGetCycleStamp(void){
+    return 0;
+}
+void ProfileStop(INT8U id, INT32U start){
+    (void)id;
+    (void)start;
+}
+
+/* seqRun - no parameters, returns 1 if the round scanned the channels in seqRound order. Plays the TSI until
+ * the driver stops starting scans.
+ * */
+static int seqRun(void){
+    INT8U ch;
+    INT8U n = 0;
+    seqLogLen = 0;
+    while(((TsiSimRegs.DATA & TSI_DATA_SWTS_MASK) != 0) && (n < (2U*ROUND_LEN))){
+        ch = (INT8U)((TsiSimRegs.DATA & TSI_DATA_TSICH_MASK) >> TSI_DATA_TSICH_SHIFT);
+        seqLog[seqLogLen] = ch;
+        seqLogLen++;
+        n++;
+        TsiSimRegs.DATA = TSI_DATA_TSICH(ch) | TSI_DATA_TSICNT(seqCount[ch]);
+        CoreSimPend(TSI0_IRQHandler);
+    }
+    return (seqLogLen == ROUND_LEN) && (memcmp(seqLog, seqRound, ROUND_LEN) == 0);
+}
+
+/* seqScans - takes a channel, returns the number of times the last round scanned it.
+ * */
+static INT8U seqScans(INT8U ch){
+    INT8U i;
+    INT8U n = 0;
+    for(i = 0; i < seqLogLen; i++){
+        if(seqLog[i] == ch){
+            n++;
+        }else{}
+    }
+    return n;
+}
+
+static void testOrder(void){
+    TSI_LEVELS_T lev;
+    INT8U r;
+    int same = 1;
+    CoreSimReset();
+    memset(&TsiSimRegs, 0, sizeof(TsiSimRegs));
+    seqCount[TSEQ_CH_A] = PAD_BASE;
+    seqCount[TSEQ_CH_B] = PAD_BASE + 0x10U;
+    seqCount[TSEQ_CH_C] = PAD_BASE + 0x20U;
+    seqCount[TSEQ_CH_D] = PAD_BASE + 0x30U;
+    TSIInit();
+    CHECK(seqRun());                                    /*calibration round*/
+    CHECK(seqScans(TSEQ_CH_A) == 3U);
+    CHECK(seqScans(TSEQ_CH_B) == 1U);
+    CHECK(seqScans(TSEQ_CH_C) == 2U);
+    CHECK(seqScans(TSEQ_CH_D) == 0);
+    for(r = 0; r < 20U; r++){
+        TSITask();
+        if(!seqRun()){
+            same = 0;
+        }else{}
+    }
+    CHECK(same);
+    TSIGetChLevels(TSEQ_CH_A, &lev);                    /*each result went to its own channel*/
+    CHECK((lev.raw == PAD_BASE) && (lev.baseline == PAD_BASE));
+    TSIGetChLevels(TSEQ_CH_B, &lev);
+    CHECK((lev.raw == (PAD_BASE + 0x10U)) && (lev.baseline == (PAD_BASE + 0x10U)));
+    TSIGetChLevels(TSEQ_CH_C, &lev);
+    CHECK((lev.raw == (PAD_BASE + 0x20U)) && (lev.baseline == (PAD_BASE + 0x20U)));
+    TSIGetChLevels(TSEQ_CH_D, &lev);
+    CHECK(lev.raw == 0);                                /*never scanned*/
+    CHECK(TSIGetSensorFlags() == 0);
+}
+
+/* testWeight - touched together, A with three scans per round is flagged in round 2 and B with one in round 4.
+ * Both need four filter updates.
+ * */
+static void testWeight(void){
+    INT16U flags[5];
+    INT8U r;
+    seqCount[TSEQ_CH_A] = PAD_BASE + PAD_TOUCH;
+    seqCount[TSEQ_CH_B] = PAD_BASE + 0x10U + PAD_TOUCH;
+    for(r = 1U; r <= 4U; r++){
+        TSITask();
+        CHECK(seqRun());
+        flags[r] = TSIGetSensorFlags();
+    }
+    CHECK(flags[1] == 0);
+    CHECK(flags[2] == (1U << TSEQ_CH_A));
+    CHECK(flags[3] == (1U << TSEQ_CH_A));
+    CHECK(flags[4] == ((1U << TSEQ_CH_A) | (1U << TSEQ_CH_B)));
+}
+
+int main(void){
+    testOrder();
+    testWeight();
+    return TestDone("TsiSeqTest");
+}
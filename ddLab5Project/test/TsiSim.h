@@ -0,0 +1,17 @@
+/* TsiSim.h - Header file for the TSI0 mock in TsiTest.c.
+ * K65TWR_TSI.c is built unmodified with this header and CoreSim.h forced in. The macros below put its TSI0
+ * registers in a mock structure and stub out the clock gates, pin mux and NVIC setup.
+ *
+ * Dominic Danis
+ * */
+#ifndef TSI_SIM_INC
+#define TSI_SIM_INC
+
+/*K65TWR_TSI.c hooks*/
+#define TSI_REGS        (&TsiSimRegs)
+#define TSI_HW_INIT()   ((void)0)
+#define TSI_IRQ_INIT()  ((void)0)
+
+extern TSI_Type TsiSimRegs;
+
+#endif
@@ -0,0 +1,229 @@
+/* TsiTest.c
+ * Host test of the end of scan interrupt processing in board/K65TWR_TSI.c against a mock TSI0. The test plays
+ * the TSI: when the driver sets SWTS it completes the scan of the channel in TSICH with a count, sets EOSF and
+ * raises TSI0_IRQHandler() through CoreSim. Checks the register setup, the calibration round started by
+ * TSIInit(), that each scan is acknowledged and chained to the next channel until the round ends, that TSITask()
+ * does not restart a busy round, the touch and release of a pad through the filter, the flags and stamp read and
+ * clear, and calibration requests made while idle and while a round is running.
+ *
+ * Dominic Danis
+ * */
+#include <stdio.h>
+#include <string.h>
+#include "MCUType.h"
+#include "K65TWR_TSI.h"
+#include "TSIFilter.h"
+#include "Profile.h"
+#include "CoreSim.h"
+#include "TsiSim.h"
+#include "TestUtil.h"
+
+#define PAD_BASE    0x1000U                             /*untouched count of both pads*/
+#define PAD_TOUCH   0x0800U                             /*count added by a finger, twice the touch offset*/
+#define SIM_MAX_LOG 64U
+
+void TSI0_IRQHandler(void);
+
+TSI_Type TsiSimRegs;
+
+static INT16U simCount[16];                             /*count the next scan of each channel returns*/
+static INT8U simLog[SIM_MAX_LOG];                       /*channels in the order they were scanned*/
+static INT8U simLogLen;
+static INT32U simScans;
+static INT32U simUnacked;                               /*scans whose EOSF the ISR did not write back*/
+static INT32U simClock;                                 /*SysTickGetCycleStamp() value*/
+static INT32U simTsiProfiles;                           /*ProfileStop() calls for PROF_ID_TSI0*/
+
+/*Profile.c and SysTickDelay.c stubs*/
+INT32U ProfileStart(void){
+    return 0;                                           /*the touch stamp must not come from CYCCNT*/
+}
+INT32U SysTickGetCycleStamp(void){
+    return simClock;
+}
+void ProfileStop(INT8U id, INT32U start){
+    (void)start;
+    if(id == PROF_ID_TSI0){
+        simTsiProfiles++;
+    }else{}
+}
+
+/* simBusy - no parameters, returns 1 if the driver has started a scan that is not complete.
+ * */
+static int simBusy(void){
+    return (TsiSimRegs.DATA & TSI_DATA_SWTS_MASK) != 0;
+}
+
+/* simScan - no parameters and returns nothing. Completes the scan in progress with the count of its channel
+ * and takes the end of scan interrupt. The clock moves 1000 cycles per scan.
+ * */
+static void simScan(void){
+    INT8U ch = (INT8U)((TsiSimRegs.DATA & TSI_DATA_TSICH_MASK) >> TSI_DATA_TSICH_SHIFT);
+    if(simLogLen < SIM_MAX_LOG){
+        simLog[simLogLen] = ch;
+        simLogLen++;
+    }else{}
+    simScans++;
+    simClock += 1000U;
+    TsiSimRegs.DATA = TSI_DATA_TSICH(ch) | TSI_DATA_TSICNT(simCount[ch]);
+    TsiSimRegs.GENCS &= ~TSI_GENCS_EOSF_MASK;           /*a write of 1 clears EOSF, so look for the write*/
+    CoreSimPend(TSI0_IRQHandler);
+    if((TsiSimRegs.GENCS & TSI_GENCS_EOSF_MASK) == 0){
+        simUnacked++;
+    }else{}
+}
+
+/* simRound - no parameters, returns the number of scans. Completes scans until the driver stops starting them.
+ * */
+static INT32U simRound(void){
+    INT32U n = 0;
+    while(simBusy() && (n < 100U)){
+        simScan();
+        n++;
+    }
+    return n;
+}
+
+/* sameLog - takes the expected channel order and its length, returns 1 if it matches the scans since the last
+ * call and empties the log.
+ * */
+static int sameLog(const INT8U *want, INT8U len){
+    int same = (simLogLen == len) && (memcmp(simLog, want, len) == 0);
+    simLogLen = 0;
+    return same;
+}
+
+static void testInit(void){
+    static const INT8U round[] = {BRD_PAD1_CH, BRD_PAD2_CH};
+    TSI_LEVELS_T lev;
+    INT32U stamp;
+    CoreSimReset();
+    memset(&TsiSimRegs, 0, sizeof(TsiSimRegs));
+    simCount[BRD_PAD1_CH] = PAD_BASE;
+    simCount[BRD_PAD2_CH] = PAD_BASE + 0x100U;
+    TSIInit();
+    CHECK((TsiSimRegs.GENCS & TSI_GENCS_TSIEN_MASK) != 0);
+    CHECK((TsiSimRegs.GENCS & TSI_GENCS_TSIIEN_MASK) != 0);
+    CHECK((TsiSimRegs.GENCS & TSI_GENCS_ESOR_MASK) != 0);
+    CHECK((TsiSimRegs.GENCS & TSI_GENCS_NSCN_MASK) == TSI_GENCS_NSCN(15));
+    CHECK((TsiSimRegs.GENCS & TSI_GENCS_PS_MASK) == TSI_GENCS_PS(5));
+    CHECK(simBusy());                                   /*calibration round already started*/
+    CHECK(simRound() == 2U);
+    CHECK(sameLog(round, 2U));
+    CHECK(simUnacked == 0);
+    CHECK(simTsiProfiles == 2U);
+    CHECK(TSIGetSensorFlagsStamped(&stamp) == 0);
+    TSIGetChLevels(BRD_PAD1_CH, &lev);                  /*baselines taken from the calibration scans*/
+    CHECK((lev.raw == PAD_BASE) && (lev.filtered == PAD_BASE) && (lev.baseline == PAD_BASE));
+    TSIGetChLevels(BRD_PAD2_CH, &lev);
+    CHECK((lev.raw == (PAD_BASE + 0x100U)) && (lev.baseline == (PAD_BASE + 0x100U)));
+    TSIGetChLevels(16U, &lev);
+    CHECK((lev.raw == 0) && (lev.filtered == 0) && (lev.baseline == 0));
+}
+
+/* testTask - TSITask() starts a round only when the last one has finished.
+ * */
+static void testTask(void){
+    static const INT8U round[] = {BRD_PAD1_CH, BRD_PAD2_CH};
+    INT32U data;
+    CHECK(!simBusy());
+    TSITask();
+    CHECK(simBusy());
+    CHECK(((TsiSimRegs.DATA & TSI_DATA_TSICH_MASK) >> TSI_DATA_TSICH_SHIFT) == BRD_PAD1_CH);
+    simScan();                                          /*first channel done, second started*/
+    data = TsiSimRegs.DATA;
+    TSITask();                                          /*round busy, no restart*/
+    CHECK(TsiSimRegs.DATA == data);
+    CHECK(simRound() == 1U);
+    CHECK(sameLog(round, 2U));
+    TSITask();
+    TSITask();
+    CHECK(simRound() == 2U);
+    CHECK(sameLog(round, 2U));
+}
+
+/* testTouch - a pad is touched on the fourth round past the threshold, stamped at that scan, and released.
+ * */
+static void testTouch(void){
+    INT32U stamp = 0;
+    INT32U touch_clock = 0;
+    INT8U r;
+    INT16U flags = 0;
+    CHECK(TSIGetSensorFlags() == 0);
+    simCount[BRD_PAD1_CH] = PAD_BASE + PAD_TOUCH;
+    for(r = 1U; r <= 4U; r++){
+        TSITask();
+        simRound();
+        if(r == 3U){
+            CHECK(TSIGetSensorFlagsStamped(&stamp) == 0);
+        }else{}
+        if(r == 4U){
+            touch_clock = simClock - 1000U;             /*pad 1 is the first scan of the round*/
+        }else{}
+    }
+    flags = TSIGetSensorFlagsStamped(&stamp);
+    CHECK(flags == (1U << BRD_PAD1_CH));
+    CHECK(stamp == touch_clock);
+    CHECK(TSIGetSensorFlags() == 0);                    /*read clears*/
+    TSITask();                                          /*still touched, the flag comes back*/
+    simRound();
+    CHECK(TSIGetSensorFlagsStamped(&stamp) == (1U << BRD_PAD1_CH));
+    CHECK(stamp == (simClock - 1000U));
+    simCount[BRD_PAD2_CH] = PAD_BASE + 0x100U + PAD_TOUCH;
+    for(r = 1U; r <= 4U; r++){                          /*pad 1 flagged first, pad 2 joins later*/
+        TSITask();
+        simRound();
+        if(r == 1U){
+            touch_clock = simClock - 1000U;
+        }else{}
+    }
+    flags = TSIGetSensorFlagsStamped(&stamp);
+    CHECK(flags == ((1U << BRD_PAD1_CH) | (1U << BRD_PAD2_CH)));
+    CHECK(stamp == touch_clock);                        /*stamp of the first flag since the read*/
+    simCount[BRD_PAD1_CH] = PAD_BASE;
+    simCount[BRD_PAD2_CH] = PAD_BASE + 0x100U;
+    for(r = 1U; r <= 4U; r++){
+        TSITask();
+        simRound();
+    }
+    (void)TSIGetSensorFlags();
+    TSITask();
+    simRound();
+    CHECK(TSIGetSensorFlags() == 0);                    /*both released*/
+    CHECK(simUnacked == 0);
+    CHECK(simTsiProfiles == simScans);
+}
+
+/* testCalibration - a calibration request while idle starts a round, one made during a round is taken on the
+ * channel's next scan without disturbing the round, and a bad channel is ignored.
+ * */
+static void testCalibration(void){
+    static const INT8U round[] = {BRD_PAD1_CH, BRD_PAD2_CH};
+    TSI_LEVELS_T lev;
+    simLogLen = 0;
+    simCount[BRD_PAD2_CH] = PAD_BASE + 0x300U;          /*new untouched level*/
+    TSIChCalibration(BRD_PAD2_CH);
+    CHECK(simBusy());
+    CHECK(simRound() == 2U);
+    CHECK(sameLog(round, 2U));
+    TSIGetChLevels(BRD_PAD2_CH, &lev);
+    CHECK((lev.baseline == (PAD_BASE + 0x300U)) && (lev.filtered == (PAD_BASE + 0x300U)));
+    simCount[BRD_PAD1_CH] = PAD_BASE + 0x200U;
+    TSITask();
+    TSIChCalibration(BRD_PAD1_CH);                      /*busy, marks pad 1 for its next scan only*/
+    CHECK(simRound() == 2U);
+    CHECK(sameLog(round, 2U));
+    TSIGetChLevels(BRD_PAD1_CH, &lev);
+    CHECK(lev.baseline == (PAD_BASE + 0x200U));
+    TSIChCalibration(16U);
+    CHECK(!simBusy());
+    CHECK(CoreSimGetPrimask() == 0);
+}
+
+int main(void){
+    testInit();
+    testTask();
+    testTouch();
+    testCalibration();
+    return TestDone("TsiTest");
+}
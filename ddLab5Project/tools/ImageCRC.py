@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""ImageCRC.py - post-build step that stamps the reference CRC32 used by ImageVerify() in ImageCheck.c.
+
+Usage: ImageCRC.py <image.axf> <image.bin>
+
+The .bin must be made with 'arm-none-eabi-objcopy -O binary --gap-fill 0xFF' so gaps read the same as erased
+flash. The record is found by IMAGE_CRC_MAGIC followed by IMAGE_CRC_BLANK. The CRC32 (zlib, same as the
+MEM_CRC32 profile) covers the whole binary without the crc word and is written into both files.
+
+Dominic Danis
+"""
+import struct
+import sys
+import zlib
+
+IMAGE_CRC_MAGIC = 0x52435249
+IMAGE_CRC_BLANK = 0xFFFFFFFF
+PLACEHOLDER = struct.pack('<II', IMAGE_CRC_MAGIC, IMAGE_CRC_BLANK)
+
+
+def find_record(data, name):
+    offset = data.find(PLACEHOLDER)
+    if offset < 0:
+        sys.exit('ImageCRC: no blank record in ' + name)
+    if data.find(PLACEHOLDER, offset + 1) >= 0:
+        sys.exit('ImageCRC: more than one blank record in ' + name)
+    return offset
+
+
+def stamp(data, offset, crc):
+    data[offset + 4:offset + 8] = struct.pack('<I', crc)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    axf_name, bin_name = sys.argv[1], sys.argv[2]
+    with open(bin_name, 'rb') as f:
+        image = bytearray(f.read())
+    with open(axf_name, 'rb') as f:
+        axf = bytearray(f.read())
+    offset = find_record(image, bin_name)
+    crc = zlib.crc32(image[:offset + 4] + image[offset + 8:]) & 0xFFFFFFFF
+    stamp(image, offset, crc)
+    stamp(axf, find_record(axf, axf_name), crc)
+    with open(bin_name, 'wb') as f:
+        f.write(image)
+    with open(axf_name, 'wb') as f:
+        f.write(axf)
+    print('ImageCRC: 0x%08X over %d bytes, record at 0x%08X' % (crc, len(image), offset))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""PinHash.py - makes PIN_CODE_T table entries for Pin.c.
+
+Usage: PinHash.py user:pin[:d] [user:pin[:d] ...]
+
+Each code gets a random 64-bit salt and is hashed with SipHash-2-4 keyed with the salt and the device key, the
+same as PinHash() in Pin.c. Add :d to mark a duress code. Paste the printed lines into the code table.
+
+Dominic Danis
+"""
+import os
+import sys
+
+DEVICE_KEY = 0x6C35444464616E69    # PIN_DEVICE_KEY in Pin.c
+MASK = 0xFFFFFFFFFFFFFFFF
+MIN_DIGITS = 4
+MAX_DIGITS = 8
+
+
+def rotl(x, b):
+    return ((x << b) | (x >> (64 - b))) & MASK
+
+
+def sip_round(v):
+    v[0] = (v[0] + v[1]) & MASK
+    v[1] = rotl(v[1], 13) ^ v[0]
+    v[0] = rotl(v[0], 32)
+    v[2] = (v[2] + v[3]) & MASK
+    v[3] = rotl(v[3], 16) ^ v[2]
+    v[0] = (v[0] + v[3]) & MASK
+    v[3] = rotl(v[3], 21) ^ v[0]
+    v[2] = (v[2] + v[1]) & MASK
+    v[1] = rotl(v[1], 17) ^ v[2]
+    v[2] = rotl(v[2], 32)
+
+
+def siphash24(k0, k1, data):
+    v = [k0 ^ 0x736F6D6570736575, k1 ^ 0x646F72616E646F6D,
+         k0 ^ 0x6C7967656E657261, k1 ^ 0x7465646279746573]
+    full = len(data) - len(data) % 8
+    blocks = [int.from_bytes(data[i:i + 8], 'little') for i in range(0, full, 8)]
+    blocks.append(int.from_bytes(data[full:], 'little') | ((len(data) & 0xFF) << 56))
+    for m in blocks:
+        v[3] ^= m
+        sip_round(v)
+        sip_round(v)
+        v[0] ^= m
+    v[2] ^= 0xFF
+    for _ in range(4):
+        sip_round(v)
+    return v[0] ^ v[1] ^ v[2] ^ v[3]
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    for arg in sys.argv[1:]:
+        fields = arg.split(':')
+        user, pin = int(fields[0]), fields[1]
+        duress = len(fields) > 2 and fields[2] == 'd'
+        if not (pin.isdigit() and MIN_DIGITS <= len(pin) <= MAX_DIGITS and 0 <= user <= 255):
+            sys.exit('bad entry: ' + arg)
+        salt = int.from_bytes(os.urandom(8), 'little')
+        h = siphash24(salt, DEVICE_KEY, pin.encode('ascii'))
+        print('    {{{{0x{:08X}U, 0x{:08X}U}}, {{0x{:08X}U, 0x{:08X}U}}, {}U, {}}},'.format(
+            salt & 0xFFFFFFFF, salt >> 32, h & 0xFFFFFFFF, h >> 32, user,
+            'PIN_FLAG_DURESS' if duress else '0U'))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""SoftCRCGen.py - generates source/SoftCRCTables.c, the slice-by-8 tables for SoftCRC.c.
+
+Usage: SoftCRCGen.py [output.c]
+
+Both CRC0 profiles transpose bits on write and read, so they are reflected CRCs and use the reflected
+polynomial. Table k holds the CRC of a byte followed by k zero bytes. Tables 0-3 are also used by slice-by-4.
+Rerun and commit the output if a profile changes.
+
+Dominic Danis
+"""
+import sys
+
+PROFILES = (
+    ('softCRC16Table', 0xA001),        # 0x8005 reflected
+    ('softCRC32Table', 0xEDB88320),    # 0x04C11DB7 reflected
+)
+SLICES = 8
+
+
+def make_tables(rpoly):
+    tables = [[0] * 256 for _ in range(SLICES)]
+    for b in range(256):
+        crc = b
+        for _ in range(8):
+            crc = (crc >> 1) ^ rpoly if crc & 1 else crc >> 1
+        tables[0][b] = crc
+    for k in range(1, SLICES):
+        for b in range(256):
+            prev = tables[k - 1][b]
+            tables[k][b] = (prev >> 8) ^ tables[0][prev & 0xFF]
+    return tables
+
+
+def main():
+    out_name = sys.argv[1] if len(sys.argv) > 1 else 'SoftCRCTables.c'
+    lines = ['/* SoftCRCTables.c',
+             ' * Slice-by-8 tables for SoftCRC.c. Generated by tools/SoftCRCGen.py, do not edit.',
+             ' * */',
+             '',
+             '#include "SoftCRC.h"',
+             '']
+    for name, rpoly in PROFILES:
+        lines.append('const INT32U %s[SOFT_CRC_SLICES][256] = {' % name)
+        for k, table in enumerate(make_tables(rpoly)):
+            lines.append('    {')
+            for i in range(0, 256, 8):
+                row = ', '.join('0x%08XU' % v for v in table[i:i + 8])
+                lines.append('        ' + row + (',' if i < 248 else ''))
+            lines.append('    }' + (',' if k < SLICES - 1 else ''))
+        lines.append('};')
+        lines.append('')
+    with open(out_name, 'w', newline='\n') as f:
+        f.write('\n'.join(lines))
+
+
+if __name__ == '__main__':
+    main()